@@ -1,4 +1,8 @@
+using System;
 using System.Collections.Generic;
+using System.Diagnostics;
+using System.Linq;
+using System.Reactive.Linq;
 using System.Threading;
 using System.Threading.Tasks;
 using Microsoft.VisualStudio.TestTools.UnitTesting;
@@ -119,5 +123,103 @@ namespace WonderMediaProductions.WebRtc
                 PeerConnection.Configure(new GlobalOptions { AutoShutdown = true });
             }
         }
+
+        [TestMethod]
+        public void ShardedFactoryLifetime()
+        {
+            foreach (var assignment in new[] { FactoryAssignment.RoundRobin, FactoryAssignment.LeastLoaded })
+            {
+                PeerConnection.Configure(new GlobalOptions { FactoryCount = 4, FactoryAssignment = assignment });
+
+                Parallel.For(0, 16, i =>
+                {
+                    using (new PeerConnection(new PeerConnectionOptions()))
+                    using (new PeerConnection(new PeerConnectionOptions()))
+                    {
+                        Assert.IsTrue(PeerConnection.HasFactory);
+                    }
+                });
+
+                Assert.IsFalse(PeerConnection.HasFactory);
+
+                // Test if the factories stay alive until the last peer connection is closed
+                var connections = Enumerable.Range(0, 8).Select(_ => new PeerConnection(new PeerConnectionOptions())).ToList();
+
+                foreach (var connection in connections.Take(7))
+                {
+                    connection.Dispose();
+                    Assert.IsTrue(PeerConnection.HasFactory);
+                }
+
+                connections.Last().Dispose();
+
+                Assert.IsFalse(PeerConnection.HasFactory);
+            }
+
+            PeerConnection.Configure(new GlobalOptions());
+        }
+
+        [TestMethod]
+        public void ShardedFactoriesNeedOwnThreads()
+        {
+            Assert.ThrowsException<Exception>(() => PeerConnection.Configure(new GlobalOptions { FactoryCount = 2, UseWorkerThread = false }));
+            Assert.ThrowsException<Exception>(() => PeerConnection.Configure(new GlobalOptions { FactoryCount = 2, IsSingleThreaded = true }));
+
+            PeerConnection.Configure(new GlobalOptions { FactoryCount = 2 });
+            PeerConnection.Configure(new GlobalOptions());
+        }
+
+        [TestMethod]
+        public void DispatchesQueuedEventsOnCallingThread()
+        {
+            PeerConnection.Configure(new GlobalOptions { AllowLoopbackNetwork = true });
+
+            var threadId = Thread.CurrentThread.ManagedThreadId;
+            var otherThreadEventCount = 0;
+            DataMessage receivedMessage = null;
+
+            void CheckThread()
+            {
+                if (Thread.CurrentThread.ManagedThreadId != threadId)
+                    ++otherThreadEventCount;
+            }
+
+            using (var sender = new ObservablePeerConnection(new PeerConnectionOptions { UseEventQueue = true }))
+            using (var receiver = new ObservablePeerConnection(new PeerConnectionOptions { UseEventQueue = true }))
+            {
+                receiver.Connect(Observable.Never<DataMessage>(), sender.LocalSessionDescriptionStream, sender.LocalIceCandidateStream);
+                sender.Connect(Observable.Never<DataMessage>(), receiver.LocalSessionDescriptionStream, receiver.LocalIceCandidateStream);
+
+                sender.ConnectionStateChanged += (pc, state) => CheckThread();
+                receiver.ConnectionStateChanged += (pc, state) => CheckThread();
+
+                sender.LocalDataChannelReady += (pc, label) =>
+                {
+                    CheckThread();
+                    sender.SendData(label, "hello");
+                };
+
+                receiver.DataAvailable += (pc, message) =>
+                {
+                    CheckThread();
+                    receivedMessage = message;
+                };
+
+                sender.AddDataChannel(new DataChannelOptions { IsReliable = true, IsOrdered = true });
+                sender.CreateOffer();
+
+                var stopwatch = Stopwatch.StartNew();
+
+                while (receivedMessage == null && stopwatch.Elapsed < TimeSpan.FromSeconds(10))
+                {
+                    PeerConnection.DispatchQueuedEvents(TimeSpan.FromMilliseconds(100));
+                }
+
+                Assert.AreEqual("hello", receivedMessage?.AsText);
+                Assert.AreEqual(0, otherThreadEventCount);
+            }
+
+            PeerConnection.Configure(new GlobalOptions());
+        }
     }
 }
@@ -0,0 +1,64 @@
+using System;
+using System.Diagnostics;
+using System.Runtime.InteropServices;
+using Microsoft.VisualStudio.TestTools.UnitTesting;
+
+namespace WonderMediaProductions.WebRtc
+{
+    [TestClass]
+    public class YuvConversionBenchmarks
+    {
+        [TestMethod]
+        [TestCategory("Benchmark")]
+        public void StripedRgbaToYuvConversion()
+        {
+            var resolutions = new[] { (width: 1920, height: 1080), (width: 3840, height: 2160) };
+            var threadCounts = new[] { 1, 2, 4, 8 };
+
+            const int frameCount = 120;
+
+            foreach (var (width, height) in resolutions)
+            {
+                var stride = width * 4;
+                var pixels = Marshal.AllocHGlobal(stride * height);
+
+                try
+                {
+                    foreach (var threadCount in threadCounts)
+                    {
+                        PeerConnection.Configure(new GlobalOptions
+                        {
+                            UseFakeEncoders = true,
+                            YuvConversionThreadCount = threadCount,
+                            MinimumLogLevel = TraceLevel.Warning
+                        });
+
+                        using (var pc = new PeerConnection(new PeerConnectionOptions()))
+                        using (var vt = new VideoTrack(pc, VideoEncoderOptions.OptimizedFor(width, height, 60)))
+                        {
+                            // Warm up the buffer pool and the conversion threads.
+                            vt.SendVideoFrame(pixels, stride, width, height, VideoFrameFormat.Rgba32);
+
+                            var stopwatch = Stopwatch.StartNew();
+
+                            for (int i = 0; i < frameCount; ++i)
+                            {
+                                vt.SendVideoFrame(pixels, stride, width, height, VideoFrameFormat.Rgba32);
+                            }
+
+                            stopwatch.Stop();
+
+                            Console.WriteLine($"{width}x{height} using {threadCount} thread(s): {stopwatch.Elapsed.TotalMilliseconds / frameCount:F2} ms/frame");
+                        }
+                    }
+                }
+                finally
+                {
+                    Marshal.FreeHGlobal(pixels);
+                }
+            }
+
+            PeerConnection.Configure(new GlobalOptions());
+        }
+    }
+}
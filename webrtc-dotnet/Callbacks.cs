@@ -24,6 +24,12 @@ namespace WonderMediaProductions.WebRtc
 
     public delegate void DataAvailableDelegate(PeerConnection pc, DataMessage msg);
 
+    public delegate void DataBufferAvailableDelegate(PeerConnection pc, DataBuffer buffer);
+
+    public delegate void StatsReadyDelegate(PeerConnection pc, long timestampUs);
+
+    public delegate void DataChannelBufferedAmountLowDelegate(PeerConnection pc, int channelId, ulong bufferedAmount);
+
     public delegate void FailureMessageDelegate(PeerConnection pc, string msg);
 
     public delegate void VideoFrameReadyDelegate(PeerConnection pc, VideoFrame frame);
@@ -0,0 +1,46 @@
+﻿using System;
+using System.Threading;
+
+namespace WonderMediaProductions.WebRtc
+{
+    /// <summary>
+    /// A received data channel message that is still owned by native code, see <see cref="PeerConnectionOptions.ReceiveDataBuffers"/>.
+    /// </summary>
+    /// <remarks>
+    /// The data is not copied, it stays valid until the buffer is disposed.
+    /// </remarks>
+    public sealed class DataBuffer : Disposable
+    {
+        private IntPtr _nativePtr;
+
+        public string Label { get; }
+
+        public int ChannelId { get; }
+
+        // TODO: Convert IntPtr to Memory as soon as this is part of .NET Standard
+        public IntPtr Data { get; }
+
+        public int Length { get; }
+
+        public MessageEncoding Encoding { get; }
+
+        internal DataBuffer(IntPtr nativePtr, string label, int channelId, IntPtr data, int length, MessageEncoding encoding)
+        {
+            _nativePtr = nativePtr;
+            Label = label;
+            ChannelId = channelId;
+            Data = data;
+            Length = length;
+            Encoding = encoding;
+        }
+
+        protected override void OnDispose(bool isDisposing)
+        {
+            var ptr = Interlocked.Exchange(ref _nativePtr, default);
+            if (ptr != default)
+            {
+                Native.ReleaseDataBuffer(ptr);
+            }
+        }
+    }
+}
@@ -5,5 +5,21 @@
         public string Label = "data";
         public bool IsReliable = false;
         public bool IsOrdered = false;
+
+        /// <summary>
+        /// When positive, large messages are sent in chunks of at most this many bytes, see <see cref="PeerConnection.ConfigureDataChannelChunking"/>.
+        /// </summary>
+        public int ChunkSize = 0;
+
+        /// <summary>
+        /// When positive, received messages larger than this are dropped, see <see cref="PeerConnection.ConfigureDataChannelMaxMessageSize"/>.
+        /// </summary>
+        public int MaxMessageSize = 0;
+
+        /// <summary>
+        /// When set, messages of at least <see cref="CompressionThreshold"/> bytes are compressed, see <see cref="PeerConnection.ConfigureDataChannelCompression"/>.
+        /// </summary>
+        public bool IsCompressed = false;
+        public int CompressionThreshold = 256;
     }
 }
\ No newline at end of file
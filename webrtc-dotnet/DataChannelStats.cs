@@ -0,0 +1,57 @@
+﻿using System.Runtime.InteropServices;
+
+namespace WonderMediaProductions.WebRtc
+{
+    /// <summary>
+    /// Compression statistics of a data channel, see <see cref="PeerConnection.ConfigureDataChannelCompression"/>
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    public struct DataChannelStats
+    {
+        /// <summary>
+        /// Number of sent messages that were compressed.
+        /// </summary>
+        public long CompressedMessageCount;
+
+        /// <summary>
+        /// Number of sent messages that were not compressed, because they were too small or did not shrink.
+        /// </summary>
+        public long StoredMessageCount;
+
+        /// <summary>
+        /// Size of the compressed messages before compression.
+        /// </summary>
+        public long UncompressedByteCount;
+
+        /// <summary>
+        /// Size of the compressed messages after compression.
+        /// </summary>
+        public long CompressedByteCount;
+
+        /// <summary>
+        /// Time spent compressing in microseconds, including the attempts that did not shrink the message.
+        /// </summary>
+        public long CompressionTimeUs;
+
+        /// <summary>
+        /// Number of received messages that were decompressed.
+        /// </summary>
+        public long DecompressedMessageCount;
+
+        /// <summary>
+        /// Time spent decompressing in microseconds.
+        /// </summary>
+        public long DecompressionTimeUs;
+
+        /// <summary>
+        /// How many times smaller the compressed messages became.
+        /// </summary>
+        public double CompressionRatio => CompressedByteCount > 0 ? (double)UncompressedByteCount / CompressedByteCount : 1;
+
+        public override string ToString()
+        {
+            return $"{nameof(CompressedMessageCount)}: {CompressedMessageCount}, {nameof(StoredMessageCount)}: {StoredMessageCount}, {nameof(CompressionRatio)}: {CompressionRatio:F2}, " +
+                   $"{nameof(CompressionTimeUs)}: {CompressionTimeUs}, {nameof(DecompressedMessageCount)}: {DecompressedMessageCount}, {nameof(DecompressionTimeUs)}: {DecompressionTimeUs}";
+        }
+    }
+}
@@ -6,6 +6,12 @@ namespace WonderMediaProductions.WebRtc
     public sealed class DataMessage
     {
         public string Label { get; }
+
+        /// <summary>
+        /// The handle of the data channel that received the message, or 0 for outgoing messages created by label.
+        /// </summary>
+        public int ChannelId { get; }
+
         public ArraySegment<byte> Content { get; }
         public MessageEncoding Encoding { get; }
 
@@ -13,6 +19,14 @@ namespace WonderMediaProductions.WebRtc
             ? null
             : System.Text.Encoding.UTF8.GetString(Content.Array, Content.Offset, Content.Count);
 
+        public DataMessage(string label, int channelId, ArraySegment<byte> content, MessageEncoding encoding = MessageEncoding.Binary)
+        {
+            Label = label;
+            ChannelId = channelId;
+            Content = content;
+            Encoding = encoding;
+        }
+
         public DataMessage(string label, ArraySegment<byte> content, MessageEncoding encoding = MessageEncoding.Binary)
         {
             Label = label;
@@ -0,0 +1,18 @@
+﻿namespace WonderMediaProductions.WebRtc
+{
+    /// <summary>
+    /// How new peer connections are assigned to the factories, see <see cref="GlobalOptions.FactoryCount"/>.
+    /// </summary>
+    public enum FactoryAssignment
+    {
+        /// <summary>
+        /// Each factory in turn.
+        /// </summary>
+        RoundRobin,
+
+        /// <summary>
+        /// The factory with the fewest open peer connections.
+        /// </summary>
+        LeastLoaded
+    }
+}
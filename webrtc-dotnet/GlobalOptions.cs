@@ -12,13 +12,48 @@ namespace WonderMediaProductions.WebRtc
         public bool UseFakeEncoders = false;
         public bool UseFakeDecoders = false;
 
+        /// <summary>
+        /// Number of threads that convert large RGBA video frames to YUV in parallel stripes.
+        /// 1 converts on the calling thread only.
+        /// </summary>
+        public int YuvConversionThreadCount = 1;
+
+        /// <summary>
+        /// Number of threads of the software H.264 encoder, used when NVENC is not available.
+        /// 0 uses the number of cores.
+        /// </summary>
+        public int SoftwareVideoEncoderThreadCount = 0;
+
+        /// <summary>
+        /// Also gather ICE candidates on the loopback interface,
+        /// so peer connections on the same machine can connect without any other network interface.
+        /// </summary>
+        public bool AllowLoopbackNetwork = false;
+
+        /// <summary>
+        /// Send and receive the packets on a separate network thread, instead of on the worker thread.
+        /// </summary>
+        public bool UseNetworkThread = false;
+
+        /// <summary>
+        /// Number of peer connection factories, each with its own network, worker and signaling threads.
+        /// Use more than 1 to spread many peer connections over more cores,
+        /// this requires <see cref="UseSignalingThread"/> and <see cref="UseWorkerThread"/>.
+        /// </summary>
+        public int FactoryCount = 1;
+
+        /// <summary>
+        /// How new peer connections are assigned to the factories.
+        /// </summary>
+        public FactoryAssignment FactoryAssignment = FactoryAssignment.RoundRobin;
+
         public TraceLevel MinimumLogLevel = TraceLevel.Verbose;
         public bool LogToStandardError = true;
         public bool LogToDebugOutput = false;
 
         public bool IsSingleThreaded
         {
-            set => UseSignalingThread = UseWorkerThread = value;
+            set => UseSignalingThread = UseWorkerThread = UseNetworkThread = value;
         }
     }
 }
\ No newline at end of file
@@ -0,0 +1,27 @@
+﻿using System;
+using System.Runtime.InteropServices;
+
+namespace WonderMediaProductions.WebRtc
+{
+    /// <summary>
+    /// Summary of a latency histogram, all latencies are in microseconds.
+    /// The percentiles are the upper bounds of their histogram bucket, which are within 25% of the actual value.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    public struct LatencyHistogramSnapshot
+    {
+        public long Count;
+        public long SumUs;
+        public long MaxUs;
+        public long P50Us;
+        public long P90Us;
+        public long P99Us;
+
+        public TimeSpan Average => Count > 0 ? TimeSpan.FromTicks(SumUs * 10 / Count) : TimeSpan.Zero;
+
+        public override string ToString()
+        {
+            return $"{nameof(Count)}: {Count}, avg: {SumUs / Math.Max(1, Count)}us, p50: {P50Us}us, p90: {P90Us}us, p99: {P99Us}us, max: {MaxUs}us";
+        }
+    }
+}
@@ -38,10 +38,55 @@ namespace WonderMediaProductions.WebRtc
         }
 
         [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
-        internal delegate void LocalDataChannelReadyCallback(string label);
+        internal delegate void LocalDataChannelReadyCallback(int channelId, string label);
 
         [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
-        internal delegate void DataAvailableCallback(string label, IntPtr data, int size, bool isBinary);
+        internal delegate void DataAvailableCallback(int channelId, IntPtr data, int size, bool isBinary);
+
+        [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+        internal delegate void DataBufferAvailableCallback(int channelId, IntPtr buffer, IntPtr data, int size, bool isBinary);
+
+        [StructLayout(LayoutKind.Sequential)]
+        internal struct DataMessageDescriptor
+        {
+            public IntPtr Data;
+            public int Length;
+            public int ChannelId;
+            public int IsBinary;
+        }
+
+        internal enum PeerConnectionEventType
+        {
+            LocalSdpReadyToSend,
+            IceCandidateReadyToSend,
+            SignalingStateChanged,
+            ConnectionStateChanged,
+            RemoteTrackChanged,
+            Failure,
+            LocalDataChannelReady,
+            DataAvailable,
+            DataChannelBufferedAmountLow,
+            VideoFrameProcessed,
+            StatsReady
+        }
+
+        /// <summary>
+        /// A queued event, see the native PeerConnectionEvent for the meaning of the fields.
+        /// </summary>
+        [StructLayout(LayoutKind.Sequential)]
+        internal struct PeerConnectionEvent
+        {
+            public long Tag;
+            public PeerConnectionEventType Type;
+            public int Id;
+            public long Value;
+            public IntPtr Data;
+            public IntPtr Text;
+            public int Length;
+        }
+
+        [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+        internal delegate void DataChannelBufferedAmountLowCallback(int channelId, ulong bufferedAmount);
 
         [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
         internal delegate void FailureMessageCallback(string msg);
@@ -52,10 +97,12 @@ namespace WonderMediaProductions.WebRtc
 
         [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
         internal delegate void VideoFrameCallback(
+            int trackId,
             IntPtr texture,
             IntPtr dataY, IntPtr dataU, IntPtr dataV, IntPtr dataA,
             int strideY, int strideU, int strideV, int strideA,
-            int width, int height, long timeStampUs);
+            int width, int height, long timeStampUs,
+            VideoFrameFormat format);
 
         [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
         internal delegate void LocalSdpReadyToSendCallback(string type, string sdp);
@@ -69,6 +116,9 @@ namespace WonderMediaProductions.WebRtc
         [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
         internal delegate void VideoFrameProcessedCallback(int videoTrackId, IntPtr rgbaPixels, bool isEncoded);
 
+        [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+        internal delegate void StatsReadyCallback(long timestampUs);
+
         [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
         internal delegate void RemoteTrackChangedCallback(string transceiverMid, int mediaKind, int changeKind);
 
@@ -83,6 +133,12 @@ namespace WonderMediaProductions.WebRtc
             bool autoShutdown,
             bool useFakeEncoders,
             bool useFakeDecoders,
+            int yuvConversionThreadCount,
+            int softwareVideoEncoderThreadCount,
+            bool allowLoopbackNetwork,
+            bool useNetworkThread,
+            int factoryCount,
+            FactoryAssignment factoryAssignment,
             bool logToStdErr,
             bool logToDebug,
             LoggingCallback loggingCallback,
@@ -114,11 +170,14 @@ namespace WonderMediaProductions.WebRtc
         internal static extern int AddVideoTrack(IntPtr connection, string label, int minBitsPerSecond, int maxBitsPerSeconds, int maxFramesPerSecond);
 
         [DllImport(DllPath, CallingConvention = CallingConvention.Cdecl)]
-        internal static extern bool AddDataChannel(IntPtr connection, string label, bool isOrdered, bool isReliable);
+        internal static extern int AddDataChannel(IntPtr connection, string label, bool isOrdered, bool isReliable);
 
         [DllImport(DllPath, CallingConvention = CallingConvention.Cdecl)]
         internal static extern bool RemoveDataChannel(IntPtr connection, string label);
 
+        [DllImport(DllPath, CallingConvention = CallingConvention.Cdecl)]
+        internal static extern bool RemoveDataChannelById(IntPtr connection, int channelId);
+
         [DllImport(DllPath, CallingConvention = CallingConvention.Cdecl)]
         internal static extern bool CreateOffer(IntPtr connection);
 
@@ -128,9 +187,51 @@ namespace WonderMediaProductions.WebRtc
         [DllImport(DllPath, CallingConvention = CallingConvention.Cdecl)]
         internal static extern bool SendData(IntPtr connection, string label, IntPtr data, int length, bool isBinary);
 
+        [DllImport(DllPath, CallingConvention = CallingConvention.Cdecl)]
+        internal static extern bool SendDataById(IntPtr connection, int channelId, IntPtr data, int length, bool isBinary);
+
+        [DllImport(DllPath, CallingConvention = CallingConvention.Cdecl)]
+        internal static extern unsafe int SendDataBatch(IntPtr connection, DataMessageDescriptor* messages, int count, byte* results);
+
+        [DllImport(DllPath, CallingConvention = CallingConvention.Cdecl)]
+        internal static extern bool ConfigureDataChannelChunking(IntPtr connection, int channelId, int chunkSize);
+
+        [DllImport(DllPath, CallingConvention = CallingConvention.Cdecl)]
+        internal static extern bool ConfigureDataChannelMaxMessageSize(IntPtr connection, int channelId, int maxMessageSize);
+
+        [DllImport(DllPath, CallingConvention = CallingConvention.Cdecl)]
+        internal static extern bool ConfigureDataChannelCompression(IntPtr connection, int channelId, bool isEnabled, int level, int threshold);
+
+        [DllImport(DllPath, CallingConvention = CallingConvention.Cdecl)]
+        internal static extern bool GetDataChannelStats(IntPtr connection, int channelId, out DataChannelStats stats);
+
+        [DllImport(DllPath, CallingConvention = CallingConvention.Cdecl)]
+        internal static extern long GetDataChannelBufferedAmount(IntPtr connection, int channelId);
+
+        [DllImport(DllPath, CallingConvention = CallingConvention.Cdecl)]
+        internal static extern bool ConfigureDataChannelBuffering(IntPtr connection, int channelId, long lowWaterMark, long highWaterMark);
+
         [DllImport(DllPath, CallingConvention = CallingConvention.Cdecl)]
         internal static extern bool SendVideoFrame(IntPtr connection, int trackId, IntPtr rgbaPixels, int stride, int width, int height, VideoFrameFormat videoFrameFormat);
 
+        [DllImport(DllPath, CallingConvention = CallingConvention.Cdecl)]
+        internal static extern bool SendVideoFrameYuv(IntPtr connection, int trackId,
+            IntPtr dataY, IntPtr dataU, IntPtr dataV,
+            int strideY, int strideU, int strideV,
+            int width, int height, VideoFrameFormat videoFrameFormat);
+
+        [DllImport(DllPath, CallingConvention = CallingConvention.Cdecl)]
+        internal static extern bool ConfigureVideoTrackQueue(IntPtr connection, int trackId, int queueDepth, VideoFrameDropPolicy dropPolicy);
+
+        [DllImport(DllPath, CallingConvention = CallingConvention.Cdecl)]
+        internal static extern bool SetVideoTrackDeferredConversion(IntPtr connection, int trackId, bool isDeferred);
+
+        [DllImport(DllPath, CallingConvention = CallingConvention.Cdecl)]
+        internal static extern bool GetVideoTrackStats(IntPtr connection, int trackId, out VideoTrackStats stats);
+
+        [DllImport(DllPath, CallingConvention = CallingConvention.Cdecl)]
+        internal static extern bool GetVideoTrackLatency(IntPtr connection, int trackId, out VideoTrackLatency latency, bool reset);
+
         [DllImport(DllPath, CallingConvention = CallingConvention.Cdecl)]
         internal static extern bool SetAudioControl(IntPtr connection, bool isMute, bool isRecord);
 
@@ -148,6 +249,17 @@ namespace WonderMediaProductions.WebRtc
         internal static extern bool RegisterOnDataFromDataChannelReady(
             IntPtr connection, DataAvailableCallback callback);
 
+        [DllImport(DllPath, CallingConvention = CallingConvention.Cdecl)]
+        internal static extern bool RegisterOnDataBufferAvailable(
+            IntPtr connection, DataBufferAvailableCallback callback);
+
+        [DllImport(DllPath, CallingConvention = CallingConvention.Cdecl)]
+        internal static extern void ReleaseDataBuffer(IntPtr buffer);
+
+        [DllImport(DllPath, CallingConvention = CallingConvention.Cdecl)]
+        internal static extern bool RegisterOnDataChannelBufferedAmountLow(
+            IntPtr connection, DataChannelBufferedAmountLowCallback callback);
+
         [DllImport(DllPath, CallingConvention = CallingConvention.Cdecl)]
         internal static extern bool RegisterOnFailure(IntPtr connection,
             FailureMessageCallback callback);
@@ -164,6 +276,12 @@ namespace WonderMediaProductions.WebRtc
         internal static extern bool RegisterRemoteVideoFrameReceived(IntPtr connection,
             VideoFrameCallback callback);
 
+        [DllImport(DllPath, CallingConvention = CallingConvention.Cdecl)]
+        internal static extern bool SetRemoteVideoFrameOptions(IntPtr connection, VideoFrameFormat format, int width, int height);
+
+        [DllImport(DllPath, CallingConvention = CallingConvention.Cdecl)]
+        internal static extern int GetRemoteVideoTrackId(IntPtr connection, string transceiverMid);
+
         [DllImport(DllPath, CallingConvention = CallingConvention.Cdecl)]
         internal static extern bool RegisterOnLocalSdpReadyToSend(IntPtr connection,
             LocalSdpReadyToSendCallback callback);
@@ -180,6 +298,19 @@ namespace WonderMediaProductions.WebRtc
         internal static extern bool RegisterConnectionStateChanged(
             IntPtr connection, StateChangedCallback callback);
 
+        [DllImport(DllPath, CallingConvention = CallingConvention.Cdecl)]
+        internal static extern bool RegisterOnStatsReady(
+            IntPtr connection, StatsReadyCallback callback);
+
+        [DllImport(DllPath, CallingConvention = CallingConvention.Cdecl)]
+        internal static extern bool RequestStats(IntPtr connection);
+
+        [DllImport(DllPath, CallingConvention = CallingConvention.Cdecl)]
+        internal static extern int GetStats(IntPtr connection, [Out] StatsEntry[] entries, int capacity, out long timestampUs);
+
+        [DllImport(DllPath, CallingConvention = CallingConvention.Cdecl)]
+        internal static extern int GetStatsJson(IntPtr connection, [Out] byte[] buffer, int capacity);
+
         [DllImport(DllPath, CallingConvention = CallingConvention.Cdecl)]
         internal static extern bool RegisterVideoFrameProcessed(
             IntPtr connection, VideoFrameProcessedCallback callback);
@@ -188,7 +319,19 @@ namespace WonderMediaProductions.WebRtc
         internal static extern bool RegisterRemoteTrackChanged(
             IntPtr connection, RemoteTrackChangedCallback callback);
 
+        [DllImport(DllPath, CallingConvention = CallingConvention.Cdecl)]
+        internal static extern bool SetEventQueueEnabled(IntPtr connection, bool isEnabled, long tag);
+
+        [DllImport(DllPath, CallingConvention = CallingConvention.Cdecl)]
+        internal static extern int DrainEvents([Out] PeerConnectionEvent[] events, int capacity);
+
+        [DllImport(DllPath, CallingConvention = CallingConvention.Cdecl)]
+        internal static extern bool WaitForEvents(int timeoutInMS);
+
         [DllImport(DllPath, CallingConvention = CallingConvention.Cdecl)]
         internal static extern bool CanEncodeHardwareTextures();
+
+        [DllImport(DllPath, CallingConvention = CallingConvention.Cdecl)]
+        internal static extern void GetEncoderTiming(out LatencyHistogramSnapshot snapshot, bool reset);
     }
 }
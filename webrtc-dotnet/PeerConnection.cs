@@ -1,4 +1,6 @@
 using System;
+using System.Collections.Concurrent;
+using System.Collections.Generic;
 using System.Diagnostics;
 using System.Runtime.InteropServices;
 using System.Text;
@@ -10,9 +12,25 @@ namespace WonderMediaProductions.WebRtc
     {
         private static int g_LastId;
 
+        private static long g_LastEventTag;
+
+        // The connections that use the event queue, by the tag of their events.
+        private static readonly ConcurrentDictionary<long, PeerConnection> g_EventTargets = new ConcurrentDictionary<long, PeerConnection>();
+
+        private static readonly Native.PeerConnectionEvent[] g_Events = new Native.PeerConnectionEvent[256];
+
+        // Reused by SendDataBatch, batches larger than this copy their messages to a temporary buffer instead.
+        private const int MaxPooledBatchLength = 1 << 20;
+
+        [ThreadStatic] private static Native.DataMessageDescriptor[] g_BatchDescriptors;
+        [ThreadStatic] private static byte[] g_BatchResults;
+        [ThreadStatic] private static byte[] g_BatchData;
+
         // ReSharper disable NotAccessedField.Local
         private readonly Native.AudioBusReadyCallback _audioBusReadyDelegate;
         private readonly Native.DataAvailableCallback _dataAvailableDelegate;
+        private readonly Native.DataBufferAvailableCallback _dataBufferAvailableDelegate;
+        private readonly Native.DataChannelBufferedAmountLowCallback _dataChannelBufferedAmountLowDelegate;
         private readonly Native.FailureMessageCallback _failureMessageDelegate;
         private readonly Native.IceCandidateReadyToSendCallback _iceCandidateReadyToSendDelegate;
         private readonly Native.LocalDataChannelReadyCallback _localDataChannelReadyDelegate;
@@ -21,6 +39,7 @@ namespace WonderMediaProductions.WebRtc
         private readonly Native.VideoFrameCallback _remoteVideoFrameDelegate;
         private readonly Native.StateChangedCallback _signalingStateChangedCallback;
         private readonly Native.StateChangedCallback _connectionStateChangedCallback;
+        private readonly Native.StatsReadyCallback _statsReadyCallback;
         private readonly Native.VideoFrameProcessedCallback _videoFrameProcessedCallback;
         private readonly Native.RemoteTrackChangedCallback _remoteTrackChangedCallback;
 
@@ -28,6 +47,12 @@ namespace WonderMediaProductions.WebRtc
 
         private IntPtr _nativePtr;
 
+        private long _eventTag;
+
+        // Data channels are identified by an integer handle in native code, so we don't marshal the label for every message.
+        private readonly ConcurrentDictionary<int, string> _dataChannelLabels = new ConcurrentDictionary<int, string>();
+        private readonly ConcurrentDictionary<string, int> _dataChannelIds = new ConcurrentDictionary<string, int>();
+
         /// <summary>
         /// Configures all peer connections. Must be called before the first peer connection is created.
         /// </summary>
@@ -40,6 +65,12 @@ namespace WonderMediaProductions.WebRtc
                 options.AutoShutdown,
                 options.UseFakeEncoders,
                 options.UseFakeDecoders,
+                options.YuvConversionThreadCount,
+                options.SoftwareVideoEncoderThreadCount,
+                options.AllowLoopbackNetwork,
+                options.UseNetworkThread,
+                options.FactoryCount,
+                options.FactoryAssignment,
                 options.LogToStandardError,
                 options.LogToDebugOutput,
                 options.MinimumLogLevel != TraceLevel.Off ? OnMessageLogged : null,
@@ -74,6 +105,15 @@ namespace WonderMediaProductions.WebRtc
 
         public static bool SupportsHardwareTextureEncoding => Native.CanEncodeHardwareTextures();
 
+        /// <summary>
+        /// How long the video encoders of all peer connections took to encode a frame, since the previous reset.
+        /// </summary>
+        public static LatencyHistogramSnapshot GetEncoderTiming(bool reset = false)
+        {
+            Native.GetEncoderTiming(out var snapshot, reset);
+            return snapshot;
+        }
+
         public PeerConnection(PeerConnectionOptions options)
         {
             Name = options.Name ?? $"PC#{Interlocked.Increment(ref g_LastId)}";
@@ -91,6 +131,9 @@ namespace WonderMediaProductions.WebRtc
 
             RegisterCallback(out _localDataChannelReadyDelegate, Native.RegisterOnLocalDataChannelReady, RaiseLocalDataChannelReady);
             RegisterCallback(out _dataAvailableDelegate, Native.RegisterOnDataFromDataChannelReady, RaiseDataAvailable);
+            if (options.ReceiveDataBuffers)
+                RegisterCallback(out _dataBufferAvailableDelegate, Native.RegisterOnDataBufferAvailable, RaiseDataBufferAvailable);
+            RegisterCallback(out _dataChannelBufferedAmountLowDelegate, Native.RegisterOnDataChannelBufferedAmountLow, RaiseDataChannelBufferedAmountLow);
             RegisterCallback(out _failureMessageDelegate, Native.RegisterOnFailure, RaiseFailureMessage);
             RegisterCallback(out _audioBusReadyDelegate, Native.RegisterOnAudioBusReady, RaiseAudioBusReady);
             RegisterCallback(out _localVideoFrameDelegate, Native.RegisterLocalVideoFrameReady, RaiseLocalVideoFrameReady);
@@ -101,6 +144,14 @@ namespace WonderMediaProductions.WebRtc
             RegisterCallback(out _connectionStateChangedCallback, Native.RegisterConnectionStateChanged, RaiseConnectionStateChange);
             RegisterCallback(out _videoFrameProcessedCallback, Native.RegisterVideoFrameProcessed, RaiseVideoFrameProcessedDelegate);
             RegisterCallback(out _remoteTrackChangedCallback, Native.RegisterRemoteTrackChanged, RaiseRemoteTrackChanged);
+            RegisterCallback(out _statsReadyCallback, Native.RegisterOnStatsReady, RaiseStatsReady);
+
+            if (options.UseEventQueue)
+            {
+                _eventTag = Interlocked.Increment(ref g_LastEventTag);
+                g_EventTargets[_eventTag] = this;
+                Native.Check(Native.SetEventQueueEnabled(_nativePtr, true, _eventTag));
+            }
         }
 
         public string Name { get; }
@@ -117,6 +168,39 @@ namespace WonderMediaProductions.WebRtc
             return Native.PumpQueuedMessages((int)timeout.TotalMilliseconds);
         }
 
+        /// <summary>
+        /// Waits at most the timeout for the events of the connections that have <see cref="PeerConnectionOptions.UseEventQueue"/> set,
+        /// and raises all queued events on the calling thread. Only one thread at a time can dispatch the events.
+        /// </summary>
+        /// <returns>The number of dispatched events</returns>
+        public static int DispatchQueuedEvents(TimeSpan timeout)
+        {
+            lock (g_Events)
+            {
+                if (!Native.WaitForEvents((int)timeout.TotalMilliseconds))
+                    return 0;
+
+                int total = 0;
+                int count;
+
+                while ((count = Native.DrainEvents(g_Events, g_Events.Length)) > 0)
+                {
+                    for (int i = 0; i < count; ++i)
+                    {
+                        // Events of disposed connections are dropped.
+                        if (g_EventTargets.TryGetValue(g_Events[i].Tag, out var connection))
+                        {
+                            connection.RaiseQueuedEvent(ref g_Events[i]);
+                        }
+                    }
+
+                    total += count;
+                }
+
+                return total;
+            }
+        }
+
         public static TimeSpan GetRealtimeClockTimeInMicroseconds()
         {
             var timeInMicroseconds = Native.GetRealtimeClockTimeInMicroseconds();
@@ -128,9 +212,16 @@ namespace WonderMediaProductions.WebRtc
         {
             var ptr = Interlocked.Exchange(ref _nativePtr, default);
 
+            if (_eventTag != 0)
+            {
+                g_EventTargets.TryRemove(_eventTag, out _);
+            }
+
             // Detach all event handlers, it seems possible we'll get events on another thread while disposing.
             LocalDataChannelReady = null;
             DataAvailable = null;
+            DataBufferAvailable = null;
+            DataChannelBufferedAmountLow = null;
             FailureMessage = null;
             AudioBusReady = null;
             LocalVideoFrameReady = null;
@@ -141,6 +232,7 @@ namespace WonderMediaProductions.WebRtc
             ConnectionStateChanged = null;
             LocalVideoFrameProcessed = null;
             RemoteTrackChanged = null;
+            StatsReady = null;
 
             Native.ClosePeerConnection(ptr);
         }
@@ -148,17 +240,51 @@ namespace WonderMediaProductions.WebRtc
         internal int AddVideoTrack(VideoEncoderOptions options)
         {
             var id = Native.AddVideoTrack(_nativePtr, options.Label, options.MinBitsPerSecond, options.MaxBitsPerSecond, options.MaxFramesPerSecond);
-            return Native.Check(id);
+            Native.Check(id);
+
+            if (options.FrameQueueDepth > 0)
+            {
+                Native.Check(Native.ConfigureVideoTrackQueue(_nativePtr, id, options.FrameQueueDepth, options.FrameDropPolicy));
+            }
+
+            if (options.DeferFrameConversion)
+            {
+                Native.Check(Native.SetVideoTrackDeferredConversion(_nativePtr, id, true));
+            }
+
+            return id;
         }
 
-        public void AddDataChannel(DataChannelOptions options)
+        /// <returns>The handle of the data channel, to be used with <see cref="SendData(int,in ArraySegment{byte},MessageEncoding)"/></returns>
+        public int AddDataChannel(DataChannelOptions options)
         {
-            Native.Check(Native.AddDataChannel(_nativePtr, options.Label, options.IsOrdered, options.IsReliable));
+            var id = Native.AddDataChannel(_nativePtr, options.Label, options.IsOrdered, options.IsReliable);
+            Native.Check(id);
+            RegisterDataChannel(id, options.Label);
+
+            if (options.ChunkSize > 0)
+                ConfigureDataChannelChunking(id, options.ChunkSize);
+
+            if (options.MaxMessageSize > 0)
+                ConfigureDataChannelMaxMessageSize(id, options.MaxMessageSize);
+
+            if (options.IsCompressed)
+                ConfigureDataChannelCompression(id, true, options.CompressionThreshold);
+
+            return id;
         }
 
         public void RemoveDataChannel(string label)
         {
-            Native.Check(Native.RemoveDataChannel(_nativePtr, label));
+            if (_dataChannelIds.TryRemove(label, out var id))
+            {
+                _dataChannelLabels.TryRemove(id, out _);
+                Native.Check(Native.RemoveDataChannelById(_nativePtr, id));
+            }
+            else
+            {
+                Native.Check(Native.RemoveDataChannel(_nativePtr, label));
+            }
         }
 
         public void CreateOffer()
@@ -171,8 +297,179 @@ namespace WonderMediaProductions.WebRtc
             Native.Check(Native.CreateAnswer(_nativePtr));
         }
 
+        /// <summary>
+        /// Starts collecting the standard WebRTC stats, <see cref="StatsReady"/> is raised when they are available.
+        /// </summary>
+        public void RequestStats()
+        {
+            Native.Check(Native.RequestStats(_nativePtr));
+        }
+
+        /// <summary>
+        /// Copies the latest stats snapshot without allocating, see <see cref="RequestStats"/>.
+        /// </summary>
+        /// <returns>The number of entries of the snapshot, when larger than the array, only the first entries were copied.</returns>
+        public int GetStats(StatsEntry[] entries, out long timestampUs)
+        {
+            return Native.GetStats(_nativePtr, entries, entries?.Length ?? 0, out timestampUs);
+        }
+
+        /// <summary>
+        /// The latest stats report as JSON, for debugging.
+        /// </summary>
+        public string GetStatsJson()
+        {
+            var size = Native.GetStatsJson(_nativePtr, null, 0);
+            var buffer = new byte[size];
+            size = Math.Min(size, Native.GetStatsJson(_nativePtr, buffer, buffer.Length));
+            return Encoding.UTF8.GetString(buffer, 0, size - 1);
+        }
+
+        public unsafe void SendData(int channelId, in ArraySegment<byte> data, MessageEncoding encoding = MessageEncoding.Binary)
+        {
+            fixed (byte* startPtr = data.Array)
+            {
+                var ptr = new IntPtr(startPtr + data.Offset);
+                Native.Check(Native.SendDataById(_nativePtr, channelId, ptr, data.Count, encoding == MessageEncoding.Binary));
+            }
+        }
+
+        /// <summary>
+        /// Sends all messages with a single native call, which is much cheaper than sending many small messages one by one.
+        /// Messages without a <see cref="DataMessage.ChannelId"/> are sent on the data channel with their label.
+        /// </summary>
+        /// <param name="sent">When not null, receives for each message whether it was sent.</param>
+        /// <returns>The number of messages that were sent.</returns>
+        public unsafe int SendDataBatch(IReadOnlyList<DataMessage> messages, bool[] sent = null)
+        {
+            var count = messages.Count;
+            if (count == 0)
+                return 0;
+
+            if (sent != null && sent.Length < count)
+                throw new ArgumentException($"Must have room for {count} results", nameof(sent));
+
+            var dataLength = 0;
+            for (int i = 0; i < count; ++i)
+                dataLength += messages[i].Content.Count;
+
+            // The messages are copied to one buffer, so it is pinned once instead of every message separately.
+            var descriptors = GetBatchBuffer(ref g_BatchDescriptors, count);
+            var results = GetBatchBuffer(ref g_BatchResults, count);
+            var data = dataLength <= MaxPooledBatchLength ? GetBatchBuffer(ref g_BatchData, dataLength) : new byte[dataLength];
+
+            int sentCount;
+
+            fixed (Native.DataMessageDescriptor* descriptorsPtr = descriptors)
+            fixed (byte* resultsPtr = results)
+            fixed (byte* dataPtr = data)
+            {
+                var offset = 0;
+
+                for (int i = 0; i < count; ++i)
+                {
+                    var message = messages[i];
+                    var content = message.Content;
+
+                    var channelId = message.ChannelId;
+                    if (channelId == 0)
+                        _dataChannelIds.TryGetValue(message.Label, out channelId);
+
+                    if (content.Count > 0)
+                        Buffer.BlockCopy(content.Array, content.Offset, data, offset, content.Count);
+
+                    descriptorsPtr[i].Data = new IntPtr(dataPtr + offset);
+                    descriptorsPtr[i].Length = content.Count;
+                    descriptorsPtr[i].ChannelId = channelId;
+                    descriptorsPtr[i].IsBinary = message.Encoding == MessageEncoding.Binary ? 1 : 0;
+
+                    offset += content.Count;
+                }
+
+                sentCount = Native.SendDataBatch(_nativePtr, descriptorsPtr, count, resultsPtr);
+            }
+
+            if (sent != null)
+            {
+                for (int i = 0; i < count; ++i)
+                    sent[i] = results[i] != 0;
+            }
+
+            return sentCount;
+        }
+
+        private static T[] GetBatchBuffer<T>(ref T[] buffer, int length)
+        {
+            if (buffer == null || buffer.Length < length)
+                buffer = new T[Math.Max(Math.Max(length, 16), (buffer?.Length ?? 0) * 2)];
+
+            return buffer;
+        }
+
+        /// <summary>
+        /// With a positive <paramref name="chunkSize"/>, messages larger than it are split in chunks, which are reassembled by the receiver.
+        /// Small messages can be sent in between the chunks, so they are not blocked by a large message.
+        /// Both peers must enable chunking on the channel before sending any message, e.g. with a chunk size of 16 KB.
+        /// </summary>
+        public void ConfigureDataChannelChunking(int channelId, int chunkSize)
+        {
+            Native.Check(Native.ConfigureDataChannelChunking(_nativePtr, channelId, chunkSize));
+        }
+
+        /// <summary>
+        /// Received messages that are reassembled from chunks or decompressed are dropped when larger than <paramref name="maxMessageSize"/>,
+        /// 16 MB by default and at most 256 MB.
+        /// The sender chooses the size of a message, so this bounds the memory it can make us allocate.
+        /// </summary>
+        public void ConfigureDataChannelMaxMessageSize(int channelId, int maxMessageSize)
+        {
+            Native.Check(Native.ConfigureDataChannelMaxMessageSize(_nativePtr, channelId, maxMessageSize));
+        }
+
+        /// <summary>
+        /// When enabled, messages of at least <paramref name="threshold"/> bytes are compressed with deflate, when that makes them smaller.
+        /// Both peers must enable compression on the channel before sending any message.
+        /// </summary>
+        /// <param name="level">The zlib compression level, from 1 (fastest) to 9 (smallest), or -1 for the default.</param>
+        public void ConfigureDataChannelCompression(int channelId, bool isEnabled, int threshold = 256, int level = -1)
+        {
+            Native.Check(Native.ConfigureDataChannelCompression(_nativePtr, channelId, isEnabled, level, threshold));
+        }
+
+        public DataChannelStats GetDataChannelStats(int channelId)
+        {
+            Native.Check(Native.GetDataChannelStats(_nativePtr, channelId, out var stats));
+            return stats;
+        }
+
+        /// <summary>
+        /// The number of bytes that are waiting to be sent on the data channel, including the messages queued natively.
+        /// </summary>
+        public long GetDataChannelBufferedAmount(int channelId)
+        {
+            var amount = Native.GetDataChannelBufferedAmount(_nativePtr, channelId);
+            Native.Check(amount >= 0);
+            return amount;
+        }
+
+        /// <summary>
+        /// <see cref="DataChannelBufferedAmountLow"/> is raised when the buffered amount drops to <paramref name="lowWaterMark"/> bytes, a negative value disables it.
+        /// When <paramref name="highWaterMark"/> is positive, messages that would exceed it are queued natively
+        /// and sent once the buffered amount drops, instead of overflowing the channel.
+        /// </summary>
+        public void ConfigureDataChannelBuffering(int channelId, long lowWaterMark, long highWaterMark = 0)
+        {
+            Native.Check(Native.ConfigureDataChannelBuffering(_nativePtr, channelId, lowWaterMark, highWaterMark));
+        }
+
         public unsafe void SendData(string label, in ArraySegment<byte> data, MessageEncoding encoding = MessageEncoding.Binary)
         {
+            if (_dataChannelIds.TryGetValue(label, out var id))
+            {
+                SendData(id, data, encoding);
+                return;
+            }
+
             fixed (byte* startPtr = data.Array)
             {
                 var ptr = new IntPtr(startPtr + data.Offset);
@@ -193,7 +490,10 @@ namespace WonderMediaProductions.WebRtc
 
         public void SendData(DataMessage msg)
         {
-            SendData(msg.Label, msg.Content, msg.Encoding);
+            if (msg.ChannelId != 0)
+                SendData(msg.ChannelId, msg.Content, msg.Encoding);
+            else
+                SendData(msg.Label, msg.Content, msg.Encoding);
         }
 
         internal void SendVideoFrame(int trackId, IntPtr rgbaPixels, int stride, int width, int height, VideoFrameFormat videoFrameFormat)
@@ -202,6 +502,44 @@ namespace WonderMediaProductions.WebRtc
             Native.Check(Native.SendVideoFrame(_nativePtr, trackId, rgbaPixels, stride, width, height, videoFrameFormat));
         }
 
+        internal void SendVideoFrameYuv(int trackId, IntPtr dataY, IntPtr dataU, IntPtr dataV, int strideY, int strideU, int strideV, int width, int height, VideoFrameFormat videoFrameFormat)
+        {
+            Native.Check(dataY != default && dataU != default);
+            Native.Check(Native.SendVideoFrameYuv(_nativePtr, trackId, dataY, dataU, dataV, strideY, strideU, strideV, width, height, videoFrameFormat));
+        }
+
+        internal VideoTrackStats GetVideoTrackStats(int trackId)
+        {
+            Native.Check(Native.GetVideoTrackStats(_nativePtr, trackId, out var stats));
+            return stats;
+        }
+
+        internal VideoTrackLatency GetVideoTrackLatency(int trackId, bool reset)
+        {
+            Native.Check(Native.GetVideoTrackLatency(_nativePtr, trackId, out var latency, reset));
+            return latency;
+        }
+
+        /// <summary>
+        /// Converts and scales the frames passed to <see cref="RemoteVideoFrameReceived"/> in native code.
+        /// </summary>
+        /// <param name="format"><see cref="VideoFrameFormat.I420"/>, or a packed 32-bit RGB format</param>
+        /// <param name="width">The width of the frames, or zero to follow the aspect ratio, or to keep the size when the height is zero too.</param>
+        /// <param name="height">The height of the frames, or zero to follow the aspect ratio, or to keep the size when the width is zero too.</param>
+        public void SetRemoteVideoFrameOptions(VideoFrameFormat format, int width = 0, int height = 0)
+        {
+            Native.Check(Native.SetRemoteVideoFrameOptions(_nativePtr, format, width, height));
+        }
+
+        /// <summary>
+        /// The <see cref="VideoFrame.TrackId"/> of the frames received by the remote video track of the transceiver,
+        /// or zero when it has no remote video track. Known when <see cref="RemoteTrackChanged"/> is raised.
+        /// </summary>
+        public int GetRemoteVideoTrackId(string transceiverMid)
+        {
+            return Native.GetRemoteVideoTrackId(_nativePtr, transceiverMid);
+        }
+
         public void SetAudioControl(bool isMute, bool isRecord)
         {
             Native.Check(Native.SetAudioControl(_nativePtr, isMute, isRecord));
@@ -216,7 +554,7 @@ namespace WonderMediaProductions.WebRtc
 
         public void SetRemoteDescription(SessionDescription sd)
         {
-	        SetRemoteDescription(sd.Type, sd.Sdp);
+	        SetRemoteDescription(sd.Type, sd.Sdp);
         }
 
         public void AddIceCandidate(string candidate, int sdpMlineindex, string sdpMid)
@@ -237,22 +575,90 @@ namespace WonderMediaProductions.WebRtc
             Native.Check(register(_nativePtr, delegateField));
         }
 
-        private void RaiseLocalDataChannelReady(string label)
+        private void RaiseQueuedEvent(ref Native.PeerConnectionEvent e)
+        {
+            switch (e.Type)
+            {
+                case Native.PeerConnectionEventType.LocalSdpReadyToSend:
+                    RaiseLocalSdpReadyToSend(Marshal.PtrToStringAnsi(e.Text), Marshal.PtrToStringAnsi(e.Data));
+                    break;
+                case Native.PeerConnectionEventType.IceCandidateReadyToSend:
+                    RaiseIceCandidateReadyToSend(Marshal.PtrToStringAnsi(e.Data), e.Id, Marshal.PtrToStringAnsi(e.Text));
+                    break;
+                case Native.PeerConnectionEventType.SignalingStateChanged:
+                    RaiseSignalingStateChange((int)e.Value);
+                    break;
+                case Native.PeerConnectionEventType.ConnectionStateChanged:
+                    RaiseConnectionStateChange((int)e.Value);
+                    break;
+                case Native.PeerConnectionEventType.RemoteTrackChanged:
+                    RaiseRemoteTrackChanged(Marshal.PtrToStringAnsi(e.Text), e.Id, (int)e.Value);
+                    break;
+                case Native.PeerConnectionEventType.Failure:
+                    RaiseFailureMessage(Marshal.PtrToStringAnsi(e.Data));
+                    break;
+                case Native.PeerConnectionEventType.LocalDataChannelReady:
+                    RaiseLocalDataChannelReady(e.Id, Marshal.PtrToStringAnsi(e.Data));
+                    break;
+                case Native.PeerConnectionEventType.DataAvailable:
+                    RaiseDataAvailable(e.Id, e.Data, e.Length, e.Value != 0);
+                    break;
+                case Native.PeerConnectionEventType.DataChannelBufferedAmountLow:
+                    RaiseDataChannelBufferedAmountLow(e.Id, (ulong)e.Value);
+                    break;
+                case Native.PeerConnectionEventType.VideoFrameProcessed:
+                    RaiseVideoFrameProcessedDelegate(e.Id, e.Data, e.Value != 0);
+                    break;
+                case Native.PeerConnectionEventType.StatsReady:
+                    RaiseStatsReady(e.Value);
+                    break;
+            }
+        }
+
+        private void RegisterDataChannel(int channelId, string label)
         {
+            _dataChannelLabels[channelId] = label;
+            _dataChannelIds[label] = channelId;
+        }
+
+        private void RaiseLocalDataChannelReady(int channelId, string label)
+        {
+            RegisterDataChannel(channelId, label);
             LocalDataChannelReady?.Invoke(this, label);
         }
 
-        private void RaiseDataAvailable(string label, IntPtr data, int size, bool isBinary)
+        private void RaiseDataAvailable(int channelId, IntPtr data, int size, bool isBinary)
         {
+            _dataChannelLabels.TryGetValue(channelId, out var label);
+
             byte[] buffer = new byte[size];
             Marshal.Copy(data, buffer, 0, size);
             DataAvailable?.Invoke(this, new DataMessage(
                 label,
+                channelId,
                 new ArraySegment<byte>(buffer, 0, size),
                 isBinary ? MessageEncoding.Binary : MessageEncoding.Utf8)
             );
         }
 
+        private void RaiseDataBufferAvailable(int channelId, IntPtr buffer, IntPtr data, int size, bool isBinary)
+        {
+            _dataChannelLabels.TryGetValue(channelId, out var label);
+
+            var dataBuffer = new DataBuffer(buffer, label, channelId, data, size, isBinary ? MessageEncoding.Binary : MessageEncoding.Utf8);
+
+            var handler = DataBufferAvailable;
+            if (handler != null)
+                handler(this, dataBuffer);
+            else
+                dataBuffer.Dispose();
+        }
+
+        private void RaiseDataChannelBufferedAmountLow(int channelId, ulong bufferedAmount)
+        {
+            DataChannelBufferedAmountLow?.Invoke(this, channelId, bufferedAmount);
+        }
+
         private void RaiseFailureMessage(string msg)
         {
             FailureMessage?.Invoke(this, msg);
@@ -266,31 +672,39 @@ namespace WonderMediaProductions.WebRtc
         }
 
         private void RaiseLocalVideoFrameReady(
+            int trackId,
             IntPtr texture,
             IntPtr dataY, IntPtr dataU, IntPtr dataV, IntPtr dataA,
             int strideY, int strideU, int strideV, int strideA,
-            int width, int height, long timeStampUs)
+            int width, int height, long timeStampUs,
+            VideoFrameFormat format)
         {
             LocalVideoFrameReady?.Invoke(this,
                 VideoFrame.FromNative(
+                    trackId,
                     texture,
                     dataY, dataU, dataV, dataA,
                     strideY, strideU, strideV, strideA,
-                    width, height, timeStampUs));
+                    width, height, timeStampUs,
+                    format));
         }
 
         private void RaiseRemoteVideoFrameReady(
+            int trackId,
             IntPtr texture,
             IntPtr dataY, IntPtr dataU, IntPtr dataV, IntPtr dataA,
             int strideY, int strideU, int strideV, int strideA,
-            int width, int height, long timeStampUs)
+            int width, int height, long timeStampUs,
+            VideoFrameFormat format)
         {
             RemoteVideoFrameReceived?.Invoke(this,
                 VideoFrame.FromNative(
+                    trackId,
                     texture,
                     dataY, dataU, dataV, dataA,
                     strideY, strideU, strideV, strideA,
-                    width, height, timeStampUs));
+                    width, height, timeStampUs,
+                    format));
         }
 
         private void RaiseLocalSdpReadyToSend(string type, string sdp)
@@ -298,6 +712,11 @@ namespace WonderMediaProductions.WebRtc
             LocalSdpReadyToSend?.Invoke(this, new SessionDescription(type, sdp));
         }
 
+        private void RaiseStatsReady(long timestampUs)
+        {
+            StatsReady?.Invoke(this, timestampUs);
+        }
+
         private void RaiseIceCandidateReadyToSend(string candidate, int sdpMlineIndex, string sdpMid)
         {
             IceCandidateReadyToSend?.Invoke(this, new IceCandidate(candidate, sdpMlineIndex, sdpMid));
@@ -336,6 +755,18 @@ namespace WonderMediaProductions.WebRtc
 
         public event LocalDataChannelReadyDelegate LocalDataChannelReady;
         public event DataAvailableDelegate DataAvailable;
+
+        /// <summary>
+        /// Raised instead of <see cref="DataAvailable"/> when <see cref="PeerConnectionOptions.ReceiveDataBuffers"/> is set.
+        /// The handler becomes the owner of the buffer, and must dispose it when done, possibly on another thread.
+        /// </summary>
+        public event DataBufferAvailableDelegate DataBufferAvailable;
+
+        /// <summary>
+        /// Raised on the signaling thread when the buffered amount of a data channel drops to its low-water mark,
+        /// see <see cref="ConfigureDataChannelBuffering"/>.
+        /// </summary>
+        public event DataChannelBufferedAmountLowDelegate DataChannelBufferedAmountLow;
         public event FailureMessageDelegate FailureMessage;
         public event AudioBusReadyDelegate AudioBusReady;
         public event VideoFrameReadyDelegate LocalVideoFrameReady;
@@ -346,5 +777,10 @@ namespace WonderMediaProductions.WebRtc
         public event ConnectionStateChangedDelegate ConnectionStateChanged;
         public event VideoFrameProcessedDelegate LocalVideoFrameProcessed;
         public event RemoteTrackChangedDelegate RemoteTrackChanged;
+
+        /// <summary>
+        /// Raised on the signaling thread when the stats requested with <see cref="RequestStats"/> are available.
+        /// </summary>
+        public event StatsReadyDelegate StatsReady;
     }
-}
+}
@@ -12,5 +12,17 @@ namespace WonderMediaProductions.WebRtc
         public bool CanReceiveAudio;
         public bool CanReceiveVideo;
         public bool IsDtlsSrtpEnabled  = true;
+
+        /// <summary>
+        /// When set, received data channel messages are raised through <see cref="PeerConnection.DataBufferAvailable"/> without copying,
+        /// instead of through <see cref="PeerConnection.DataAvailable"/>.
+        /// </summary>
+        public bool ReceiveDataBuffers;
+
+        /// <summary>
+        /// When set, the events of the connection are queued natively, and raised by <see cref="PeerConnection.DispatchQueuedEvents"/>
+        /// on the thread that calls it, instead of on the WebRTC threads. The video frame, audio and data buffer events are still raised directly.
+        /// </summary>
+        public bool UseEventQueue;
     }
 }
\ No newline at end of file
@@ -0,0 +1,34 @@
+﻿using System.Runtime.InteropServices;
+
+namespace WonderMediaProductions.WebRtc
+{
+    /// <summary>
+    /// A single value of a stats snapshot, see <see cref="PeerConnection.GetStats"/>
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    public struct StatsEntry
+    {
+        public double Value;
+
+        public StatsFieldId FieldId;
+
+        /// <summary>
+        /// The SSRC of RTP stream values, 0 otherwise.
+        /// </summary>
+        public uint Ssrc;
+
+        public StatsMediaKind MediaKind;
+
+        private int _isRemote;
+
+        /// <summary>
+        /// True for the values of remote tracks.
+        /// </summary>
+        public bool IsRemote => _isRemote != 0;
+
+        public override string ToString()
+        {
+            return $"{FieldId}: {Value}, {nameof(Ssrc)}: {Ssrc}, {nameof(MediaKind)}: {MediaKind}, {nameof(IsRemote)}: {IsRemote}";
+        }
+    }
+}
@@ -0,0 +1,56 @@
+﻿namespace WonderMediaProductions.WebRtc
+{
+    /// <summary>
+    /// Identifies a value of a <see cref="StatsEntry"/>, these numbers never change.
+    /// </summary>
+    public enum StatsFieldId
+    {
+        // Of the nominated ICE candidate pair.
+
+        /// <summary>Seconds</summary>
+        CurrentRoundTripTime = 1,
+        /// <summary>Bits per second</summary>
+        AvailableOutgoingBitrate = 2,
+        /// <summary>Bits per second</summary>
+        AvailableIncomingBitrate = 3,
+
+        // Of an outbound RTP stream.
+
+        PacketsSent = 10,
+        BytesSent = 11,
+        FramesEncoded = 12,
+        EncoderQpSum = 13,
+        /// <summary>Bits per second</summary>
+        TargetBitrate = 14,
+        NackCountReceived = 15,
+        PliCountReceived = 16,
+        FirCountReceived = 17,
+        /// <summary>Seconds</summary>
+        TotalEncodeTime = 18,
+
+        // Of an inbound RTP stream.
+
+        PacketsReceived = 30,
+        BytesReceived = 31,
+        PacketsLost = 32,
+        /// <summary>Seconds</summary>
+        Jitter = 33,
+        FramesDecoded = 34,
+        DecoderQpSum = 35,
+        NackCountSent = 36,
+        PliCountSent = 37,
+        FirCountSent = 38,
+
+        // Of a media stream track, see StatsEntry.IsRemote.
+
+        FrameWidth = 50,
+        FrameHeight = 51,
+        FramesPerSecond = 52,
+        FramesSent = 53,
+        FramesReceived = 54,
+        FramesDropped = 55,
+        /// <summary>Seconds</summary>
+        JitterBufferDelay = 56,
+        AudioLevel = 57
+    }
+}
@@ -0,0 +1,9 @@
+﻿namespace WonderMediaProductions.WebRtc
+{
+    public enum StatsMediaKind
+    {
+        None = 0,
+        Audio = 1,
+        Video = 2
+    }
+}
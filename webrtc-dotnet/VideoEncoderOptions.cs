@@ -10,6 +10,21 @@
 
         public int MaxBitsPerSecond = OptimalBitsPerSecond(640, 480, 30, VideoMotion.High);
 
+        /// <summary>
+        /// When non-zero, sending a frame only queues it, and a native worker thread converts and encodes it.
+        /// Wait for <see cref="VideoTrack.LocalVideoFrameProcessed"/> before reusing the pixels.
+        /// </summary>
+        public int FrameQueueDepth = 0;
+
+        public VideoFrameDropPolicy FrameDropPolicy = VideoFrameDropPolicy.DropOldest;
+
+        /// <summary>
+        /// When set, RGBA frames are not copied when sent, but only converted when the encoder needs them,
+        /// so frames that are dropped due to bandwidth constraints are never converted.
+        /// Wait for <see cref="VideoTrack.LocalVideoFrameProcessed"/> before reusing the pixels.
+        /// </summary>
+        public bool DeferFrameConversion = false;
+
         public static VideoEncoderOptions OptimizedFor(
             int width, 
             int height, 
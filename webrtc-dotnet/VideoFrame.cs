@@ -19,6 +19,12 @@ namespace WonderMediaProductions.WebRtc
         /// </remarks>
         public readonly TimeSpan TimeStamp;
 
+        /// <summary>
+        /// Distinguishes the frames of multiple remote video tracks, see <see cref="PeerConnection.GetRemoteVideoTrackId"/>.
+        /// Zero for local frames.
+        /// </summary>
+        public int TrackId { get; private set; }
+
         protected VideoFrame(int width, int height, long timeStampUs)
         {
             Width = width;
@@ -27,18 +33,27 @@ namespace WonderMediaProductions.WebRtc
         }
 
         internal static VideoFrame FromNative(
+            int trackId,
             IntPtr texture,
             IntPtr dataY, IntPtr dataU, IntPtr dataV, IntPtr dataA,
             int strideY, int strideU, int strideV, int strideA,
-            int width, int height, long timeStampUs)
+            int width, int height, long timeStampUs,
+            VideoFrameFormat format)
         {
-            if (texture == IntPtr.Zero)
-                return new VideoFrameYuvAlpha(
+            VideoFrame frame;
+
+            if (format >= VideoFrameFormat.Rgba32 && format <= VideoFrameFormat.Abgr32)
+                frame = new VideoFramePacked(dataY, strideY, format, width, height, timeStampUs);
+            else if (texture == IntPtr.Zero)
+                frame = new VideoFrameYuvAlpha(
                     dataY, dataU, dataV, dataA,
                     strideY, strideU, strideV, strideA,
                     width, height, timeStampUs);
+            else
+                frame = new VideoFrameTexture(texture, width, height, timeStampUs);
 
-            return new VideoFrameTexture(texture, width, height, timeStampUs);
+            frame.TrackId = trackId;
+            return frame;
         }
     }
 }
\ No newline at end of file
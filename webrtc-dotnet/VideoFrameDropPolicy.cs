@@ -0,0 +1,18 @@
+﻿namespace WonderMediaProductions.WebRtc
+{
+    /// <summary>
+    /// What to do when a video frame is sent while the track's frame queue is full.
+    /// </summary>
+    public enum VideoFrameDropPolicy
+    {
+        /// <summary>
+        /// Drop the oldest queued frame, to keep the latency low.
+        /// </summary>
+        DropOldest,
+
+        /// <summary>
+        /// Drop the frame that is being sent.
+        /// </summary>
+        DropNewest
+    }
+}
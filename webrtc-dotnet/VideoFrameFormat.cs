@@ -53,5 +53,30 @@
 		/// Pre-encoded H264 data.
 		/// </summary>
 		EncodedH264,
+
+        /// <summary>
+        /// Software encoder pixel format, 8-bit planar Y U V with 2x2 subsampled chroma in system memory
+        /// </summary>
+        /// <remarks>
+        /// When passed to SendVideoFrame, the U and V planes must directly follow the Y plane,
+        /// with half the stride of the Y plane.
+        /// </remarks>
+        I420,
+
+        /// <summary>
+        /// Software encoder pixel format, 8-bit Y plane followed by an interleaved U V plane with 2x2 subsampled chroma in system memory
+        /// </summary>
+        /// <remarks>
+        /// When passed to SendVideoFrame, the UV plane must directly follow the Y plane, with the same stride.
+        /// </remarks>
+        Nv12,
+
+        /// <summary>
+        /// Software encoder pixel format, 8-bit planar Y U V without chroma subsampling in system memory
+        /// </summary>
+        /// <remarks>
+        /// When passed to SendVideoFrame, the U and V planes must directly follow the Y plane, with the same stride.
+        /// </remarks>
+        I444,
 	};
 }
\ No newline at end of file
@@ -0,0 +1,23 @@
+﻿using System;
+
+namespace WonderMediaProductions.WebRtc
+{
+    /// <summary>
+    /// A frame with 8-bit packed pixels, see <see cref="PeerConnection.SetRemoteVideoFrameOptions"/>
+    /// </summary>
+    public sealed class VideoFramePacked : VideoFrame
+    {
+        // TODO: Convert IntPtr to Memory as soon as this is part of .NET Standard
+        public readonly IntPtr Data;
+        public readonly int Stride;
+        public readonly VideoFrameFormat Format;
+
+        public VideoFramePacked(IntPtr data, int stride, VideoFrameFormat format, int width, int height, long timeStampUs)
+            : base(width, height, timeStampUs)
+        {
+            Data = data;
+            Stride = stride;
+            Format = format;
+        }
+    }
+}
@@ -37,6 +37,33 @@ namespace WonderMediaProductions.WebRtc
             PeerConnection.SendVideoFrame(TrackId, rgbaPixels, stride, width, height, videoFrameFormat);
         }
 
+        /// <summary>
+        /// Sends a planar YUV frame without converting it to I420 first.
+        /// </summary>
+        /// <remarks>
+        /// The planes are not copied, they must stay valid until the frame is reported as processed.
+        /// For <see cref="VideoFrameFormat.Nv12"/>, pass the interleaved UV plane as <paramref name="dataU"/>
+        /// and <see cref="IntPtr.Zero"/> as <paramref name="dataV"/>.
+        /// </remarks>
+        public void SendVideoFrameYuv(IntPtr dataY, IntPtr dataU, IntPtr dataV, int strideY, int strideU, int strideV, int width, int height, VideoFrameFormat videoFrameFormat)
+        {
+            PeerConnection.SendVideoFrameYuv(TrackId, dataY, dataU, dataV, strideY, strideU, strideV, width, height, videoFrameFormat);
+        }
+
+        public VideoTrackStats GetStats()
+        {
+            return PeerConnection.GetVideoTrackStats(TrackId);
+        }
+
+        /// <summary>
+        /// Summarizes the latencies of the encoded frames.
+        /// </summary>
+        /// <param name="reset">Restart the histograms, to get the latencies per polling interval.</param>
+        public VideoTrackLatency GetLatency(bool reset = false)
+        {
+            return PeerConnection.GetVideoTrackLatency(TrackId, reset);
+        }
+
         protected override void OnDispose(bool isDisposing)
         {
             if (isDisposing)
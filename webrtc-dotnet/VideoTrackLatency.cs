@@ -0,0 +1,31 @@
+﻿using System.Runtime.InteropServices;
+
+namespace WonderMediaProductions.WebRtc
+{
+    /// <summary>
+    /// Latencies of the frames encoded on a local <see cref="VideoTrack"/>
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    public struct VideoTrackLatency
+    {
+        /// <summary>
+        /// From sending the frame until the encoder starts encoding it, including queueing and conversion.
+        /// </summary>
+        public LatencyHistogramSnapshot SubmitToEncode;
+
+        /// <summary>
+        /// Until the encoder produced the image.
+        /// </summary>
+        public LatencyHistogramSnapshot Encode;
+
+        /// <summary>
+        /// Until the image was packetized.
+        /// </summary>
+        public LatencyHistogramSnapshot EncodeToSend;
+
+        public override string ToString()
+        {
+            return $"{nameof(SubmitToEncode)}: {{{SubmitToEncode}}}, {nameof(Encode)}: {{{Encode}}}, {nameof(EncodeToSend)}: {{{EncodeToSend}}}";
+        }
+    }
+}
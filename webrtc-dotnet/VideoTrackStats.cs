@@ -0,0 +1,53 @@
+﻿using System.Runtime.InteropServices;
+
+namespace WonderMediaProductions.WebRtc
+{
+    /// <summary>
+    /// Statistics of a local <see cref="VideoTrack"/>
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    public struct VideoTrackStats
+    {
+        /// <summary>
+        /// Number of I420 buffers that were recycled from the track's buffer pool.
+        /// </summary>
+        public long BufferPoolHitCount;
+
+        /// <summary>
+        /// Number of I420 buffers that had to be allocated.
+        /// </summary>
+        public long BufferPoolMissCount;
+
+        /// <summary>
+        /// Maximum number of I420 buffers that were pooled at the same time.
+        /// </summary>
+        public long BufferPoolHighWaterMark;
+
+        /// <summary>
+        /// Number of frames that were dropped because the frame queue was full.
+        /// </summary>
+        /// <seealso cref="VideoEncoderOptions.FrameQueueDepth"/>
+        public long QueueDroppedFrameCount;
+
+        /// <summary>
+        /// Number of frames that were sent on the track.
+        /// </summary>
+        public long SubmittedFrameCount;
+
+        /// <summary>
+        /// Number of frames that were encoded.
+        /// </summary>
+        public long EncodedFrameCount;
+
+        /// <summary>
+        /// Number of frames that were dropped, either by the frame queue, or by WebRTC due to bandwidth or CPU constraints.
+        /// </summary>
+        public long DroppedFrameCount;
+
+        public override string ToString()
+        {
+            return $"{nameof(BufferPoolHitCount)}: {BufferPoolHitCount}, {nameof(BufferPoolMissCount)}: {BufferPoolMissCount}, {nameof(BufferPoolHighWaterMark)}: {BufferPoolHighWaterMark}, {nameof(QueueDroppedFrameCount)}: {QueueDroppedFrameCount}, " +
+                   $"{nameof(SubmittedFrameCount)}: {SubmittedFrameCount}, {nameof(EncodedFrameCount)}: {EncodedFrameCount}, {nameof(DroppedFrameCount)}: {DroppedFrameCount}";
+        }
+    }
+}
@@ -0,0 +1,320 @@
+#include "pch.h"
+#include "DataChannelSender.h"
+#include "DataChunkAssembler.h"
+#include "NativeTest.h"
+
+using namespace webrtc;
+
+namespace
+{
+    // Keeps the sent bytes buffered until drained, like a channel whose transport is slower than the sender.
+    class FakeDataChannel : public DataChannelInterface
+    {
+    public:
+        void RegisterObserver(DataChannelObserver* observer) override {}
+        void UnregisterObserver() override {}
+        std::string label() const override { return "fake"; }
+        bool reliable() const override { return true; }
+        int id() const override { return 0; }
+        DataState state() const override { return kOpen; }
+        uint32_t messages_sent() const override { return static_cast<uint32_t>(sent_tags.size()); }
+        uint64_t bytes_sent() const override { return 0; }
+        uint32_t messages_received() const override { return 0; }
+        uint64_t bytes_received() const override { return 0; }
+        uint64_t buffered_amount() const override { return buffered_amount_; }
+        void Close() override {}
+
+        bool Send(const DataBuffer& buffer) override
+        {
+            sent_tags.push_back(buffer.data.cdata()[0]);
+            sent_data.push_back(buffer.data);
+            buffered_amount_ += buffer.size();
+
+            if (on_send)
+            {
+                on_send();
+            }
+
+            return true;
+        }
+
+        // Returns the buffered amount before draining.
+        uint64_t Drain()
+        {
+            return buffered_amount_.exchange(0);
+        }
+
+        // Called from within Send, after the message was buffered.
+        std::function<void()> on_send;
+        std::vector<uint8_t> sent_tags;
+        std::vector<rtc::CopyOnWriteBuffer> sent_data;
+
+    private:
+        std::atomic<uint64_t> buffered_amount_{ 0 };
+    };
+
+    // Every byte of the message is the tag, so the sent messages can be told apart.
+    DataBuffer CreateMessage(uint8_t tag, size_t size)
+    {
+        rtc::CopyOnWriteBuffer data(size);
+        memset(data.data(), tag, size);
+        return DataBuffer(data, true);
+    }
+
+    rtc::scoped_refptr<FakeDataChannel> CreateChannel()
+    {
+        return new rtc::RefCountedObject<FakeDataChannel>();
+    }
+
+    bool IsPrefixedMessage(uint8_t prefix, uint8_t tag, size_t size, const rtc::CopyOnWriteBuffer& data, size_t offset)
+    {
+        if (data.size() != offset + 1 + size || data.cdata()[offset] != prefix)
+            return false;
+
+        return std::all_of(data.cdata() + offset + 1, data.cdata() + data.size(), [tag](uint8_t value) { return value == tag; });
+    }
+}
+
+NATIVE_TEST(DataChannelSenderQueuesAboveHighWaterMark)
+{
+    const auto channel = CreateChannel();
+    DataChannelSender sender(1, channel.get(), nullptr, nullptr);
+    sender.high_water_mark = 100;
+
+    for (uint8_t tag = 1; tag <= 3; ++tag)
+    {
+        EXPECT_TRUE(sender.Send(CreateMessage(tag, 60)));
+    }
+
+    EXPECT_EQ(1u, channel->sent_tags.size());
+    EXPECT_EQ(180u, sender.buffered_amount());
+
+    // Each time the transport drained the channel, one more message fits.
+    sender.OnBufferedAmountChange(channel->Drain());
+    EXPECT_EQ(2u, channel->sent_tags.size());
+    EXPECT_EQ(120u, sender.buffered_amount());
+
+    sender.OnBufferedAmountChange(channel->Drain());
+    EXPECT_EQ(3u, channel->sent_tags.size());
+    EXPECT_EQ(60u, sender.buffered_amount());
+
+    for (uint8_t tag = 1; tag <= 3; ++tag)
+    {
+        EXPECT_EQ(tag, channel->sent_tags[tag - 1]);
+    }
+}
+
+NATIVE_TEST(DataChannelSenderKeepsOrderWhenBufferingIsDisabled)
+{
+    const auto channel = CreateChannel();
+    DataChannelSender sender(1, channel.get(), nullptr, nullptr);
+    sender.high_water_mark = 100;
+
+    EXPECT_TRUE(sender.Send(CreateMessage(1, 60)));
+    EXPECT_TRUE(sender.Send(CreateMessage(2, 60)));
+    EXPECT_EQ(1u, channel->sent_tags.size());
+
+    // Still queued messages go first, even when new messages would no longer be queued.
+    sender.high_water_mark = 0;
+    EXPECT_TRUE(sender.Send(CreateMessage(3, 60)));
+
+    EXPECT_EQ(3u, channel->sent_tags.size());
+    EXPECT_EQ(2, channel->sent_tags[1]);
+    EXPECT_EQ(3, channel->sent_tags[2]);
+
+    EXPECT_TRUE(sender.Send(CreateMessage(4, 60)));
+    EXPECT_EQ(4, channel->sent_tags[3]);
+    EXPECT_EQ(240u, sender.buffered_amount());
+}
+
+NATIVE_TEST(DataChannelSenderDoesNotOvertakeQueuedMessageBeingSent)
+{
+    const auto channel = CreateChannel();
+    DataChannelSender sender(1, channel.get(), nullptr, nullptr);
+    sender.high_water_mark = 100;
+
+    EXPECT_TRUE(sender.Send(CreateMessage(1, 60)));
+    EXPECT_TRUE(sender.Send(CreateMessage(2, 60)));
+
+    rtc::Event send_started(false, false);
+    rtc::Event release_send(false, false);
+
+    channel->on_send = [&]
+    {
+        if (channel->sent_tags.size() == 2)
+        {
+            send_started.Set();
+            release_send.Wait(rtc::Event::kForever);
+        }
+    };
+
+    // The queued message is no longer counted as pending while the channel sends it.
+    std::thread drainer([&] { sender.OnBufferedAmountChange(channel->Drain()); });
+    EXPECT_TRUE(send_started.Wait(5000));
+
+    sender.high_water_mark = 0;
+    std::thread host([&] { sender.Send(CreateMessage(3, 60)); });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    const auto sent_count_during_send = channel->sent_tags.size();
+
+    release_send.Set();
+    drainer.join();
+    host.join();
+
+    EXPECT_EQ(2u, sent_count_during_send);
+    EXPECT_EQ(3u, channel->sent_tags.size());
+    EXPECT_EQ(3, channel->sent_tags[2]);
+}
+
+NATIVE_TEST(DataChannelSenderLeavesContendedMessagesOfSignalingThreadInInbox)
+{
+    const auto channel = CreateChannel();
+    const auto signaling_thread = rtc::Thread::Create();
+    signaling_thread->Start();
+
+    DataChannelSender sender(1, channel.get(), signaling_thread.get(), nullptr);
+    sender.high_water_mark = 1 << 20;
+
+    rtc::Event send_started(false, false);
+    rtc::Event release_send(false, false);
+
+    channel->on_send = [&]
+    {
+        if (channel->sent_tags.size() == 1)
+        {
+            send_started.Set();
+            release_send.Wait(rtc::Event::kForever);
+        }
+    };
+
+    // The host holds the send lock while its send is proxied to the signaling thread.
+    std::thread host([&] { sender.Send(CreateMessage(1, 10)); });
+    EXPECT_TRUE(send_started.Wait(5000));
+
+    // Blocking on the lock here would deadlock a real channel, so the message waits in the inbox.
+    const auto is_sent = signaling_thread->Invoke<bool>(RTC_FROM_HERE, [&] { return sender.Send(CreateMessage(2, 10)); });
+    EXPECT_TRUE(is_sent);
+    EXPECT_EQ(1u, channel->sent_tags.size());
+    EXPECT_EQ(20u, sender.buffered_amount());
+
+    // The host sends it before its send returns.
+    release_send.Set();
+    host.join();
+
+    EXPECT_EQ(2u, channel->sent_tags.size());
+    EXPECT_EQ(2, channel->sent_tags[1]);
+    EXPECT_EQ(20u, sender.buffered_amount());
+
+    signaling_thread->Stop();
+}
+
+NATIVE_TEST(DataChannelSenderContinuesAfterNestedBufferedAmountChange)
+{
+    const auto channel = CreateChannel();
+    bool is_in_channel_send = false;
+    std::vector<uint64_t> low_amounts;
+    int nested_low_count = 0;
+
+    DataChannelSender sender(1, channel.get(), nullptr, [&](uint64_t amount)
+    {
+        low_amounts.push_back(amount);
+        nested_low_count += is_in_channel_send;
+    });
+
+    sender.high_water_mark = 100;
+    sender.low_water_mark = 50;
+
+    for (uint8_t tag = 1; tag <= 3; ++tag)
+    {
+        EXPECT_TRUE(sender.Send(CreateMessage(tag, 60)));
+    }
+
+    // The channel transmits right away, and reports it from within Send, like it does on the signaling thread.
+    channel->on_send = [&]
+    {
+        is_in_channel_send = true;
+        sender.OnBufferedAmountChange(channel->Drain());
+        is_in_channel_send = false;
+    };
+
+    sender.OnBufferedAmountChange(channel->Drain());
+
+    EXPECT_EQ(3u, channel->sent_tags.size());
+    EXPECT_EQ(3, channel->sent_tags[2]);
+    EXPECT_EQ(0u, sender.buffered_amount());
+
+    EXPECT_EQ(1u, low_amounts.size());
+    EXPECT_EQ(0u, low_amounts[0]);
+    EXPECT_EQ(0, nested_low_count);
+}
+
+NATIVE_TEST(DataChannelSenderNotifiesLowWaterMarkOnce)
+{
+    const auto channel = CreateChannel();
+    std::vector<uint64_t> low_amounts;
+
+    DataChannelSender sender(1, channel.get(), nullptr, [&](uint64_t amount) { low_amounts.push_back(amount); });
+    sender.high_water_mark = 100;
+    sender.low_water_mark = 50;
+
+    for (uint8_t tag = 1; tag <= 3; ++tag)
+    {
+        EXPECT_TRUE(sender.Send(CreateMessage(tag, 60)));
+    }
+
+    // Still above the low-water mark while queued messages move to the channel.
+    sender.OnBufferedAmountChange(channel->Drain());
+    sender.OnBufferedAmountChange(channel->Drain());
+    EXPECT_EQ(0u, low_amounts.size());
+
+    sender.OnBufferedAmountChange(channel->Drain());
+    EXPECT_EQ(1u, low_amounts.size());
+    EXPECT_EQ(0u, low_amounts[0]);
+
+    // Staying below the mark is not another crossing.
+    sender.OnBufferedAmountChange(channel->Drain());
+    EXPECT_TRUE(sender.Send(CreateMessage(4, 40)));
+    sender.OnBufferedAmountChange(channel->Drain());
+    EXPECT_EQ(1u, low_amounts.size());
+}
+
+NATIVE_TEST(DataChannelSenderWritesPrefixWhenFraming)
+{
+    const auto channel = CreateChannel();
+    DataChannelSender sender(1, channel.get(), nullptr, nullptr);
+
+    EXPECT_TRUE(sender.Send(CreateMessage(1, 10), uint8_t{ 0xA5 }));
+    EXPECT_TRUE(IsPrefixedMessage(0xA5, 1, 10, channel->sent_data[0], 0));
+
+    // Queued messages count their prefix.
+    sender.high_water_mark = 15;
+    EXPECT_TRUE(sender.Send(CreateMessage(2, 10), uint8_t{ 0xA5 }));
+    EXPECT_EQ(1u, channel->sent_data.size());
+    EXPECT_EQ(22u, sender.buffered_amount());
+
+    sender.OnBufferedAmountChange(channel->Drain());
+    EXPECT_TRUE(IsPrefixedMessage(0xA5, 2, 10, channel->sent_data[1], 0));
+    channel->Drain();
+
+    // The prefix is part of the first chunk, and of the message size and offsets.
+    sender.high_water_mark = 0;
+    sender.chunk_size = DataChunkHeader::kSize + 4;
+    EXPECT_TRUE(sender.Send(CreateMessage(3, 10), uint8_t{ 0xA5 }));
+
+    while (sender.buffered_amount() > 0)
+    {
+        sender.OnBufferedAmountChange(channel->Drain());
+    }
+
+    EXPECT_EQ(5u, channel->sent_data.size());
+
+    DataChunkAssembler assembler;
+    rtc::CopyOnWriteBuffer message;
+    size_t offset = 0;
+
+    EXPECT_TRUE(!assembler.Add(channel->sent_data[2], 100, &message, &offset));
+    EXPECT_TRUE(!assembler.Add(channel->sent_data[3], 100, &message, &offset));
+    EXPECT_TRUE(assembler.Add(channel->sent_data[4], 100, &message, &offset));
+    EXPECT_TRUE(IsPrefixedMessage(0xA5, 3, 10, message, offset));
+}
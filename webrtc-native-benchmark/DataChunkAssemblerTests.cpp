@@ -0,0 +1,221 @@
+#include "pch.h"
+#include "DataChunkAssembler.h"
+#include "NativeTest.h"
+
+using webrtc::DataChunkAssembler;
+
+namespace
+{
+    const size_t kMaxMessageSize = DataChunkAssembler::kDefaultMaxMessageSize;
+
+    rtc::CopyOnWriteBuffer CreateMessage(size_t size, uint8_t seed)
+    {
+        rtc::CopyOnWriteBuffer message(size);
+        for (size_t i = 0; i < size; ++i)
+        {
+            message.data()[i] = static_cast<uint8_t>(seed + i * 31);
+        }
+        return message;
+    }
+
+    std::vector<rtc::CopyOnWriteBuffer> CreateChunks(uint32_t message_id, const rtc::CopyOnWriteBuffer& message, size_t chunk_length)
+    {
+        std::vector<rtc::CopyOnWriteBuffer> chunks;
+        for (size_t offset = 0; offset < message.size(); offset += chunk_length)
+        {
+            const auto length = std::min(chunk_length, message.size() - offset);
+            chunks.push_back(webrtc::CreateDataChunk(message_id, message, offset, length, true).data);
+        }
+        return chunks;
+    }
+
+    rtc::CopyOnWriteBuffer CreateChunkHeader(uint32_t message_id, uint32_t message_size, uint32_t offset, size_t length)
+    {
+        rtc::CopyOnWriteBuffer chunk(webrtc::DataChunkHeader::kSize + length);
+        memset(chunk.data(), 0, chunk.size());
+        rtc::SetLE32(chunk.data() + 0, message_id);
+        rtc::SetLE32(chunk.data() + 4, message_size);
+        rtc::SetLE32(chunk.data() + 8, offset);
+        return chunk;
+    }
+
+    bool IsMessage(const rtc::CopyOnWriteBuffer& expected, const rtc::CopyOnWriteBuffer& buffer, size_t offset)
+    {
+        return buffer.size() - offset == expected.size() &&
+            memcmp(buffer.cdata() + offset, expected.cdata(), expected.size()) == 0;
+    }
+}
+
+NATIVE_TEST(DataChunkAssemblerDeliversSingleChunkMessageAsIs)
+{
+    DataChunkAssembler assembler;
+    const auto message = CreateMessage(100, 1);
+    const auto chunks = CreateChunks(7, message, 100);
+
+    rtc::CopyOnWriteBuffer received;
+    size_t offset = 0;
+
+    EXPECT_TRUE(assembler.Add(chunks[0], kMaxMessageSize, &received, &offset));
+    EXPECT_EQ(size_t(webrtc::DataChunkHeader::kSize), offset);
+    EXPECT_TRUE(IsMessage(message, received, offset));
+}
+
+NATIVE_TEST(DataChunkAssemblerReassemblesInterleavedMessages)
+{
+    DataChunkAssembler assembler;
+    const auto first = CreateMessage(10000, 1);
+    const auto second = CreateMessage(5000, 2);
+    const auto first_chunks = CreateChunks(1, first, 1024);
+    const auto second_chunks = CreateChunks(2, second, 1024);
+
+    rtc::CopyOnWriteBuffer received;
+    size_t offset = 0;
+    int delivered_count = 0;
+
+    for (size_t i = 0; i < std::max(first_chunks.size(), second_chunks.size()); ++i)
+    {
+        if (i < first_chunks.size() && assembler.Add(first_chunks[i], kMaxMessageSize, &received, &offset))
+        {
+            EXPECT_EQ(first_chunks.size() - 1, i);
+            EXPECT_TRUE(IsMessage(first, received, offset));
+            ++delivered_count;
+        }
+
+        if (i < second_chunks.size() && assembler.Add(second_chunks[i], kMaxMessageSize, &received, &offset))
+        {
+            EXPECT_EQ(second_chunks.size() - 1, i);
+            EXPECT_TRUE(IsMessage(second, received, offset));
+            ++delivered_count;
+        }
+    }
+
+    EXPECT_EQ(2, delivered_count);
+}
+
+NATIVE_TEST(DataChunkAssemblerReassemblesPrefixedMessages)
+{
+    const auto message = CreateMessage(1000, 4);
+
+    rtc::CopyOnWriteBuffer expected(1 + message.size());
+    expected.data()[0] = 0xA5;
+    memcpy(expected.data() + 1, message.cdata(), message.size());
+
+    // The prefix makes up the whole first chunk, part of it, and the only chunk.
+    for (const size_t chunk_length : { 1, 100, 1001 })
+    {
+        DataChunkAssembler assembler;
+        rtc::CopyOnWriteBuffer received;
+        size_t offset = 0;
+        size_t delivered_index = 0;
+
+        for (size_t start = 0, i = 0; start < expected.size(); start += chunk_length, ++i)
+        {
+            const auto length = std::min(chunk_length, expected.size() - start);
+            const auto chunk = webrtc::CreateDataChunk(5, message, start, length, true, uint8_t{ 0xA5 }).data;
+
+            if (assembler.Add(chunk, kMaxMessageSize, &received, &offset))
+            {
+                delivered_index = i + 1;
+            }
+        }
+
+        EXPECT_EQ((expected.size() + chunk_length - 1) / chunk_length, delivered_index);
+        EXPECT_TRUE(IsMessage(expected, received, offset));
+    }
+}
+
+NATIVE_TEST(DataChunkAssemblerReassemblesOutOfOrderChunks)
+{
+    DataChunkAssembler assembler;
+    const auto message = CreateMessage(10000, 3);
+    auto chunks = CreateChunks(1, message, 1024);
+
+    // The last chunk first, so the buffer has to keep the gap for the others.
+    std::reverse(chunks.begin(), chunks.end());
+    std::swap(chunks[1], chunks[chunks.size() - 1]);
+
+    rtc::CopyOnWriteBuffer received;
+    size_t offset = 0;
+
+    for (size_t i = 0; i + 1 < chunks.size(); ++i)
+    {
+        EXPECT_TRUE(!assembler.Add(chunks[i], kMaxMessageSize, &received, &offset));
+    }
+
+    EXPECT_TRUE(assembler.Add(chunks.back(), kMaxMessageSize, &received, &offset));
+    EXPECT_TRUE(IsMessage(message, received, offset));
+}
+
+NATIVE_TEST(DataChunkAssemblerDropsMessagesAboveTheLimit)
+{
+    DataChunkAssembler assembler;
+    const auto message = CreateMessage(4096, 4);
+    const auto chunks = CreateChunks(1, message, 1024);
+
+    rtc::CopyOnWriteBuffer received;
+    size_t offset = 0;
+
+    for (const auto& chunk : chunks)
+    {
+        EXPECT_TRUE(!assembler.Add(chunk, 4095, &received, &offset));
+    }
+
+    // The peer claims a huge message, which must be dropped before anything is allocated for it.
+    EXPECT_TRUE(!assembler.Add(CreateChunkHeader(2, 0xFFFFFFFF, 0, 16), kMaxMessageSize, &received, &offset));
+    EXPECT_TRUE(!assembler.Add(CreateChunkHeader(3, DataChunkAssembler::kMaxMessageSize + 1, 0, 16), ~size_t(0), &received, &offset));
+
+    for (const auto& chunk : chunks)
+    {
+        assembler.Add(chunk, 4096, &received, &offset);
+    }
+
+    EXPECT_TRUE(IsMessage(message, received, offset));
+}
+
+NATIVE_TEST(DataChunkAssemblerDropsChunksBeyondTheirMessage)
+{
+    DataChunkAssembler assembler;
+
+    rtc::CopyOnWriteBuffer received;
+    size_t offset = 0;
+
+    EXPECT_TRUE(!assembler.Add(CreateChunkHeader(1, 100, 90, 16), kMaxMessageSize, &received, &offset));
+    EXPECT_TRUE(!assembler.Add(rtc::CopyOnWriteBuffer(webrtc::DataChunkHeader::kSize - 1), kMaxMessageSize, &received, &offset));
+
+    // A chunk that disagrees with the size of its message is dropped, the message is still completed.
+    const auto message = CreateMessage(2048, 5);
+    const auto chunks = CreateChunks(2, message, 1024);
+
+    EXPECT_TRUE(!assembler.Add(chunks[0], kMaxMessageSize, &received, &offset));
+    EXPECT_TRUE(!assembler.Add(CreateChunkHeader(2, 4096, 1024, 1024), kMaxMessageSize, &received, &offset));
+    EXPECT_TRUE(assembler.Add(chunks[1], kMaxMessageSize, &received, &offset));
+    EXPECT_TRUE(IsMessage(message, received, offset));
+}
+
+NATIVE_TEST(DataChunkAssemblerReusesRecycledBuffers)
+{
+    DataChunkAssembler assembler;
+
+    rtc::CopyOnWriteBuffer received;
+    size_t offset = 0;
+
+    const auto first = CreateMessage(8192, 6);
+    for (const auto& chunk : CreateChunks(1, first, 1024))
+    {
+        assembler.Add(chunk, kMaxMessageSize, &received, &offset);
+    }
+
+    EXPECT_TRUE(IsMessage(first, received, offset));
+    const auto first_data = received.cdata();
+    assembler.Recycle(std::move(received));
+
+    // A smaller message fits in the recycled buffer.
+    const auto second = CreateMessage(4096, 7);
+    for (const auto& chunk : CreateChunks(2, second, 1024))
+    {
+        assembler.Add(chunk, kMaxMessageSize, &received, &offset);
+    }
+
+    EXPECT_TRUE(IsMessage(second, received, offset));
+    EXPECT_TRUE(received.cdata() == first_data);
+}
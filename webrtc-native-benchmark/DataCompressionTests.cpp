@@ -0,0 +1,119 @@
+#include "pch.h"
+#include "DataCompression.h"
+#include "NativeTest.h"
+
+using webrtc::DataCompressionHeader;
+using webrtc::DataDeflater;
+using webrtc::DataInflater;
+
+namespace
+{
+    const size_t kMaxMessageSize = 16 << 20;
+
+    // Repetitive, so it deflates well.
+    std::vector<uint8_t> CreateText(size_t size)
+    {
+        const char pattern[] = "The quick brown fox jumps over the lazy dog. ";
+        std::vector<uint8_t> text(size);
+        for (size_t i = 0; i < size; ++i)
+        {
+            text[i] = static_cast<uint8_t>(pattern[i % (sizeof(pattern) - 1)]);
+        }
+        return text;
+    }
+
+    bool IsEqual(const std::vector<uint8_t>& expected, const uint8_t* data, size_t size)
+    {
+        return size == expected.size() && memcmp(data, expected.data(), size) == 0;
+    }
+}
+
+NATIVE_TEST(DataCompressionRoundTripsDeflatedMessages)
+{
+    DataDeflater deflater;
+    DataInflater inflater;
+    rtc::CopyOnWriteBuffer compressed;
+    rtc::CopyOnWriteBuffer inflated;
+
+    // Larger than the initial inflate buffer, so the output has to grow.
+    for (const size_t size : { size_t(1000), size_t(100000), size_t(1 << 20) })
+    {
+        const auto text = CreateText(size);
+
+        EXPECT_TRUE(deflater.Deflate(text.data(), text.size(), Z_DEFAULT_COMPRESSION, &compressed));
+        EXPECT_TRUE(compressed.size() < text.size());
+
+        const auto result = inflater.Decompress(compressed.cdata(), compressed.size(), kMaxMessageSize, &inflated);
+        EXPECT_TRUE(result == DataInflater::Result::kInflated);
+        EXPECT_TRUE(IsEqual(text, inflated.cdata(), inflated.size()));
+    }
+}
+
+NATIVE_TEST(DataCompressionPassesStoredMessages)
+{
+    DataInflater inflater;
+    rtc::CopyOnWriteBuffer inflated;
+
+    const auto text = CreateText(100);
+    std::vector<uint8_t> stored(DataCompressionHeader::kStoredSize);
+    stored[0] = DataCompressionHeader::kStored;
+    stored.insert(stored.end(), text.begin(), text.end());
+
+    const auto result = inflater.Decompress(stored.data(), stored.size(), kMaxMessageSize, &inflated);
+    EXPECT_TRUE(result == DataInflater::Result::kStored);
+    EXPECT_TRUE(IsEqual(text, stored.data() + DataCompressionHeader::kStoredSize, stored.size() - DataCompressionHeader::kStoredSize));
+}
+
+NATIVE_TEST(DataCompressionRejectsCorruptMessages)
+{
+    DataDeflater deflater;
+    DataInflater inflater;
+    rtc::CopyOnWriteBuffer compressed;
+    rtc::CopyOnWriteBuffer inflated;
+
+    const auto text = CreateText(10000);
+    EXPECT_TRUE(deflater.Deflate(text.data(), text.size(), Z_DEFAULT_COMPRESSION, &compressed));
+
+    // Truncated.
+    EXPECT_TRUE(inflater.Decompress(compressed.cdata(), compressed.size() / 2, kMaxMessageSize, &inflated) == DataInflater::Result::kInvalid);
+
+    // Garbage instead of a deflate stream.
+    auto corrupt = compressed;
+    memset(corrupt.data() + DataCompressionHeader::kDeflateSize, 0xA5, corrupt.size() - DataCompressionHeader::kDeflateSize);
+    EXPECT_TRUE(inflater.Decompress(corrupt.cdata(), corrupt.size(), kMaxMessageSize, &inflated) == DataInflater::Result::kInvalid);
+
+    // Unknown method, and too short for a header.
+    corrupt = compressed;
+    corrupt.data()[0] = 7;
+    EXPECT_TRUE(inflater.Decompress(corrupt.cdata(), corrupt.size(), kMaxMessageSize, &inflated) == DataInflater::Result::kInvalid);
+    EXPECT_TRUE(inflater.Decompress(compressed.cdata(), DataCompressionHeader::kDeflateSize - 1, kMaxMessageSize, &inflated) == DataInflater::Result::kInvalid);
+
+    // The inflater recovers for the next message.
+    EXPECT_TRUE(inflater.Decompress(compressed.cdata(), compressed.size(), kMaxMessageSize, &inflated) == DataInflater::Result::kInflated);
+    EXPECT_TRUE(IsEqual(text, inflated.cdata(), inflated.size()));
+}
+
+NATIVE_TEST(DataCompressionRejectsMessagesThatLieAboutTheirSize)
+{
+    DataDeflater deflater;
+    DataInflater inflater;
+    rtc::CopyOnWriteBuffer compressed;
+    rtc::CopyOnWriteBuffer inflated;
+
+    const auto text = CreateText(100000);
+    EXPECT_TRUE(deflater.Deflate(text.data(), text.size(), Z_DEFAULT_COMPRESSION, &compressed));
+
+    // Above the limit, rejected before inflating anything.
+    EXPECT_TRUE(inflater.Decompress(compressed.cdata(), compressed.size(), text.size() - 1, &inflated) == DataInflater::Result::kInvalid);
+
+    // A huge announced size is not allocated upfront, the output stops growing where the stream ends.
+    auto oversized = compressed;
+    rtc::SetLE32(oversized.data() + 1, static_cast<uint32_t>(kMaxMessageSize));
+    EXPECT_TRUE(inflater.Decompress(oversized.cdata(), oversized.size(), kMaxMessageSize, &inflated) == DataInflater::Result::kInvalid);
+    EXPECT_TRUE(inflated.capacity() < kMaxMessageSize);
+
+    // Inflates to more than announced.
+    auto undersized = compressed;
+    rtc::SetLE32(undersized.data() + 1, static_cast<uint32_t>(text.size() / 2));
+    EXPECT_TRUE(inflater.Decompress(undersized.cdata(), undersized.size(), kMaxMessageSize, &inflated) == DataInflater::Result::kInvalid);
+}
@@ -0,0 +1,231 @@
+#include "pch.h"
+#include "EncoderFactory.h"
+#include "TrackedVideoBuffer.h"
+#include "NativeTest.h"
+
+using namespace webrtc;
+
+namespace
+{
+    struct FakeEncoderState
+    {
+        bool drop_frames = false;
+        int encode_count = 0;
+    };
+
+    // Produces an image from within Encode, like all encoders we use do, unless it drops the frame.
+    class FakeEncoder final : public VideoEncoder
+    {
+    public:
+        explicit FakeEncoder(std::shared_ptr<FakeEncoderState> state)
+            : state_(std::move(state))
+        {
+        }
+
+        int32_t InitEncode(const VideoCodec* codec_settings, int32_t number_of_cores, size_t max_payload_size) override
+        {
+            return WEBRTC_VIDEO_CODEC_OK;
+        }
+
+        int32_t RegisterEncodeCompleteCallback(EncodedImageCallback* callback) override
+        {
+            callback_ = callback;
+            return WEBRTC_VIDEO_CODEC_OK;
+        }
+
+        int32_t Release() override
+        {
+            return WEBRTC_VIDEO_CODEC_OK;
+        }
+
+        int32_t Encode(const VideoFrame& frame, const CodecSpecificInfo* codec_specific_info, const std::vector<FrameType>* frame_types) override
+        {
+            ++state_->encode_count;
+
+            if (state_->drop_frames)
+            {
+                callback_->OnDroppedFrame(EncodedImageCallback::DropReason::kDroppedByEncoder);
+                return WEBRTC_VIDEO_CODEC_OK;
+            }
+
+            EncodedImage image(bitstream_, sizeof(bitstream_), sizeof(bitstream_));
+            image._encodedWidth = frame.width();
+            image._encodedHeight = frame.height();
+            image.SetTimestamp(frame.timestamp());
+            callback_->OnEncodedImage(image, nullptr, nullptr);
+            return WEBRTC_VIDEO_CODEC_OK;
+        }
+
+        int32_t SetRateAllocation(const VideoBitrateAllocation& allocation, uint32_t framerate) override
+        {
+            return WEBRTC_VIDEO_CODEC_OK;
+        }
+
+        EncoderInfo GetEncoderInfo() const override
+        {
+            EncoderInfo info;
+            info.supports_native_handle = true;
+            info.implementation_name = "FakeEncoder";
+            return info;
+        }
+
+    private:
+        const std::shared_ptr<FakeEncoderState> state_;
+        EncodedImageCallback* callback_ = nullptr;
+        uint8_t bitstream_[4] = { 0, 0, 0, 1 };
+    };
+
+    class FakeEncoderFactory final : public VideoEncoderFactory
+    {
+    public:
+        explicit FakeEncoderFactory(std::shared_ptr<FakeEncoderState> state)
+            : state_(std::move(state))
+        {
+        }
+
+        std::vector<SdpVideoFormat> GetSupportedFormats() const override
+        {
+            return { SdpVideoFormat("H264") };
+        }
+
+        CodecInfo QueryVideoEncoder(const SdpVideoFormat& format) const override
+        {
+            CodecInfo info;
+            info.is_hardware_accelerated = false;
+            info.has_internal_source = false;
+            return info;
+        }
+
+        std::unique_ptr<VideoEncoder> CreateVideoEncoder(const SdpVideoFormat& format) override
+        {
+            return std::make_unique<FakeEncoder>(state_);
+        }
+
+    private:
+        const std::shared_ptr<FakeEncoderState> state_;
+    };
+
+    class ImageCounter final : public EncodedImageCallback
+    {
+    public:
+        Result OnEncodedImage(const EncodedImage& encoded_image, const CodecSpecificInfo* codec_specific_info, const RTPFragmentationHeader* fragmentation) override
+        {
+            ++image_count;
+            return Result(Result::OK);
+        }
+
+        void OnDroppedFrame(DropReason reason) override
+        {
+            ++dropped_count;
+        }
+
+        int image_count = 0;
+        int dropped_count = 0;
+    };
+
+    class FrameEventsRecorder final : public VideoFrameEvents
+    {
+    public:
+        void OnFrameProcessed(int video_track_id, const void* pixels, bool was_encoded) override
+        {
+            outcomes.push_back(was_encoded);
+        }
+
+        std::vector<bool> outcomes;
+    };
+
+    struct TrackingEncoderFixture
+    {
+        TrackingEncoderFixture()
+            : state(std::make_shared<FakeEncoderState>())
+            , encode_timing(std::make_shared<LatencyHistogram>())
+            , factory(CreateTrackingEncoderFactory(std::make_unique<FakeEncoderFactory>(state), encode_timing))
+            , encoder(factory->CreateVideoEncoder(SdpVideoFormat("H264")))
+        {
+            encoder->RegisterEncodeCompleteCallback(&images);
+        }
+
+        int64_t GetEncodeCount()
+        {
+            LatencyHistogramSnapshot snapshot;
+            encode_timing->GetSnapshot(&snapshot, false);
+            return snapshot.count;
+        }
+
+        const std::shared_ptr<FakeEncoderState> state;
+        const std::shared_ptr<LatencyHistogram> encode_timing;
+        const std::unique_ptr<VideoEncoderFactory> factory;
+        const std::unique_ptr<VideoEncoder> encoder;
+        ImageCounter images;
+    };
+
+    VideoFrame CreateFrame(rtc::scoped_refptr<VideoFrameBuffer> buffer)
+    {
+        return VideoFrame::Builder()
+            .set_video_frame_buffer(buffer)
+            .set_rotation(kVideoRotation_0)
+            .set_timestamp_us(0)
+            .build();
+    }
+
+    // Sends a tracked frame to the encoder, as it arrives without and with native handle support.
+    void EncodeTrackedFrame(TrackingEncoderFixture& fixture, FrameEventsRecorder* events, bool convert_to_i420)
+    {
+        rtc::scoped_refptr<VideoFrameLifetime> lifetime = new rtc::RefCountedObject<VideoFrameLifetime>(
+            1, &fixture, events, nullptr, 0);
+
+        rtc::scoped_refptr<TrackedVideoBuffer> buffer = new rtc::RefCountedObject<CpuVideoBuffer>(lifetime, I420Buffer::Create(16, 16));
+
+        const auto frame = convert_to_i420
+            ? CreateFrame(buffer->ToI420())
+            : CreateFrame(buffer);
+
+        fixture.encoder->Encode(frame, nullptr, nullptr);
+    }
+}
+
+NATIVE_TEST(TrackingEncoderRecordsTheEncodeTimeOfProducedImages)
+{
+    TrackingEncoderFixture fixture;
+
+    const auto frame = CreateFrame(I420Buffer::Create(16, 16));
+
+    fixture.encoder->Encode(frame, nullptr, nullptr);
+    fixture.state->drop_frames = true;
+    fixture.encoder->Encode(frame, nullptr, nullptr);
+    fixture.state->drop_frames = false;
+    fixture.encoder->Encode(frame, nullptr, nullptr);
+
+    EXPECT_EQ(3, fixture.state->encode_count);
+    EXPECT_EQ(2, fixture.images.image_count);
+    EXPECT_EQ(1, fixture.images.dropped_count);
+    EXPECT_EQ(2, fixture.GetEncodeCount());
+}
+
+NATIVE_TEST(TrackingEncoderForwardsTheEncoderInfo)
+{
+    TrackingEncoderFixture fixture;
+
+    const auto info = fixture.encoder->GetEncoderInfo();
+    EXPECT_TRUE(info.supports_native_handle);
+    EXPECT_EQ(std::string("FakeEncoder"), info.implementation_name);
+}
+
+NATIVE_TEST(TrackingEncoderReportsWhetherTrackedFramesWereEncoded)
+{
+    TrackingEncoderFixture fixture;
+    FrameEventsRecorder events;
+
+    for (const bool convert_to_i420 : { false, true })
+    {
+        EncodeTrackedFrame(fixture, &events, convert_to_i420);
+
+        fixture.state->drop_frames = true;
+        EncodeTrackedFrame(fixture, &events, convert_to_i420);
+        fixture.state->drop_frames = false;
+    }
+
+    // The frames are released when Encode returns, since the fake encoder keeps no reference.
+    EXPECT_TRUE((events.outcomes == std::vector<bool>{ true, false, true, false }));
+    EXPECT_EQ(2, fixture.GetEncodeCount());
+}
@@ -0,0 +1,60 @@
+#include "pch.h"
+#include "EventQueue.h"
+#include "NativeTest.h"
+
+using webrtc::EventQueue;
+
+namespace
+{
+    void PushEvents(EventQueue& queue, int count)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            PeerConnectionEvent event{};
+            event.type = PeerConnectionEventType::DataAvailable;
+            event.value = i;
+            queue.Push(event, nullptr, 0, nullptr);
+        }
+    }
+}
+
+NATIVE_TEST(EventQueueSignalsEventsLeftByDrain)
+{
+    EventQueue queue;
+    PeerConnectionEvent events[2];
+
+    PushEvents(queue, 5);
+
+    for (int first = 0; first < 4; first += 2)
+    {
+        EXPECT_TRUE(queue.Wait(0));
+        EXPECT_EQ(2, queue.Drain(events, 2));
+        EXPECT_EQ(first, events[0].value);
+        EXPECT_EQ(first + 1, events[1].value);
+    }
+
+    EXPECT_TRUE(queue.Wait(0));
+    EXPECT_EQ(1, queue.Drain(events, 2));
+    EXPECT_EQ(4, events[0].value);
+
+    EXPECT_TRUE(!queue.Wait(0));
+    EXPECT_EQ(0, queue.Drain(events, 2));
+}
+
+NATIVE_TEST(EventQueueSignalsOnceAfterDrainingEverything)
+{
+    EventQueue queue;
+    PeerConnectionEvent events[4];
+
+    PushEvents(queue, 4);
+
+    EXPECT_TRUE(queue.Wait(0));
+    EXPECT_EQ(4, queue.Drain(events, 4));
+    EXPECT_TRUE(!queue.Wait(0));
+
+    PushEvents(queue, 1);
+
+    EXPECT_TRUE(queue.Wait(0));
+    EXPECT_EQ(1, queue.Drain(events, 4));
+    EXPECT_TRUE(!queue.Wait(0));
+}
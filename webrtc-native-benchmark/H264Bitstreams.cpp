@@ -0,0 +1,239 @@
+#include "pch.h"
+#include "H264Bitstreams.h"
+
+namespace
+{
+    // Writes the RBSP of a NAL unit, with emulation prevention.
+    class NaluWriter final
+    {
+    public:
+        explicit NaluWriter(uint8_t header)
+        {
+            bytes_.push_back(header);
+        }
+
+        void WriteBits(uint32_t value, int count)
+        {
+            for (int i = count - 1; i >= 0; --i)
+            {
+                current_ = static_cast<uint8_t>((current_ << 1) | ((value >> i) & 1));
+
+                if (++bit_count_ == 8)
+                {
+                    WriteByte(current_);
+                    current_ = 0;
+                    bit_count_ = 0;
+                }
+            }
+        }
+
+        // Exp-Golomb codes.
+        void WriteUnsigned(uint32_t value)
+        {
+            const auto code = value + 1;
+
+            int length = 0;
+            while ((code >> length) > 1)
+                ++length;
+
+            WriteBits(0, length);
+            WriteBits(code, length + 1);
+        }
+
+        void WriteSigned(int32_t value)
+        {
+            WriteUnsigned(value > 0 ? 2 * value - 1 : -2 * value);
+        }
+
+        // The rbsp_trailing_bits.
+        std::vector<uint8_t> Finish()
+        {
+            WriteBits(1, 1);
+
+            while (bit_count_ != 0)
+                WriteBits(0, 1);
+
+            return bytes_;
+        }
+
+    private:
+        void WriteByte(uint8_t value)
+        {
+            if (zero_count_ >= 2 && value <= 3)
+            {
+                bytes_.push_back(3);
+                zero_count_ = 0;
+            }
+
+            bytes_.push_back(value);
+            zero_count_ = value == 0 ? zero_count_ + 1 : 0;
+        }
+
+        std::vector<uint8_t> bytes_;
+        uint8_t current_ = 0;
+        int bit_count_ = 0;
+        int zero_count_ = 0;
+    };
+
+    const int kMacroblockWidth = 2;
+    const int kMacroblockHeight = 2;
+    const int kInitialQp = 26;
+
+    std::vector<uint8_t> CreateSps()
+    {
+        NaluWriter writer(0x67);
+        writer.WriteBits(66, 8);    // profile_idc: baseline
+        writer.WriteBits(0, 8);     // constraint flags
+        writer.WriteBits(31, 8);    // level_idc
+        writer.WriteUnsigned(0);    // seq_parameter_set_id
+        writer.WriteUnsigned(0);    // log2_max_frame_num_minus4
+        writer.WriteUnsigned(2);    // pic_order_cnt_type
+        writer.WriteUnsigned(1);    // max_num_ref_frames
+        writer.WriteBits(0, 1);     // gaps_in_frame_num_value_allowed_flag
+        writer.WriteUnsigned(kMacroblockWidth - 1);
+        writer.WriteUnsigned(kMacroblockHeight - 1);
+        writer.WriteBits(1, 1);     // frame_mbs_only_flag
+        writer.WriteBits(1, 1);     // direct_8x8_inference_flag
+        writer.WriteBits(0, 1);     // frame_cropping_flag
+        writer.WriteBits(0, 1);     // vui_parameters_present_flag
+        return writer.Finish();
+    }
+
+    std::vector<uint8_t> CreatePps()
+    {
+        NaluWriter writer(0x68);
+        writer.WriteUnsigned(0);    // pic_parameter_set_id
+        writer.WriteUnsigned(0);    // seq_parameter_set_id
+        writer.WriteBits(0, 1);     // entropy_coding_mode_flag
+        writer.WriteBits(0, 1);     // bottom_field_pic_order_in_frame_present_flag
+        writer.WriteUnsigned(0);    // num_slice_groups_minus1
+        writer.WriteUnsigned(0);    // num_ref_idx_l0_default_active_minus1
+        writer.WriteUnsigned(0);    // num_ref_idx_l1_default_active_minus1
+        writer.WriteBits(0, 1);     // weighted_pred_flag
+        writer.WriteBits(0, 2);     // weighted_bipred_idc
+        writer.WriteSigned(kInitialQp - 26);
+        writer.WriteSigned(0);      // pic_init_qs_minus26
+        writer.WriteSigned(0);      // chroma_qp_index_offset
+        writer.WriteBits(1, 1);     // deblocking_filter_control_present_flag
+        writer.WriteBits(0, 1);     // constrained_intra_pred_flag
+        writer.WriteBits(0, 1);     // redundant_pic_cnt_present_flag
+        return writer.Finish();
+    }
+
+    // Only the slice header is valid, the parsers never read the slice data.
+    std::vector<uint8_t> CreateSlice(bool is_idr, int frame_num, int first_macroblock, int qp)
+    {
+        NaluWriter writer(is_idr ? 0x65 : 0x41);
+        writer.WriteUnsigned(first_macroblock);
+        writer.WriteUnsigned(is_idr ? 7 : 5);   // slice_type: I or P
+        writer.WriteUnsigned(0);    // pic_parameter_set_id
+        writer.WriteBits(frame_num, 4);
+
+        if (is_idr)
+        {
+            writer.WriteUnsigned(0);    // idr_pic_id
+            writer.WriteBits(0, 1);     // no_output_of_prior_pics_flag
+            writer.WriteBits(0, 1);     // long_term_reference_flag
+        }
+        else
+        {
+            writer.WriteBits(0, 1);     // num_ref_idx_active_override_flag
+            writer.WriteBits(0, 1);     // ref_pic_list_modification_flag_l0
+            writer.WriteBits(0, 1);     // adaptive_ref_pic_marking_mode_flag
+        }
+
+        writer.WriteSigned(qp - kInitialQp);
+        writer.WriteUnsigned(1);    // disable_deblocking_filter_idc
+
+        for (int i = 0; i < 64; ++i)
+        {
+            writer.WriteBits(0xA5, 8);
+        }
+
+        return writer.Finish();
+    }
+
+    void Append(std::vector<uint8_t>* bitstream, const std::vector<uint8_t>& nalu, bool long_start_code)
+    {
+        if (long_start_code)
+        {
+            bitstream->push_back(0);
+        }
+
+        bitstream->insert(bitstream->end(), { 0, 0, 1 });
+        bitstream->insert(bitstream->end(), nalu.begin(), nalu.end());
+    }
+
+    void AppendSlices(std::vector<uint8_t>* bitstream, bool is_idr, int frame_num, const std::vector<int>& slice_qps)
+    {
+        const auto slice_count = static_cast<int>(slice_qps.size());
+        const auto macroblocks_per_slice = kMacroblockWidth * kMacroblockHeight / std::max(1, slice_count);
+
+        for (int i = 0; i < slice_count; ++i)
+        {
+            Append(bitstream, CreateSlice(is_idr, frame_num, i * macroblocks_per_slice, slice_qps[i]), i + 1 < slice_count);
+        }
+    }
+}
+
+std::vector<uint8_t> CreateH264KeyFrame(const std::vector<int>& slice_qps)
+{
+    std::vector<uint8_t> bitstream;
+    Append(&bitstream, CreateSps(), true);
+    Append(&bitstream, CreatePps(), true);
+    AppendSlices(&bitstream, true, 0, slice_qps);
+    return bitstream;
+}
+
+std::vector<uint8_t> CreateH264DeltaFrame(int frame_num, const std::vector<int>& slice_qps)
+{
+    std::vector<uint8_t> bitstream;
+    AppendSlices(&bitstream, false, frame_num, slice_qps);
+    return bitstream;
+}
+
+std::vector<uint8_t> CreateSyntheticH264Bitstream(size_t size, int slice_count)
+{
+    std::vector<uint8_t> bitstream(size);
+
+    // Deterministic, so runs are comparable.
+    uint32_t state = 1;
+    for (auto& byte : bitstream)
+    {
+        state = state * 1664525u + 1013904223u;
+        byte = static_cast<uint8_t>(state >> 24);
+
+        if (byte == 0)
+        {
+            byte = 0xFF;
+        }
+    }
+
+    const uint8_t slice_start[] = { 0, 0, 0, 1, 0x65 };
+    const auto slice_size = size / slice_count;
+
+    for (int i = 0; i < slice_count; ++i)
+    {
+        std::copy(std::begin(slice_start), std::end(slice_start), bitstream.begin() + i * slice_size);
+    }
+
+    return bitstream;
+}
+
+void PacketizeH264Reference(const uint8_t* data, size_t size, webrtc::RTPFragmentationHeader* fragmentation, int* qp)
+{
+    const auto nal_indices = webrtc::H264::FindNaluIndices(data, size);
+    fragmentation->VerifyAndAllocateFragmentationHeader(nal_indices.size());
+
+    for (size_t i = 0; i < nal_indices.size(); i++)
+    {
+        fragmentation->fragmentationOffset[i] = nal_indices[i].payload_start_offset;
+        fragmentation->fragmentationLength[i] = nal_indices[i].payload_size;
+        fragmentation->fragmentationPlType[i] = webrtc::H264::ParseNaluType(data[nal_indices[i].payload_start_offset]);
+        fragmentation->fragmentationTimeDiff[i] = 0;
+    }
+
+    webrtc::H264BitstreamParser parser;
+    parser.ParseBitstream(data, size);
+    parser.GetLastSliceQp(qp);
+}
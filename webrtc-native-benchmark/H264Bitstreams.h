@@ -0,0 +1,18 @@
+#pragma once
+#include <vector>
+
+// Annex B H.264 bitstreams for the tests and benchmark of H264Packetizer, and the libwebrtc code it replaced.
+
+// An IDR image of 32x32 pixels with its parameter sets and one slice per QP.
+// The NAL units are preceded by 4 byte start codes, except the last one, which has a 3 byte start code.
+std::vector<uint8_t> CreateH264KeyFrame(const std::vector<int>& slice_qps);
+
+// A P image following the key frame, without parameter sets, like most images of an encoder.
+std::vector<uint8_t> CreateH264DeltaFrame(int frame_num, const std::vector<int>& slice_qps);
+
+// Slices of random bytes without start codes or emulation prevention, so only the scanning is measured.
+std::vector<uint8_t> CreateSyntheticH264Bitstream(size_t size, int slice_count);
+
+// Packetizes like the H.264 encoders did before H264Packetizer: H264::FindNaluIndices for the fragmentation,
+// and H264BitstreamParser over the whole bitstream for the QP, which is left unchanged when it cannot be parsed.
+void PacketizeH264Reference(const uint8_t* data, size_t size, webrtc::RTPFragmentationHeader* fragmentation, int* qp);
@@ -0,0 +1,115 @@
+// Compares H264Packetizer with the libwebrtc code the H.264 encoders used before, which scans every image twice.
+// Verifies both produce the same fragmentation and QP, then reports the time per image of each.
+//
+// Pass the path of a recorded Annex B bitstream, like the debug output of the NVENC encoder, or set WEBRTC_H264_BITSTREAM,
+// to benchmark a real stream instead of a synthetic one.
+//
+// Usage: webrtc-native-h264-benchmark [bitstream path]
+
+#include "pch.h"
+#include "H264Packetizer.h"
+#include "H264Bitstreams.h"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+
+namespace
+{
+    const int kIterationCount = 50;
+
+    bool IsSameFragmentation(const webrtc::RTPFragmentationHeader& a, const webrtc::RTPFragmentationHeader& b)
+    {
+        if (a.fragmentationVectorSize != b.fragmentationVectorSize)
+            return false;
+
+        for (size_t i = 0; i < a.fragmentationVectorSize; ++i)
+        {
+            if (a.fragmentationOffset[i] != b.fragmentationOffset[i] ||
+                a.fragmentationLength[i] != b.fragmentationLength[i] ||
+                a.fragmentationPlType[i] != b.fragmentationPlType[i])
+                return false;
+        }
+
+        return true;
+    }
+
+    template <typename Function>
+    double MeasureMilliseconds(Function&& function)
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < kIterationCount; ++i)
+        {
+            function();
+        }
+
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count() / kIterationCount;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const char* path = argc > 1 ? argv[1] : std::getenv("WEBRTC_H264_BITSTREAM");
+
+    std::vector<uint8_t> bitstream;
+
+    if (path && *path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+        {
+            std::cerr << "Cannot read " << path << std::endl;
+            return 1;
+        }
+
+        bitstream.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    else
+    {
+        bitstream = CreateSyntheticH264Bitstream(4 << 20, 8);
+    }
+
+    webrtc::H264Packetizer packetizer;
+    webrtc::EncodedImage image;
+    image.qp_ = -1;
+
+    if (!packetizer.Packetize(bitstream.data(), bitstream.size(), &image))
+    {
+        std::cerr << "The bitstream has no NAL units" << std::endl;
+        return 1;
+    }
+
+    webrtc::RTPFragmentationHeader reference;
+    int reference_qp = -1;
+    PacketizeH264Reference(bitstream.data(), bitstream.size(), &reference, &reference_qp);
+
+    if (!IsSameFragmentation(reference, packetizer.fragmentation()) || reference_qp != image.qp_)
+    {
+        std::cerr << "The packetizer does not match the reference, QP " << image.qp_ << " instead of " << reference_qp << std::endl;
+        return 1;
+    }
+
+    const auto nal_count = packetizer.fragmentation().fragmentationVectorSize;
+
+    const auto reference_ms = MeasureMilliseconds([&]
+    {
+        webrtc::RTPFragmentationHeader fragmentation;
+        int qp = -1;
+        PacketizeH264Reference(bitstream.data(), bitstream.size(), &fragmentation, &qp);
+    });
+
+    const auto single_pass_ms = MeasureMilliseconds([&]
+    {
+        packetizer.Packetize(bitstream.data(), bitstream.size(), &image);
+    });
+
+    for (const auto& result : { std::make_pair("reference", reference_ms), std::make_pair("single pass", single_pass_ms) })
+    {
+        std::cout << result.first << ": " << nal_count << " NAL units in " << (bitstream.size() >> 10) << " KB, "
+            << result.second << " ms, " << bitstream.size() / result.second / 1e6 << " GB/s" << std::endl;
+    }
+
+    return 0;
+}
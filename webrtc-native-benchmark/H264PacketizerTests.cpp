@@ -0,0 +1,137 @@
+#include "pch.h"
+#include "H264Packetizer.h"
+#include "H264Bitstreams.h"
+#include "NativeTest.h"
+
+using namespace webrtc;
+
+namespace
+{
+    void ExpectSameFragmentation(const RTPFragmentationHeader& expected, const RTPFragmentationHeader& actual)
+    {
+        EXPECT_EQ(expected.fragmentationVectorSize, actual.fragmentationVectorSize);
+
+        for (size_t i = 0; i < expected.fragmentationVectorSize; ++i)
+        {
+            EXPECT_EQ(expected.fragmentationOffset[i], actual.fragmentationOffset[i]);
+            EXPECT_EQ(expected.fragmentationLength[i], actual.fragmentationLength[i]);
+            EXPECT_EQ(int{ expected.fragmentationPlType[i] }, int{ actual.fragmentationPlType[i] });
+        }
+    }
+}
+
+NATIVE_TEST(H264PacketizerMatchesTheReferenceFragmentation)
+{
+    const std::vector<std::vector<uint8_t>> bitstreams
+    {
+        CreateH264KeyFrame({ 30 }),
+        CreateH264KeyFrame({ 30, 34, 22 }),
+        CreateSyntheticH264Bitstream(1 << 20, 8),
+        // Not a multiple of the vector size, so the scalar loop finds the last start code.
+        CreateSyntheticH264Bitstream(4099, 3),
+    };
+
+    for (const auto& bitstream : bitstreams)
+    {
+        H264Packetizer packetizer;
+        EncodedImage image;
+        image.qp_ = -1;
+        EXPECT_TRUE(packetizer.Packetize(bitstream.data(), bitstream.size(), &image));
+
+        RTPFragmentationHeader reference;
+        int reference_qp = -1;
+        PacketizeH264Reference(bitstream.data(), bitstream.size(), &reference, &reference_qp);
+
+        ExpectSameFragmentation(reference, packetizer.fragmentation());
+        EXPECT_EQ(reference_qp, image.qp_);
+    }
+}
+
+NATIVE_TEST(H264PacketizerParsesTheQpOfTheLastSlice)
+{
+    const auto bitstream = CreateH264KeyFrame({ 30, 34 });
+
+    H264Packetizer packetizer;
+    EncodedImage image;
+    image.qp_ = -1;
+    EXPECT_TRUE(packetizer.Packetize(bitstream.data(), bitstream.size(), &image));
+
+    EXPECT_EQ(4, int{ packetizer.fragmentation().fragmentationVectorSize });
+    EXPECT_EQ(34, image.qp_);
+    EXPECT_TRUE(image._frameType == kVideoFrameKey);
+
+    // The reference parser must agree, so this bitstream is a meaningful comparison.
+    RTPFragmentationHeader reference;
+    int reference_qp = -1;
+    PacketizeH264Reference(bitstream.data(), bitstream.size(), &reference, &reference_qp);
+    EXPECT_EQ(34, reference_qp);
+}
+
+NATIVE_TEST(H264PacketizerParsesTheQpOfDeltaFrames)
+{
+    const auto key_frame = CreateH264KeyFrame({ 30 });
+    const auto delta_frame = CreateH264DeltaFrame(1, { 28, 40 });
+
+    H264Packetizer packetizer;
+    EncodedImage image;
+    image.qp_ = -1;
+    EXPECT_TRUE(packetizer.Packetize(key_frame.data(), key_frame.size(), &image));
+    EXPECT_TRUE(packetizer.Packetize(delta_frame.data(), delta_frame.size(), &image));
+
+    EXPECT_EQ(2, int{ packetizer.fragmentation().fragmentationVectorSize });
+    EXPECT_EQ(40, image.qp_);
+    EXPECT_TRUE(image._frameType == kVideoFrameDelta);
+}
+
+NATIVE_TEST(H264PacketizerDoesNotAllocateForDeltaFrames)
+{
+    const auto key_frame = CreateH264KeyFrame({ 30, 34 });
+
+    std::vector<std::vector<uint8_t>> delta_frames;
+    for (int i = 1; i < 16; ++i)
+    {
+        delta_frames.push_back(CreateH264DeltaFrame(i, std::vector<int>(i, 20 + i)));
+    }
+
+    H264Packetizer packetizer;
+    EncodedImage image;
+
+    // Parses the parameter sets, and grows the buffers for the images with the most NAL units.
+    EXPECT_TRUE(packetizer.Packetize(key_frame.data(), key_frame.size(), &image));
+    EXPECT_TRUE(packetizer.Packetize(delta_frames.back().data(), delta_frames.back().size(), &image));
+
+    const auto allocation_count = GetNativeTestAllocationCount();
+
+    for (int repeat = 0; repeat < 10; ++repeat)
+    {
+        for (const auto& delta_frame : delta_frames)
+        {
+            EXPECT_TRUE(packetizer.Packetize(delta_frame.data(), delta_frame.size(), &image));
+        }
+    }
+
+    EXPECT_EQ(allocation_count, GetNativeTestAllocationCount());
+    EXPECT_EQ(35, image.qp_);
+}
+
+NATIVE_TEST(H264PacketizerKeepsTheQpOfUnparsableSlices)
+{
+    // Slices of random bytes, without parameter sets.
+    const auto bitstream = CreateSyntheticH264Bitstream(4096, 2);
+
+    H264Packetizer packetizer;
+    EncodedImage image;
+    image.qp_ = 17;
+    EXPECT_TRUE(packetizer.Packetize(bitstream.data(), bitstream.size(), &image));
+    EXPECT_EQ(17, image.qp_);
+}
+
+NATIVE_TEST(H264PacketizerRejectsBitstreamsWithoutNalUnits)
+{
+    const uint8_t bitstream[] = { 0, 0, 1 };
+
+    H264Packetizer packetizer;
+    EncodedImage image;
+    EXPECT_TRUE(!packetizer.Packetize(bitstream, sizeof(bitstream), &image));
+    EXPECT_TRUE(!packetizer.Packetize(bitstream, 0, &image));
+}
@@ -0,0 +1,101 @@
+#include "pch.h"
+#include "LatencyHistogram.h"
+#include "NativeTest.h"
+
+using webrtc::LatencyHistogram;
+
+NATIVE_TEST(LatencyHistogramSplitsBucketsAtPowersOfTwo)
+{
+    // Below 16us every latency has its own bucket, then 4 buckets per power of two.
+    EXPECT_EQ(15, LatencyHistogram::GetBucketIndex(15));
+    EXPECT_EQ(16, LatencyHistogram::GetBucketIndex(16));
+    EXPECT_EQ(16, LatencyHistogram::GetBucketIndex(19));
+    EXPECT_EQ(17, LatencyHistogram::GetBucketIndex(20));
+
+    EXPECT_EQ(int64_t{ 15 }, LatencyHistogram::GetBucketUpperBound(15));
+    EXPECT_EQ(int64_t{ 19 }, LatencyHistogram::GetBucketUpperBound(16));
+    EXPECT_EQ(int64_t{ 23 }, LatencyHistogram::GetBucketUpperBound(17));
+
+    EXPECT_EQ(0, LatencyHistogram::GetBucketIndex(0));
+    EXPECT_EQ(20, LatencyHistogram::GetBucketIndex(32));
+}
+
+NATIVE_TEST(LatencyHistogramUpperBoundsMatchBuckets)
+{
+    for (int index = 0; index + 1 < LatencyHistogram::kBucketCount; ++index)
+    {
+        const auto upper_bound = LatencyHistogram::GetBucketUpperBound(index);
+        EXPECT_EQ(index, LatencyHistogram::GetBucketIndex(upper_bound));
+        EXPECT_EQ(index + 1, LatencyHistogram::GetBucketIndex(upper_bound + 1));
+    }
+}
+
+NATIVE_TEST(LatencyHistogramKeepsLargeLatenciesInLastBucket)
+{
+    const auto last = LatencyHistogram::kBucketCount - 1;
+    const auto first_in_last = LatencyHistogram::GetBucketUpperBound(last - 1) + 1;
+
+    EXPECT_EQ(last - 1, LatencyHistogram::GetBucketIndex(first_in_last - 1));
+    EXPECT_EQ(last, LatencyHistogram::GetBucketIndex(first_in_last));
+    EXPECT_EQ(last, LatencyHistogram::GetBucketIndex(std::numeric_limits<int64_t>::max()));
+    EXPECT_EQ(std::numeric_limits<int64_t>::max(), LatencyHistogram::GetBucketUpperBound(last));
+}
+
+NATIVE_TEST(LatencyHistogramClampsPercentilesToMaximum)
+{
+    LatencyHistogram histogram;
+    LatencyHistogramSnapshot snapshot{};
+
+    // The bucket of 17us reaches up to 19us.
+    histogram.Record(17);
+    histogram.GetSnapshot(&snapshot, false);
+    EXPECT_EQ(int64_t{ 17 }, snapshot.p50_us);
+    EXPECT_EQ(int64_t{ 17 }, snapshot.p99_us);
+
+    // The last bucket has no upper bound.
+    const int64_t large = int64_t{ 1 } << 40;
+    for (int i = 0; i < 99; ++i)
+    {
+        histogram.Record(large);
+    }
+
+    histogram.GetSnapshot(&snapshot, false);
+    EXPECT_EQ(int64_t{ 100 }, snapshot.count);
+    EXPECT_EQ(large, snapshot.max_us);
+    EXPECT_EQ(large, snapshot.p50_us);
+    EXPECT_EQ(large, snapshot.p99_us);
+}
+
+NATIVE_TEST(LatencyHistogramResetsWhenAsked)
+{
+    LatencyHistogram histogram;
+    LatencyHistogramSnapshot snapshot{};
+
+    for (int64_t latency = 1; latency <= 10; ++latency)
+    {
+        histogram.Record(latency);
+    }
+
+    // Negative latencies count as 0.
+    histogram.Record(-5);
+
+    histogram.GetSnapshot(&snapshot, false);
+    histogram.GetSnapshot(&snapshot, true);
+    EXPECT_EQ(int64_t{ 11 }, snapshot.count);
+    EXPECT_EQ(int64_t{ 55 }, snapshot.sum_us);
+    EXPECT_EQ(int64_t{ 10 }, snapshot.max_us);
+    EXPECT_EQ(int64_t{ 5 }, snapshot.p50_us);
+    EXPECT_EQ(int64_t{ 9 }, snapshot.p90_us);
+    EXPECT_EQ(int64_t{ 10 }, snapshot.p99_us);
+
+    histogram.GetSnapshot(&snapshot, false);
+    EXPECT_EQ(int64_t{ 0 }, snapshot.count);
+    EXPECT_EQ(int64_t{ 0 }, snapshot.sum_us);
+    EXPECT_EQ(int64_t{ 0 }, snapshot.max_us);
+    EXPECT_EQ(int64_t{ 0 }, snapshot.p50_us);
+
+    histogram.Record(3);
+    histogram.GetSnapshot(&snapshot, false);
+    EXPECT_EQ(int64_t{ 1 }, snapshot.count);
+    EXPECT_EQ(int64_t{ 3 }, snapshot.p99_us);
+}
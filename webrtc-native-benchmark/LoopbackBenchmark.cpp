@@ -0,0 +1,222 @@
+// Benchmarks two peer connections in this process, connected over the loopback interface.
+// Writes one JSON object per line with the results to stdout, and progress to stderr.
+//
+// Usage: webrtc-native-benchmark [--quick]
+
+#include "LoopbackPeer.h"
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+namespace
+{
+    const auto kConnectTimeout = std::chrono::seconds(10);
+    const auto kDrainTimeout = std::chrono::seconds(10);
+
+    // Limits the duration of the benchmarks with small messages.
+    const int64_t kMaxMessageCount = 100000;
+
+    struct BenchmarkSettings
+    {
+        int connection_count = 10;
+        int64_t data_bytes_per_size = 64 * 1024 * 1024;
+        std::chrono::milliseconds video_duration{ 5000 };
+        int video_width = 1280;
+        int video_height = 720;
+        int video_frame_rate = 60;
+    };
+
+    bool ConfigureCodecs(bool use_software_codecs)
+    {
+        // Every callback is called on the signaling thread, so the benchmark only waits for them.
+        return Configure(true, true, true, true,
+            !use_software_codecs, !use_software_codecs,
+            1, 0, true,
+            true, 1, FactoryAssignment::RoundRobin,
+            true, true, nullptr, kLogSeverityError);
+    }
+
+    const char* CodecName(bool use_software_codecs)
+    {
+        return use_software_codecs ? "software" : "fake";
+    }
+
+    void BenchmarkConnectionSetup(const BenchmarkSettings& settings)
+    {
+        LatencySamples setup_times;
+        int failures = 0;
+
+        for (int i = 0; i < settings.connection_count; ++i)
+        {
+            LoopbackPair pair(false);
+
+            const auto duration = pair.Connect(kConnectTimeout);
+            if (duration.count() < 0)
+            {
+                ++failures;
+                continue;
+            }
+
+            setup_times.Add(duration.count());
+        }
+
+        std::cout << "{\"benchmark\":\"connection_setup\""
+            << ",\"connections\":" << settings.connection_count
+            << ",\"failures\":" << failures
+            << ",\"p50_us\":" << setup_times.Percentile(50)
+            << ",\"p99_us\":" << setup_times.Percentile(99)
+            << ",\"max_us\":" << setup_times.Percentile(100)
+            << "}" << std::endl;
+    }
+
+    void BenchmarkDataChannel(const BenchmarkSettings& settings, int message_size)
+    {
+        LoopbackPair pair(false);
+
+        if (pair.Connect(kConnectTimeout).count() < 0)
+        {
+            std::cerr << "Failed to connect for the data channel benchmark" << std::endl;
+            return;
+        }
+
+        const auto message_count = std::min<int64_t>(kMaxMessageCount, std::max<int64_t>(100, settings.data_bytes_per_size / message_size));
+        const auto channel_id = pair.offerer.data_channel_id();
+
+        std::vector<uint8_t> message(message_size, 0x55);
+
+        const auto start = BenchmarkClock::now();
+
+        int64_t sent_count = 0;
+
+        for (; sent_count < message_count; ++sent_count)
+        {
+            const auto now_us = NowUs();
+            memcpy(message.data(), &now_us, sizeof(now_us));
+
+            if (!SendDataById(pair.offerer.connection(), channel_id, message.data(), message_size, true))
+                break;
+        }
+
+        const auto deadline = BenchmarkClock::now() + kDrainTimeout;
+        while (pair.answerer.received_messages < sent_count && BenchmarkClock::now() < deadline)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        const auto seconds = std::chrono::duration<double>(BenchmarkClock::now() - start).count();
+        const auto received_bytes = pair.answerer.received_bytes.load();
+
+        std::cout << "{\"benchmark\":\"data_channel\""
+            << ",\"message_size\":" << message_size
+            << ",\"sent_messages\":" << sent_count
+            << ",\"received_messages\":" << pair.answerer.received_messages
+            << ",\"throughput_mbps\":" << received_bytes * 8 / seconds / 1e6
+            << ",\"messages_per_second\":" << pair.answerer.received_messages / seconds
+            << ",\"latency_p50_us\":" << pair.answerer.message_latency.Percentile(50)
+            << ",\"latency_p99_us\":" << pair.answerer.message_latency.Percentile(99)
+            << "}" << std::endl;
+    }
+
+    void BenchmarkVideo(const BenchmarkSettings& settings, bool use_software_codecs)
+    {
+        LoopbackPair pair(true);
+
+        if (pair.Connect(kConnectTimeout).count() < 0)
+        {
+            std::cerr << "Failed to connect for the video benchmark" << std::endl;
+            return;
+        }
+
+        const auto width = settings.video_width;
+        const auto height = settings.video_height;
+        std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 4);
+
+        const auto frame_interval = std::chrono::microseconds(1000000 / settings.video_frame_rate);
+        const auto start = BenchmarkClock::now();
+        const auto end = start + settings.video_duration;
+
+        int64_t sent_frames = 0;
+
+        for (auto next = start; next < end; next += frame_interval)
+        {
+            std::this_thread::sleep_until(next);
+
+            // Change the frame, so the encoders do not skip it.
+            pixels[(sent_frames * 4) % pixels.size()] ^= 0xFF;
+
+            if (SendVideoFrame(pair.offerer.connection(), pair.video_track_id, pixels.data(), width * 4, width, height, VideoFrameFormat::RGBA32))
+            {
+                ++sent_frames;
+            }
+        }
+
+        // The frames still in flight are received shortly after.
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+        const auto seconds = std::chrono::duration<double>(settings.video_duration).count();
+
+        std::cout << "{\"benchmark\":\"video\""
+            << ",\"codec\":\"" << CodecName(use_software_codecs) << "\""
+            << ",\"width\":" << width
+            << ",\"height\":" << height
+            << ",\"target_fps\":" << settings.video_frame_rate
+            << ",\"sent_fps\":" << sent_frames / seconds
+            << ",\"received_fps\":" << pair.answerer.received_frames / seconds
+            << "}" << std::endl;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    BenchmarkSettings settings;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--quick") == 0)
+        {
+            settings.connection_count = 3;
+            settings.data_bytes_per_size = 4 * 1024 * 1024;
+            settings.video_duration = std::chrono::milliseconds(1000);
+        }
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " [--quick]" << std::endl;
+            return 1;
+        }
+    }
+
+    try
+    {
+        // The codecs can only be configured while there are no peer connections.
+        for (const bool use_software_codecs : { false, true })
+        {
+            if (!ConfigureCodecs(use_software_codecs))
+            {
+                std::cerr << "Failed to configure the " << CodecName(use_software_codecs) << " codecs" << std::endl;
+                return 1;
+            }
+
+            std::cerr << "Benchmarking with " << CodecName(use_software_codecs) << " codecs" << std::endl;
+
+            if (!use_software_codecs)
+            {
+                BenchmarkConnectionSetup(settings);
+
+                for (const int message_size : { 16, 256, 1024, 16 * 1024, 64 * 1024 })
+                {
+                    BenchmarkDataChannel(settings, message_size);
+                }
+            }
+
+            BenchmarkVideo(settings, use_software_codecs);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
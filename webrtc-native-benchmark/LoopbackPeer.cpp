@@ -0,0 +1,358 @@
+#include "LoopbackPeer.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+
+namespace
+{
+    // Values of webrtc::PeerConnectionInterface::PeerConnectionState.
+    const int kConnectionStateConnected = 2;
+    const int kConnectionStateFailed = 4;
+
+    const int kMinVideoBitrate = 500 * 1000;
+    const int kMaxVideoBitrate = 20 * 1000 * 1000;
+    const int kMaxVideoFrameRate = 60;
+
+    // Data channel sends beyond this buffered amount are queued by webrtc-native,
+    // libwebrtc closes the channel when more than 16 MB is buffered.
+    const int64_t kDataChannelHighWaterMark = 1024 * 1024;
+}
+
+int64_t NowUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(BenchmarkClock::now().time_since_epoch()).count();
+}
+
+void LatencySamples::Add(int64_t latency_us)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    samples_.push_back(latency_us);
+}
+
+int64_t LatencySamples::Percentile(double percentile) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (samples_.empty())
+        return 0;
+
+    const auto rank = std::min(samples_.size() - 1, static_cast<size_t>(percentile / 100 * samples_.size()));
+    std::nth_element(samples_.begin(), samples_.begin() + rank, samples_.end());
+    return samples_[rank];
+}
+
+size_t LatencySamples::size() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return samples_.size();
+}
+
+void LatencySamples::Clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    samples_.clear();
+}
+
+void LatencySamples::Append(const LatencySamples& other)
+{
+    std::vector<int64_t> samples;
+
+    {
+        std::lock_guard<std::mutex> lock(other.mutex_);
+        samples = other.samples_;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    samples_.insert(samples_.end(), samples.begin(), samples.end());
+}
+
+struct PeerSlots
+{
+    static std::array<std::atomic<LoopbackPeer*>, LoopbackPeer::kMaxPeerCount> peers;
+
+    static int Acquire(LoopbackPeer* peer)
+    {
+        for (int i = 0; i < LoopbackPeer::kMaxPeerCount; ++i)
+        {
+            LoopbackPeer* expected = nullptr;
+            if (peers[i].compare_exchange_strong(expected, peer))
+                return i;
+        }
+
+        return -1;
+    }
+
+    static void Release(int slot)
+    {
+        peers[slot] = nullptr;
+    }
+};
+
+std::array<std::atomic<LoopbackPeer*>, LoopbackPeer::kMaxPeerCount> PeerSlots::peers{};
+
+// The callbacks of the peer in slot Index.
+template <int Index>
+struct PeerCallbacks
+{
+    static LoopbackPeer* Peer()
+    {
+        return PeerSlots::peers[Index].load();
+    }
+
+    static void OnLocalSdpReadyToSend(const char* type, const char* sdp)
+    {
+        if (const auto peer = Peer())
+            peer->OnLocalSdpReadyToSend(type, sdp);
+    }
+
+    static void OnIceCandidateReadyToSend(const char* candidate, const int sdp_mline_index, const char* sdp_mid)
+    {
+        if (const auto peer = Peer())
+            peer->OnIceCandidateReadyToSend(candidate, sdp_mline_index, sdp_mid);
+    }
+
+    static void OnConnectionStateChanged(int state)
+    {
+        if (const auto peer = Peer())
+            peer->OnConnectionStateChanged(state);
+    }
+
+    static void OnLocalDataChannelReady(int channel_id, const char*)
+    {
+        if (const auto peer = Peer())
+            peer->OnLocalDataChannelReady(channel_id);
+    }
+
+    static void OnData(int, const uint8_t* data, int length, bool)
+    {
+        if (const auto peer = Peer())
+            peer->OnData(data, length);
+    }
+
+    static void OnRemoteVideoFrame(int, const void*,
+        const uint8_t*, const uint8_t*, const uint8_t*, const uint8_t*,
+        int, int, int, int, uint32_t, uint32_t, uint64_t, VideoFrameFormat)
+    {
+        if (const auto peer = Peer())
+            peer->OnRemoteVideoFrame();
+    }
+
+    static void OnFailure(const char* message)
+    {
+        if (const auto peer = Peer())
+            peer->OnFailure(message);
+    }
+};
+
+namespace
+{
+    struct CallbackSet
+    {
+        LocalSdpReadyToSendCallback local_sdp_ready_to_send;
+        IceCandidateReadyToSendCallback ice_candidate_ready_to_send;
+        StateChangedCallback connection_state_changed;
+        LocalDataChannelReadyCallback local_data_channel_ready;
+        DataAvailableCallback data_available;
+        IncomingVideoFrameCallback remote_video_frame_received;
+        FailureCallback failure;
+    };
+
+    template <size_t... Indices>
+    std::array<CallbackSet, sizeof...(Indices)> CreateCallbackSets(std::index_sequence<Indices...>)
+    {
+        return { {
+            {
+                &PeerCallbacks<Indices>::OnLocalSdpReadyToSend,
+                &PeerCallbacks<Indices>::OnIceCandidateReadyToSend,
+                &PeerCallbacks<Indices>::OnConnectionStateChanged,
+                &PeerCallbacks<Indices>::OnLocalDataChannelReady,
+                &PeerCallbacks<Indices>::OnData,
+                &PeerCallbacks<Indices>::OnRemoteVideoFrame,
+                &PeerCallbacks<Indices>::OnFailure
+            }...
+        } };
+    }
+
+    const auto kCallbackSets = CreateCallbackSets(std::make_index_sequence<LoopbackPeer::kMaxPeerCount>());
+}
+
+LoopbackPeer::LoopbackPeer(bool can_receive_video)
+{
+    slot_ = PeerSlots::Acquire(this);
+    if (slot_ < 0)
+        throw std::runtime_error("Too many loopback peers");
+
+    // Without ICE servers only host candidates are gathered, including the loopback ones.
+    connection_ = CreatePeerConnection(nullptr, 0, nullptr, nullptr, false, can_receive_video, true);
+    if (!connection_)
+    {
+        PeerSlots::Release(slot_);
+        throw std::runtime_error("Failed to create peer connection");
+    }
+
+    const auto& callbacks = kCallbackSets[slot_];
+    RegisterOnLocalSdpReadyToSend(connection_, callbacks.local_sdp_ready_to_send);
+    RegisterOnIceCandidateReadyToSend(connection_, callbacks.ice_candidate_ready_to_send);
+    RegisterConnectionStateChanged(connection_, callbacks.connection_state_changed);
+    RegisterOnLocalDataChannelReady(connection_, callbacks.local_data_channel_ready);
+    RegisterOnDataFromDataChannelReady(connection_, callbacks.data_available);
+    RegisterRemoteVideoFrameReceived(connection_, callbacks.remote_video_frame_received);
+    RegisterOnFailure(connection_, callbacks.failure);
+}
+
+LoopbackPeer::~LoopbackPeer()
+{
+    ClosePeerConnection(connection_);
+    PeerSlots::Release(slot_);
+}
+
+bool LoopbackPeer::WaitUntilConnected(std::chrono::milliseconds timeout, bool needs_data_channel)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    return changed_.wait_for(lock, timeout, [&]
+    {
+        return has_failed_ || (connection_state_ == kConnectionStateConnected && (!needs_data_channel || data_channel_id_ >= 0));
+    }) && !has_failed_;
+}
+
+void LoopbackPeer::OnLocalSdpReadyToSend(const char* type, const char* sdp)
+{
+    remote_->SetRemoteDescription(type, sdp);
+}
+
+void LoopbackPeer::OnIceCandidateReadyToSend(const char* candidate, int sdp_mline_index, const char* sdp_mid)
+{
+    remote_->AddRemoteIceCandidate(candidate, sdp_mline_index, sdp_mid);
+}
+
+void LoopbackPeer::SetRemoteDescription(const char* type, const char* sdp)
+{
+    ::SetRemoteDescription(connection_, type, sdp);
+
+    if (strcmp(type, "offer") == 0)
+    {
+        CreateAnswer(connection_);
+    }
+
+    std::vector<PendingCandidate> candidates;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        has_remote_description_ = true;
+        candidates.swap(pending_candidates_);
+    }
+
+    for (const auto& pending : candidates)
+    {
+        AddIceCandidate(connection_, pending.candidate.c_str(), pending.sdp_mline_index, pending.sdp_mid.c_str());
+    }
+}
+
+void LoopbackPeer::AddRemoteIceCandidate(const char* candidate, int sdp_mline_index, const char* sdp_mid)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        // Candidates can only be added after the remote description.
+        if (!has_remote_description_)
+        {
+            pending_candidates_.push_back(PendingCandidate{ candidate, sdp_mline_index, sdp_mid });
+            return;
+        }
+    }
+
+    AddIceCandidate(connection_, candidate, sdp_mline_index, sdp_mid);
+}
+
+void LoopbackPeer::OnConnectionStateChanged(int state)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        connection_state_ = state;
+        has_failed_ |= state == kConnectionStateFailed;
+    }
+
+    changed_.notify_all();
+}
+
+void LoopbackPeer::OnLocalDataChannelReady(int channel_id)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        data_channel_id_ = channel_id;
+    }
+
+    ConfigureDataChannelBuffering(connection_, channel_id, -1, kDataChannelHighWaterMark);
+    changed_.notify_all();
+}
+
+void LoopbackPeer::OnData(const uint8_t* data, int length)
+{
+    if (length >= static_cast<int>(sizeof(int64_t)))
+    {
+        int64_t sent_us;
+        memcpy(&sent_us, data, sizeof(sent_us));
+        message_latency.Add(NowUs() - sent_us);
+    }
+
+    received_bytes += length;
+    ++received_messages;
+}
+
+void LoopbackPeer::OnRemoteVideoFrame()
+{
+    ++received_frames;
+}
+
+void LoopbackPeer::OnFailure(const char* message)
+{
+    std::cerr << "Peer #" << slot_ << " failed: " << message << std::endl;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        has_failed_ = true;
+    }
+
+    changed_.notify_all();
+}
+
+LoopbackPair::LoopbackPair(bool with_video)
+    : offerer(false)
+    , answerer(with_video)
+    , with_video(with_video)
+{
+    offerer.set_remote(&answerer);
+    answerer.set_remote(&offerer);
+
+    if (with_video)
+    {
+        video_track_id = AddVideoTrack(offerer.connection(), "video", kMinVideoBitrate, kMaxVideoBitrate, kMaxVideoFrameRate);
+    }
+
+    // The data channel must exist before the offer, to negotiate SCTP.
+    AddDataChannel(offerer.connection(), "data", true, true);
+}
+
+std::chrono::microseconds LoopbackPair::Connect(std::chrono::milliseconds timeout)
+{
+    const auto start = BenchmarkClock::now();
+
+    if (!CreateOffer(offerer.connection()))
+        return std::chrono::microseconds(-1);
+
+    const auto deadline = start + timeout;
+
+    const auto remaining = [&]
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(deadline - BenchmarkClock::now());
+    };
+
+    if (!offerer.WaitUntilConnected(remaining(), true) || !answerer.WaitUntilConnected(remaining(), false))
+        return std::chrono::microseconds(-1);
+
+    return std::chrono::duration_cast<std::chrono::microseconds>(BenchmarkClock::now() - start);
+}
@@ -0,0 +1,119 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "NativeExports.h"
+
+using BenchmarkClock = std::chrono::steady_clock;
+
+// Values of rtc::LoggingSeverity.
+const int kLogSeverityWarning = 3;
+const int kLogSeverityError = 4;
+
+// Microseconds on the benchmark clock, written in front of the messages to measure their latency.
+int64_t NowUs();
+
+// Collects latencies in microseconds from any thread.
+class LatencySamples final
+{
+public:
+    void Add(int64_t latency_us);
+
+    // Returns the percentile of the samples, 0 when there are none.
+    int64_t Percentile(double percentile) const;
+
+    size_t size() const;
+    void Clear();
+
+    // Adds the samples of other.
+    void Append(const LatencySamples& other);
+
+private:
+    mutable std::mutex mutex_;
+    mutable std::vector<int64_t> samples_;
+};
+
+// One side of a peer connection within this process, whose signaling is passed directly to its remote peer.
+// The exports take callbacks without a context, so every peer occupies a slot with callbacks bound to it.
+class LoopbackPeer final
+{
+public:
+    static const int kMaxPeerCount = 1024;
+
+    // Throws when all slots are in use or the peer connection cannot be created.
+    explicit LoopbackPeer(bool can_receive_video);
+    ~LoopbackPeer();
+
+    LoopbackPeer(const LoopbackPeer&) = delete;
+    LoopbackPeer& operator=(const LoopbackPeer&) = delete;
+
+    PeerConnection* connection() const { return connection_; }
+
+    void set_remote(LoopbackPeer* remote) { remote_ = remote; }
+
+    // The data channel opened on this side, -1 until it is open.
+    int data_channel_id() const { return data_channel_id_; }
+
+    // Waits until the connection, and optionally the data channel it created, are open, or failed.
+    // Data channels opened by the remote peer are only reported when they open later.
+    bool WaitUntilConnected(std::chrono::milliseconds timeout, bool needs_data_channel);
+
+    std::atomic<int64_t> received_messages{ 0 };
+    std::atomic<int64_t> received_bytes{ 0 };
+    std::atomic<int64_t> received_frames{ 0 };
+
+    // The time from sending until the data callback, of messages that start with a NowUs timestamp.
+    LatencySamples message_latency;
+
+private:
+    void OnLocalSdpReadyToSend(const char* type, const char* sdp);
+    void OnIceCandidateReadyToSend(const char* candidate, int sdp_mline_index, const char* sdp_mid);
+    void OnConnectionStateChanged(int state);
+    void OnLocalDataChannelReady(int channel_id);
+    void OnData(const uint8_t* data, int length);
+    void OnRemoteVideoFrame();
+    void OnFailure(const char* message);
+
+    void SetRemoteDescription(const char* type, const char* sdp);
+    void AddRemoteIceCandidate(const char* candidate, int sdp_mline_index, const char* sdp_mid);
+
+    template <int Index> friend struct PeerCallbacks;
+    friend struct PeerSlots;
+
+    struct PendingCandidate
+    {
+        std::string candidate;
+        int sdp_mline_index;
+        std::string sdp_mid;
+    };
+
+    int slot_ = -1;
+    PeerConnection* connection_ = nullptr;
+    LoopbackPeer* remote_ = nullptr;
+
+    mutable std::mutex mutex_;
+    std::condition_variable changed_;
+    int connection_state_ = 0;
+    int data_channel_id_ = -1;
+    bool has_failed_ = false;
+    bool has_remote_description_ = false;
+    std::vector<PendingCandidate> pending_candidates_;
+};
+
+// Two connected peers. The offerer creates the data channel and, optionally, a video track the answerer receives.
+struct LoopbackPair
+{
+    explicit LoopbackPair(bool with_video);
+
+    // Negotiates the connection, and returns the time until both sides and the data channel are open,
+    // or a negative duration when it timed out.
+    std::chrono::microseconds Connect(std::chrono::milliseconds timeout);
+
+    LoopbackPeer offerer;
+    LoopbackPeer answerer;
+    int video_track_id = -1;
+    bool with_video;
+};
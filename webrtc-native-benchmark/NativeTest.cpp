@@ -0,0 +1,86 @@
+#include "NativeTest.h"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <vector>
+
+namespace
+{
+    struct NativeTestEntry
+    {
+        const char* name;
+        NativeTestFunction function;
+    };
+
+    // Filled by the static registrations of the test files, before main runs.
+    std::vector<NativeTestEntry>& Tests()
+    {
+        static std::vector<NativeTestEntry> tests;
+        return tests;
+    }
+
+    std::atomic<int64_t> g_allocation_count{ 0 };
+}
+
+// The other forms of new and delete use these.
+void* operator new(size_t size)
+{
+    g_allocation_count.fetch_add(1, std::memory_order_relaxed);
+
+    if (const auto memory = std::malloc(size > 0 ? size : 1))
+        return memory;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+int64_t GetNativeTestAllocationCount()
+{
+    return g_allocation_count.load(std::memory_order_relaxed);
+}
+
+NativeTestRegistration::NativeTestRegistration(const char* name, NativeTestFunction function)
+{
+    Tests().push_back({ name, function });
+}
+
+int main(int argc, char* argv[])
+{
+    const char* filter = argc > 1 ? argv[1] : nullptr;
+
+    int run_count = 0;
+    int failure_count = 0;
+
+    for (const auto& test : Tests())
+    {
+        if (filter && !strstr(test.name, filter))
+            continue;
+
+        ++run_count;
+
+        try
+        {
+            test.function();
+            std::cout << "[  PASSED  ] " << test.name << std::endl;
+        }
+        catch (const std::exception& e)
+        {
+            ++failure_count;
+            std::cout << "[  FAILED  ] " << test.name << ": " << e.what() << std::endl;
+        }
+    }
+
+    std::cout << run_count - failure_count << " of " << run_count << " tests passed" << std::endl;
+    return failure_count == 0 && run_count > 0 ? 0 : 1;
+}
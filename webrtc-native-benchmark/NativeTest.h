@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+// A minimal test runner for the internal classes of webrtc-native, libwebrtc is built without its gtest targets.
+// A test fails when one of its expectations throws.
+//
+// Usage: webrtc-native-tests [name filter]
+
+using NativeTestFunction = void(*)();
+
+struct NativeTestRegistration
+{
+    NativeTestRegistration(const char* name, NativeTestFunction function);
+};
+
+// The number of times operator new was called by any thread, to check code does not allocate.
+int64_t GetNativeTestAllocationCount();
+
+class NativeTestFailure final : public std::runtime_error
+{
+public:
+    using std::runtime_error::runtime_error;
+};
+
+#define NATIVE_TEST(name) \
+    static void name(); \
+    static const NativeTestRegistration name##_registration(#name, &name); \
+    static void name()
+
+#define EXPECT_TRUE(condition) \
+    do { \
+        if (!(condition)) \
+            throw NativeTestFailure(std::string(__FILE__ ":") + std::to_string(__LINE__) + ": expected " #condition); \
+    } while (false)
+
+#define EXPECT_EQ(expected, actual) \
+    do { \
+        const auto& expected_value = (expected); \
+        const auto& actual_value = (actual); \
+        if (!(expected_value == actual_value)) \
+        { \
+            std::ostringstream message; \
+            message << __FILE__ ":" << __LINE__ << ": expected " #actual " to be " << expected_value << ", got " << actual_value; \
+            throw NativeTestFailure(message.str()); \
+        } \
+    } while (false)
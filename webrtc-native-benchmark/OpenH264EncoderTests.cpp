@@ -0,0 +1,117 @@
+#include "pch.h"
+#include "OpenH264Encoder.h"
+#include "NativeTest.h"
+
+#ifdef WEBRTC_USE_H264
+
+using namespace webrtc;
+
+namespace
+{
+    class ImageCounter final : public EncodedImageCallback
+    {
+    public:
+        Result OnEncodedImage(const EncodedImage& encoded_image, const CodecSpecificInfo* codec_specific_info, const RTPFragmentationHeader* fragmentation) override
+        {
+            ++image_count;
+
+            // The level_idc follows the NAL unit header, profile_idc and constraint flags of the SPS.
+            const auto data = encoded_image._buffer;
+            for (size_t i = 0; i + 6 < encoded_image._length; ++i)
+            {
+                if (data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 1 && (data[i + 3] & 0x1F) == H264::kSps)
+                {
+                    sps_level = data[i + 6];
+                }
+            }
+
+            return Result(Result::OK);
+        }
+
+        int image_count = 0;
+        int sps_level = -1;
+    };
+
+    VideoCodec CreateCodec(int width, int height)
+    {
+        VideoCodec codec;
+        codec.codecType = kVideoCodecH264;
+        codec.width = width;
+        codec.height = height;
+        codec.startBitrate = 500;
+        codec.maxBitrate = 1000;
+        codec.maxFramerate = 30;
+        codec.mode = VideoCodecMode::kRealtimeVideo;
+        return codec;
+    }
+}
+
+NATIVE_TEST(OpenH264EncoderSignalsOfferedLevel)
+{
+    const auto codec = CreateCodec(1920, 1080);
+
+    OpenH264Encoder encoder(1, H264PacketizationMode::NonInterleaved);
+    ImageCounter images;
+    EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK, encoder.InitEncode(&codec, 1, 1200));
+    EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK, encoder.RegisterEncodeCompleteCallback(&images));
+
+    const auto buffer = I420Buffer::Create(codec.width, codec.height);
+    I420Buffer::SetBlack(buffer.get());
+
+    const auto frame = VideoFrame::Builder()
+        .set_video_frame_buffer(buffer)
+        .set_rotation(kVideoRotation_0)
+        .set_timestamp_us(0)
+        .build();
+
+    EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK, encoder.Encode(frame, nullptr, nullptr));
+
+    // The level of the formats of the encoder factory, 5.0.
+    EXPECT_EQ(static_cast<int>(H264::kLevel5), images.sps_level);
+}
+
+NATIVE_TEST(OpenH264EncoderDoesNotAllocateForDeltaFrames)
+{
+    const auto codec = CreateCodec(320, 180);
+
+    // One thread, so OpenH264 does not schedule slice tasks.
+    OpenH264Encoder encoder(1, H264PacketizationMode::NonInterleaved);
+    ImageCounter images;
+    EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK, encoder.InitEncode(&codec, 1, 1200));
+    EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK, encoder.RegisterEncodeCompleteCallback(&images));
+
+    const auto buffer = I420Buffer::Create(codec.width, codec.height);
+    I420Buffer::SetBlack(buffer.get());
+
+    // Created upfront, with increasing timestamps for the rate control.
+    std::vector<VideoFrame> frames;
+    for (int i = 0; i < 100; ++i)
+    {
+        frames.push_back(VideoFrame::Builder()
+            .set_video_frame_buffer(buffer)
+            .set_rotation(kVideoRotation_0)
+            .set_timestamp_us(i * int64_t{ 1000000 } / codec.maxFramerate)
+            .build());
+
+        frames.back().set_ntp_time_ms(i * int64_t{ 1000 } / codec.maxFramerate);
+    }
+
+    // The first images grow the output buffer and fragmentation header.
+    for (int i = 0; i < 10; ++i)
+    {
+        EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK, encoder.Encode(frames[i], nullptr, nullptr));
+    }
+
+    const auto image_count = images.image_count;
+    const auto allocation_count = GetNativeTestAllocationCount();
+
+    for (size_t i = 10; i < frames.size(); ++i)
+    {
+        EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK, encoder.Encode(frames[i], nullptr, nullptr));
+    }
+
+    EXPECT_EQ(allocation_count, GetNativeTestAllocationCount());
+    EXPECT_TRUE(images.image_count > image_count);
+}
+
+#endif
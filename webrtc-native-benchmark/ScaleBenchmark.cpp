@@ -0,0 +1,299 @@
+// Ramps up the number of loopback peer connection pairs in this process, each sending fake encoded video
+// and data channel messages, and reports the resource usage per connection at every step, to find where it stops scaling.
+// Like webrtc-dotnet-leak-test, the ramp can be repeated to check the memory is released when all connections are closed.
+// Writes one JSON object per line with the results to stdout, and progress to stderr.
+//
+// With --factories the connections are spread over that many factories, each with its own threads.
+//
+// Usage: webrtc-native-scale-benchmark [--max-pairs N] [--window-ms MS] [--cycles N] [--factories N] [--least-loaded]
+
+#include "LoopbackPeer.h"
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+#ifdef __linux__
+#   include <sys/resource.h>
+#   include <unistd.h>
+#endif
+
+namespace
+{
+    const auto kConnectTimeout = std::chrono::seconds(10);
+    const auto kShutdownTimeout = std::chrono::seconds(10);
+
+    // Stop ramping up when this many connections in a row fail, e.g. when running out of ports or threads.
+    const int kMaxConsecutiveFailures = 3;
+
+    const int kVideoWidth = 320;
+    const int kVideoHeight = 180;
+    const int kTickRate = 30;
+    const int kMessageSize = 256;
+
+    struct ScaleSettings
+    {
+        int max_pair_count = 128;
+        std::chrono::milliseconds window{ 3000 };
+        int cycle_count = 1;
+        int factory_count = 1;
+        FactoryAssignment factory_assignment = FactoryAssignment::RoundRobin;
+    };
+
+    struct ProcessUsage
+    {
+        double cpu_seconds = -1;
+        int64_t rss_bytes = -1;
+        int thread_count = -1;
+    };
+
+    ProcessUsage GetProcessUsage()
+    {
+        ProcessUsage usage;
+
+#ifdef __linux__
+        rusage resources{};
+        if (getrusage(RUSAGE_SELF, &resources) == 0)
+        {
+            usage.cpu_seconds =
+                resources.ru_utime.tv_sec + resources.ru_utime.tv_usec / 1e6 +
+                resources.ru_stime.tv_sec + resources.ru_stime.tv_usec / 1e6;
+        }
+
+        std::ifstream statm("/proc/self/statm");
+        int64_t size_pages, resident_pages;
+        if (statm >> size_pages >> resident_pages)
+        {
+            usage.rss_bytes = resident_pages * sysconf(_SC_PAGESIZE);
+        }
+
+        std::ifstream status("/proc/self/status");
+        std::string line;
+        while (std::getline(status, line))
+        {
+            if (line.compare(0, 8, "Threads:") == 0)
+            {
+                usage.thread_count = atoi(line.c_str() + 8);
+                break;
+            }
+        }
+#endif
+
+        return usage;
+    }
+
+    // Sends a video frame and a timestamped message on every pair, kTickRate times per second.
+    void DriveTraffic(std::vector<std::unique_ptr<LoopbackPair>>& pairs, std::chrono::milliseconds duration)
+    {
+        std::vector<uint8_t> pixels(kVideoWidth * kVideoHeight * 4);
+        std::vector<uint8_t> message(kMessageSize);
+
+        const auto tick_interval = std::chrono::microseconds(1000000 / kTickRate);
+        const auto end = BenchmarkClock::now() + duration;
+        int64_t tick = 0;
+
+        for (auto next = BenchmarkClock::now(); next < end; next += tick_interval, ++tick)
+        {
+            std::this_thread::sleep_until(next);
+
+            pixels[(tick * 4) % pixels.size()] ^= 0xFF;
+
+            for (auto& pair : pairs)
+            {
+                SendVideoFrame(pair->offerer.connection(), pair->video_track_id, pixels.data(), kVideoWidth * 4, kVideoWidth, kVideoHeight, VideoFrameFormat::RGBA32);
+
+                const auto now_us = NowUs();
+                memcpy(message.data(), &now_us, sizeof(now_us));
+                SendDataById(pair->offerer.connection(), pair->offerer.data_channel_id(), message.data(), kMessageSize, true);
+            }
+        }
+    }
+
+    const char* AssignmentName(FactoryAssignment assignment)
+    {
+        return assignment == FactoryAssignment::LeastLoaded ? "least_loaded" : "round_robin";
+    }
+
+    void RunCycle(const ScaleSettings& settings, int cycle)
+    {
+        const auto baseline = GetProcessUsage();
+
+        std::vector<std::unique_ptr<LoopbackPair>> pairs;
+        int failures = 0;
+        bool is_aborted = false;
+        int64_t peak_rss_bytes = baseline.rss_bytes;
+
+        for (int target = 1; ; target = std::min(target * 2, settings.max_pair_count))
+        {
+            int consecutive_failures = 0;
+
+            while (static_cast<int>(pairs.size()) < target)
+            {
+                auto pair = std::make_unique<LoopbackPair>(true);
+
+                if (pair->Connect(kConnectTimeout).count() < 0)
+                {
+                    ++failures;
+
+                    if (++consecutive_failures == kMaxConsecutiveFailures)
+                    {
+                        is_aborted = true;
+                        break;
+                    }
+
+                    continue;
+                }
+
+                consecutive_failures = 0;
+                pairs.push_back(std::move(pair));
+            }
+
+            if (pairs.empty())
+            {
+                std::cout << "{\"benchmark\":\"scale\""
+                    << ",\"cycle\":" << cycle
+                    << ",\"pairs\":0"
+                    << ",\"connect_failures\":" << failures
+                    << ",\"aborted\":true"
+                    << "}" << std::endl;
+                break;
+            }
+
+            std::cerr << "Measuring " << pairs.size() << " pairs" << std::endl;
+
+            for (auto& pair : pairs)
+            {
+                pair->answerer.message_latency.Clear();
+                pair->answerer.received_frames = 0;
+            }
+
+            const auto before = GetProcessUsage();
+            DriveTraffic(pairs, settings.window);
+            const auto after = GetProcessUsage();
+
+            LatencySamples callback_latency;
+            int64_t received_frames = 0;
+
+            for (auto& pair : pairs)
+            {
+                callback_latency.Append(pair->answerer.message_latency);
+                received_frames += pair->answerer.received_frames;
+            }
+
+            const auto connection_count = 2 * static_cast<int64_t>(pairs.size());
+            const auto seconds = std::chrono::duration<double>(settings.window).count();
+            const auto cpu_cores = (after.cpu_seconds - before.cpu_seconds) / seconds;
+
+            peak_rss_bytes = std::max(peak_rss_bytes, after.rss_bytes);
+
+            std::cout << "{\"benchmark\":\"scale\""
+                << ",\"cycle\":" << cycle
+                << ",\"factories\":" << settings.factory_count
+                << ",\"assignment\":\"" << AssignmentName(settings.factory_assignment) << "\""
+                << ",\"pairs\":" << pairs.size()
+                << ",\"connections\":" << connection_count
+                << ",\"connect_failures\":" << failures
+                << ",\"aborted\":" << (is_aborted ? "true" : "false")
+                << ",\"cpu_cores\":" << cpu_cores
+                << ",\"cpu_percent_per_connection\":" << 100 * cpu_cores / connection_count
+                << ",\"rss_mb\":" << after.rss_bytes / (1024.0 * 1024)
+                << ",\"rss_kb_per_connection\":" << (after.rss_bytes - baseline.rss_bytes) / 1024.0 / connection_count
+                << ",\"threads\":" << after.thread_count
+                << ",\"callback_p50_us\":" << callback_latency.Percentile(50)
+                << ",\"callback_p99_us\":" << callback_latency.Percentile(99)
+                << ",\"received_fps_per_pair\":" << received_frames / seconds / pairs.size()
+                << "}" << std::endl;
+
+            // Measure the pairs that did connect once, then stop instead of retrying forever.
+            if (is_aborted || target == settings.max_pair_count)
+                break;
+        }
+
+        const auto connection_count = 2 * static_cast<int64_t>(pairs.size());
+
+        // The factory and its threads are released with the last connection.
+        pairs.clear();
+
+        const auto deadline = BenchmarkClock::now() + kShutdownTimeout;
+        while (HasFactory() && BenchmarkClock::now() < deadline)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        const auto released = GetProcessUsage();
+
+        // Memory that is not released after closing every connection grows with every cycle when it leaks.
+        std::cout << "{\"benchmark\":\"memory\""
+            << ",\"cycle\":" << cycle
+            << ",\"connections\":" << connection_count
+            << ",\"baseline_rss_mb\":" << baseline.rss_bytes / (1024.0 * 1024)
+            << ",\"peak_rss_mb\":" << peak_rss_bytes / (1024.0 * 1024)
+            << ",\"rss_kb_per_connection\":" << (peak_rss_bytes - baseline.rss_bytes) / 1024.0 / std::max<int64_t>(1, connection_count)
+            << ",\"released_rss_mb\":" << released.rss_bytes / (1024.0 * 1024)
+            << ",\"retained_rss_kb\":" << (released.rss_bytes - baseline.rss_bytes) / 1024.0
+            << ",\"released_threads\":" << released.thread_count
+            << "}" << std::endl;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    ScaleSettings settings;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const auto has_value = i + 1 < argc;
+
+        if (has_value && strcmp(argv[i], "--max-pairs") == 0)
+        {
+            settings.max_pair_count = std::max(1, std::min(atoi(argv[++i]), LoopbackPeer::kMaxPeerCount / 2));
+        }
+        else if (has_value && strcmp(argv[i], "--window-ms") == 0)
+        {
+            settings.window = std::chrono::milliseconds(std::max(100, atoi(argv[++i])));
+        }
+        else if (has_value && strcmp(argv[i], "--cycles") == 0)
+        {
+            settings.cycle_count = std::max(1, atoi(argv[++i]));
+        }
+        else if (has_value && strcmp(argv[i], "--factories") == 0)
+        {
+            settings.factory_count = std::max(1, atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--least-loaded") == 0)
+        {
+            settings.factory_assignment = FactoryAssignment::LeastLoaded;
+        }
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " [--max-pairs N] [--window-ms MS] [--cycles N] [--factories N] [--least-loaded]" << std::endl;
+            return 1;
+        }
+    }
+
+    if (!Configure(true, true, true, true, true, true, 1, 0, true,
+        true, settings.factory_count, settings.factory_assignment,
+        true, true, nullptr, kLogSeverityError))
+    {
+        std::cerr << "Failed to configure" << std::endl;
+        return 1;
+    }
+
+    try
+    {
+        for (int cycle = 0; cycle < settings.cycle_count; ++cycle)
+        {
+            RunCycle(settings, cycle);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,83 @@
+#include "pch.h"
+#include "VideoBufferPool.h"
+#include "NativeTest.h"
+
+using webrtc::VideoBufferPool;
+
+NATIVE_TEST(VideoBufferPoolRecyclesReleasedBuffers)
+{
+    VideoBufferPool pool;
+
+    auto first = pool.CreateBuffer(320, 180);
+    const auto first_pointer = first.get();
+    EXPECT_EQ(int64_t{ 0 }, pool.hit_count());
+    EXPECT_EQ(int64_t{ 1 }, pool.miss_count());
+
+    // Still in use, so another buffer is pooled.
+    auto second = pool.CreateBuffer(320, 180);
+    EXPECT_TRUE(second.get() != first_pointer);
+    EXPECT_EQ(int64_t{ 2 }, pool.miss_count());
+    EXPECT_EQ(int64_t{ 2 }, pool.high_water_mark());
+
+    first = nullptr;
+    const auto third = pool.CreateBuffer(320, 180);
+    EXPECT_TRUE(third.get() == first_pointer);
+    EXPECT_EQ(int64_t{ 1 }, pool.hit_count());
+    EXPECT_EQ(int64_t{ 2 }, pool.miss_count());
+    EXPECT_EQ(int64_t{ 2 }, pool.high_water_mark());
+}
+
+NATIVE_TEST(VideoBufferPoolMissesWhenResolutionChanges)
+{
+    VideoBufferPool pool;
+
+    pool.CreateBuffer(320, 180);
+    pool.CreateBuffer(320, 180);
+    EXPECT_EQ(int64_t{ 1 }, pool.hit_count());
+
+    // The buffers of the old resolution are dropped, so the pool does not grow.
+    auto large = pool.CreateBuffer(640, 360);
+    EXPECT_EQ(640, large->width());
+    EXPECT_EQ(int64_t{ 2 }, pool.miss_count());
+    EXPECT_EQ(int64_t{ 1 }, pool.high_water_mark());
+
+    // A buffer still in use when the resolution changes is not pooled again.
+    auto small = pool.CreateBuffer(320, 180);
+    large = nullptr;
+    small = nullptr;
+
+    EXPECT_EQ(360, pool.CreateBuffer(640, 360)->height());
+    EXPECT_EQ(int64_t{ 1 }, pool.hit_count());
+    EXPECT_EQ(int64_t{ 4 }, pool.miss_count());
+
+    EXPECT_EQ(180, pool.CreateBuffer(320, 180)->height());
+    EXPECT_EQ(int64_t{ 1 }, pool.hit_count());
+    EXPECT_EQ(int64_t{ 5 }, pool.miss_count());
+    EXPECT_EQ(int64_t{ 1 }, pool.high_water_mark());
+}
+
+NATIVE_TEST(VideoBufferPoolStopsGrowingWhenExhausted)
+{
+    VideoBufferPool pool(2);
+    std::vector<rtc::scoped_refptr<webrtc::I420Buffer>> buffers;
+
+    for (int i = 0; i < 4; ++i)
+    {
+        buffers.push_back(pool.CreateBuffer(320, 180));
+    }
+
+    EXPECT_EQ(int64_t{ 4 }, pool.miss_count());
+    EXPECT_EQ(int64_t{ 2 }, pool.high_water_mark());
+
+    // Only the pooled buffers are recycled.
+    const auto pooled = buffers[0].get();
+    buffers.clear();
+
+    EXPECT_TRUE(pool.CreateBuffer(320, 180).get() == pooled);
+    EXPECT_EQ(int64_t{ 1 }, pool.hit_count());
+
+    pool.Release();
+    pool.CreateBuffer(320, 180);
+    EXPECT_EQ(int64_t{ 5 }, pool.miss_count());
+    EXPECT_EQ(int64_t{ 2 }, pool.high_water_mark());
+}
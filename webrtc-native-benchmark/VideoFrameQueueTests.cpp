@@ -0,0 +1,223 @@
+#include "pch.h"
+#include "VideoFrameQueue.h"
+#include "NativeTest.h"
+
+namespace
+{
+    uint8_t g_frames[4];
+
+    VideoFrameRequest CreateRequest(int index)
+    {
+        VideoFrameRequest request{};
+        request.pixels = &g_frames[index];
+        request.width = 1;
+        request.height = 1;
+        request.format = VideoFrameFormat::RGBA32;
+        return request;
+    }
+
+    int GetIndex(const VideoFrameRequest& request)
+    {
+        return static_cast<int>(request.pixels - g_frames);
+    }
+
+    // Holds the worker in the first frame until released, so the frames pushed meanwhile stay queued.
+    struct BlockingFrameHandlers
+    {
+        rtc::Event first_frame_started{ false, false };
+        rtc::Event release_first_frame{ false, false };
+        std::atomic<int> handled_count{ 0 };
+
+        // Only read after the queue is destroyed.
+        std::vector<int> processed;
+        std::vector<int> dropped;
+
+        std::unique_ptr<VideoFrameQueue> CreateQueue(size_t depth, VideoFrameDropPolicy drop_policy)
+        {
+            return std::make_unique<VideoFrameQueue>(depth, drop_policy,
+                [this](const VideoFrameRequest& request)
+                {
+                    processed.push_back(GetIndex(request));
+
+                    if (processed.size() == 1)
+                    {
+                        first_frame_started.Set();
+                        release_first_frame.Wait(rtc::Event::kForever);
+                    }
+
+                    ++handled_count;
+                },
+                [this](const VideoFrameRequest& request)
+                {
+                    dropped.push_back(GetIndex(request));
+                    ++handled_count;
+                });
+        }
+    };
+
+    void RunDepthOne(BlockingFrameHandlers& handlers, VideoFrameDropPolicy drop_policy)
+    {
+        auto queue = handlers.CreateQueue(1, drop_policy);
+
+        queue->Push(CreateRequest(0));
+        EXPECT_TRUE(handlers.first_frame_started.Wait(5000));
+
+        queue->Push(CreateRequest(1));
+        queue->Push(CreateRequest(2));
+        queue->Push(CreateRequest(3));
+
+        // Frames dropped on push are reported before the worker continues.
+        handlers.release_first_frame.Set();
+
+        // Wait until the last queued frame was processed, the destructor would drop it otherwise.
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (handlers.handled_count < 4 && std::chrono::steady_clock::now() < deadline)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        queue = nullptr;
+    }
+}
+
+NATIVE_TEST(SpscQueueOfCapacityOneHoldsOneItem)
+{
+    SpscQueue<int> queue(1);
+    int item = 0;
+
+    EXPECT_EQ(1u, queue.capacity());
+    EXPECT_TRUE(queue.TryPush(1));
+    EXPECT_TRUE(!queue.TryPush(2));
+
+    EXPECT_TRUE(queue.TryPop(item));
+    EXPECT_EQ(1, item);
+    EXPECT_TRUE(!queue.TryPop(item));
+
+    for (int i = 2; i < 10; ++i)
+    {
+        EXPECT_TRUE(queue.TryPush(i));
+        EXPECT_TRUE(!queue.TryPush(-i));
+        EXPECT_TRUE(queue.TryPop(item));
+        EXPECT_EQ(i, item);
+    }
+}
+
+NATIVE_TEST(SpscQueueKeepsOrderWhenWrapping)
+{
+    SpscQueue<int> queue(3);
+    int next_push = 0;
+    int next_pop = 0;
+    int item = 0;
+
+    for (int round = 0; round < 10; ++round)
+    {
+        while (queue.TryPush(next_push))
+        {
+            ++next_push;
+        }
+
+        EXPECT_EQ(next_pop + 3, next_push);
+
+        // Pop fewer items than were pushed, so the next round starts at another slot.
+        for (int i = 0; i < 2; ++i)
+        {
+            EXPECT_TRUE(queue.TryPop(item));
+            EXPECT_EQ(next_pop++, item);
+        }
+    }
+}
+
+NATIVE_TEST(SpscQueueHandsItemsToAnotherThread)
+{
+    SpscQueue<int> queue(1);
+    const int count = 10000;
+    int out_of_order_count = 0;
+
+    std::thread consumer([&]
+    {
+        int item;
+        for (int received = 0; received < count; )
+        {
+            if (queue.TryPop(item))
+            {
+                out_of_order_count += item != received;
+                ++received;
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    for (int i = 0; i < count; )
+    {
+        if (queue.TryPush(i))
+        {
+            ++i;
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    consumer.join();
+    EXPECT_EQ(0, out_of_order_count);
+}
+
+NATIVE_TEST(VideoFrameQueueOfDepthOneDropsNewestFrames)
+{
+    BlockingFrameHandlers handlers;
+    RunDepthOne(handlers, VideoFrameDropPolicy::DropNewest);
+
+    EXPECT_EQ(2u, handlers.processed.size());
+    EXPECT_EQ(0, handlers.processed[0]);
+    EXPECT_EQ(1, handlers.processed[1]);
+
+    EXPECT_EQ(2u, handlers.dropped.size());
+    EXPECT_EQ(2, handlers.dropped[0]);
+    EXPECT_EQ(3, handlers.dropped[1]);
+}
+
+NATIVE_TEST(VideoFrameQueueOfDepthOneDropsOldestFrames)
+{
+    BlockingFrameHandlers handlers;
+    RunDepthOne(handlers, VideoFrameDropPolicy::DropOldest);
+
+    EXPECT_EQ(2u, handlers.processed.size());
+    EXPECT_EQ(0, handlers.processed[0]);
+    EXPECT_EQ(3, handlers.processed[1]);
+
+    EXPECT_EQ(2u, handlers.dropped.size());
+    EXPECT_EQ(1, handlers.dropped[0]);
+    EXPECT_EQ(2, handlers.dropped[1]);
+}
+
+NATIVE_TEST(VideoFrameQueueHandlesEveryFrameOnceWhenDestroyed)
+{
+    BlockingFrameHandlers handlers;
+    auto queue = handlers.CreateQueue(2, VideoFrameDropPolicy::DropNewest);
+
+    queue->Push(CreateRequest(0));
+    EXPECT_TRUE(handlers.first_frame_started.Wait(5000));
+
+    queue->Push(CreateRequest(1));
+    queue->Push(CreateRequest(2));
+
+    // The worker might process the queued frames before it sees it is stopping, the destructor drops the rest.
+    std::thread destroyer([&] { queue = nullptr; });
+    handlers.release_first_frame.Set();
+    destroyer.join();
+
+    EXPECT_EQ(3, handlers.handled_count.load());
+    EXPECT_EQ(0, handlers.processed[0]);
+
+    auto handled = handlers.processed;
+    handled.insert(handled.end(), handlers.dropped.begin(), handlers.dropped.end());
+
+    for (int i = 0; i < 3; ++i)
+    {
+        EXPECT_EQ(i, handled[i]);
+    }
+}
@@ -0,0 +1,271 @@
+#include "pch.h"
+#include "DataChannelSender.h"
+#include "DataChunkAssembler.h"
+
+namespace webrtc
+{
+    DataChannelSender::DataChannelSender(int channel_id, DataChannelInterface* channel, rtc::Thread* signaling_thread,
+        BufferedAmountLowHandler on_buffered_amount_low)
+        : id_(channel_id)
+        , channel_(channel)
+        , signaling_thread_(signaling_thread)
+        , on_buffered_amount_low_(std::move(on_buffered_amount_low))
+    {
+    }
+
+    void DataChannelSender::OnBufferedAmountChange(uint64_t previous_amount)
+    {
+        // Called on the signaling thread.
+        is_send_pending_requested_ = true;
+
+        bool is_nested = false;
+
+        {
+            std::unique_lock<std::recursive_mutex> lock(send_mutex_, std::try_to_lock);
+            if (lock.owns_lock())
+            {
+                // Raised by a send of this thread while it holds the lock, that send continues with the pending messages.
+                is_nested = send_lock_depth_ > 0;
+                is_send_pending_requested_ = false;
+
+                if (!is_nested)
+                {
+                    ++send_lock_depth_;
+                    SendPending();
+                    --send_lock_depth_;
+                }
+            }
+        }
+
+        const auto low = low_water_mark.load();
+        if (low >= 0)
+        {
+            const auto amount = buffered_amount();
+            const auto previous = previous_amount + pending_amount_;
+
+            if (previous > static_cast<uint64_t>(low) && amount <= static_cast<uint64_t>(low))
+            {
+                is_buffered_amount_low_ = true;
+            }
+        }
+
+        // The handler is never called with the lock held, a nested change is reported by the outer send.
+        if (!is_nested)
+        {
+            NotifyBufferedAmountLow();
+        }
+    }
+
+    void DataChannelSender::NotifyBufferedAmountLow()
+    {
+        // Only the signaling thread reports, so the handler is not called from within a send of the host.
+        if (signaling_thread_ && !signaling_thread_->IsCurrent())
+            return;
+
+        if (!is_buffered_amount_low_.exchange(false))
+            return;
+
+        if (on_buffered_amount_low_)
+        {
+            on_buffered_amount_low_(buffered_amount());
+        }
+    }
+
+    bool DataChannelSender::Send(const DataBuffer& buffer, absl::optional<uint8_t> prefix)
+    {
+        const auto max_chunk_size = static_cast<size_t>(chunk_size.load());
+        const auto size = (prefix ? 1 : 0) + buffer.size();
+
+        if (max_chunk_size == 0 && high_water_mark == 0 && pending_amount_ == 0 && !is_sending_pending_)
+            return channel_->Send(CreateDataMessage(buffer, prefix));
+
+        // The owner of the lock might be a host thread waiting for the signaling thread to run a channel call,
+        // so the signaling thread never blocks on it.
+        const bool can_block = !signaling_thread_ || !signaling_thread_->IsCurrent();
+
+        std::unique_lock<std::recursive_mutex> lock(send_mutex_, std::defer_lock);
+
+        if (can_block)
+        {
+            lock.lock();
+        }
+        else if (!lock.try_lock())
+        {
+            // Leave the message to the owner, which sends the pending messages after releasing the lock.
+            {
+                std::lock_guard<std::mutex> inbox_lock(inbox_mutex_);
+                inbox_.push_back({ buffer, prefix });
+                pending_amount_ += size;
+            }
+
+            is_send_pending_requested_ = true;
+            SendRequestedPending(false);
+            NotifyBufferedAmountLow();
+            return true;
+        }
+
+        bool is_sent = true;
+
+        {
+            ++send_lock_depth_;
+
+            // Messages left by the signaling thread go first.
+            QueueInbox();
+
+            const auto high = static_cast<uint64_t>(high_water_mark.load());
+
+            if (max_chunk_size > 0 && size + DataChunkHeader::kSize > max_chunk_size)
+            {
+                // Large messages are sent chunk by chunk in SendPending, so smaller messages can overtake them.
+                chunked_messages_.push_back({ buffer.data, prefix, buffer.binary, next_message_id_++, size, 0, max_chunk_size });
+                pending_amount_ += size;
+            }
+            else
+            {
+                const auto message = max_chunk_size > 0
+                    ? CreateDataChunk(next_message_id_++, buffer.data, 0, size, buffer.binary, prefix)
+                    : CreateDataMessage(buffer, prefix);
+
+                if (pending_.empty() && (high == 0 || channel_->buffered_amount() + message.size() <= high))
+                {
+                    is_sent = channel_->Send(message);
+                }
+                else
+                {
+                    pending_.push_back(message);
+                    pending_amount_ += message.size();
+                }
+            }
+
+            SendPending();
+            --send_lock_depth_;
+            lock.unlock();
+        }
+
+        SendRequestedPending(can_block);
+        NotifyBufferedAmountLow();
+        return is_sent;
+    }
+
+    void DataChannelSender::SendRequestedPending(bool can_block)
+    {
+        // The signaling thread might have asked to send the pending messages while we held the lock.
+        while (is_send_pending_requested_.exchange(false))
+        {
+            std::unique_lock<std::recursive_mutex> lock(send_mutex_, std::defer_lock);
+
+            if (can_block)
+            {
+                lock.lock();
+            }
+            else if (!lock.try_lock())
+            {
+                // The current owner checks the request after releasing the lock.
+                is_send_pending_requested_ = true;
+                return;
+            }
+
+            ++send_lock_depth_;
+            SendPending();
+            --send_lock_depth_;
+        }
+    }
+
+    void DataChannelSender::QueueInbox()
+    {
+        std::deque<InboxMessage> inbox;
+        {
+            std::lock_guard<std::mutex> inbox_lock(inbox_mutex_);
+            if (inbox_.empty())
+                return;
+
+            inbox.swap(inbox_);
+        }
+
+        const auto max_chunk_size = static_cast<size_t>(chunk_size.load());
+
+        for (auto& message : inbox)
+        {
+            const auto& buffer = message.buffer;
+            const auto size = (message.prefix ? 1 : 0) + buffer.size();
+
+            // Counted again before the inbox is uncounted, so the pending amount never reads 0 meanwhile.
+            if (max_chunk_size > 0 && size + DataChunkHeader::kSize > max_chunk_size)
+            {
+                chunked_messages_.push_back({ buffer.data, message.prefix, buffer.binary, next_message_id_++, size, 0, max_chunk_size });
+                pending_amount_ += size;
+            }
+            else
+            {
+                pending_.push_back(max_chunk_size > 0
+                    ? CreateDataChunk(next_message_id_++, buffer.data, 0, size, buffer.binary, message.prefix)
+                    : CreateDataMessage(buffer, message.prefix));
+                pending_amount_ += pending_.back().size();
+            }
+
+            pending_amount_ -= size;
+        }
+    }
+
+    void DataChannelSender::SendPending()
+    {
+        if (is_sending_pending_)
+            return;
+
+        is_sending_pending_ = true;
+
+        QueueInbox();
+
+        const auto high = static_cast<uint64_t>(high_water_mark.load());
+
+        while (!pending_.empty())
+        {
+            if (high > 0 && channel_->buffered_amount() + pending_.front().size() > high)
+                break;
+
+            const auto buffer = std::move(pending_.front());
+            pending_.pop_front();
+            pending_amount_ -= buffer.size();
+
+            if (!channel_->Send(buffer))
+            {
+                RTC_LOG(LS_ERROR) << "Failed to send queued message on data channel #" << id_;
+            }
+        }
+
+        // Only send the next chunk when the channel has room for it, the other chunks wait for OnBufferedAmountChange.
+        while (pending_.empty() && !chunked_messages_.empty())
+        {
+            auto& message = chunked_messages_.front();
+
+            const auto window = high > 0 ? high : message.chunk_size;
+            const auto length = std::min(message.chunk_size - DataChunkHeader::kSize, message.size - message.offset);
+
+            if (channel_->buffered_amount() + DataChunkHeader::kSize + length > window)
+                break;
+
+            const auto message_id = message.id;
+            const auto chunk = CreateDataChunk(message_id, message.data, message.offset, length, message.is_binary, message.prefix);
+
+            message.offset += length;
+            pending_amount_ -= length;
+
+            if (message.offset == message.size)
+            {
+                chunked_messages_.pop_front();
+            }
+
+            if (!channel_->Send(chunk))
+            {
+                RTC_LOG(LS_ERROR) << "Failed to send chunk of message #" << message_id << " on data channel #" << id_;
+            }
+        }
+
+        is_sending_pending_ = false;
+    }
+
+    uint64_t DataChannelSender::buffered_amount() const
+    {
+        return channel_->buffered_amount() + pending_amount_;
+    }
+} // namespace webrtc
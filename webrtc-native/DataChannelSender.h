@@ -0,0 +1,93 @@
+#pragma once
+#include "macros.h"
+
+namespace webrtc
+{
+    // Sends the messages of a data channel, queueing them above the high-water mark and splitting large ones in chunks.
+    // Send may be called from any thread, OnBufferedAmountChange is called by the channel on the signaling thread.
+    class DataChannelSender final
+    {
+    public:
+        // Called on the signaling thread, never with the send lock held.
+        using BufferedAmountLowHandler = std::function<void(uint64_t amount)>;
+
+        // The signaling thread is null when the application pumps the messages itself.
+        // The channel must outlive the sender, the identifier is only logged.
+        DataChannelSender(int channel_id, DataChannelInterface* channel, rtc::Thread* signaling_thread,
+            BufferedAmountLowHandler on_buffered_amount_low);
+        ~DataChannelSender() = default;
+
+        DISALLOW_COPY_MOVE_ASSIGN(DataChannelSender);
+
+        // Queues the message when the high-water mark would be exceeded.
+        // The prefix byte is sent before the message, and written while framing it, so the message is copied at most once.
+        bool Send(const DataBuffer& buffer, absl::optional<uint8_t> prefix = absl::nullopt);
+
+        void OnBufferedAmountChange(uint64_t previous_amount);
+
+        // Includes the queued messages.
+        uint64_t buffered_amount() const;
+
+        std::atomic<int64_t> low_water_mark{ -1 };
+        std::atomic<int64_t> high_water_mark{ 0 };
+
+        // The maximum size of a chunk including its header, 0 when chunking is disabled.
+        std::atomic<int> chunk_size{ 0 };
+
+    private:
+        struct ChunkedMessage
+        {
+            rtc::CopyOnWriteBuffer data;
+            absl::optional<uint8_t> prefix;
+            bool is_binary;
+            uint32_t id;
+            // Including the prefix, like the offset.
+            size_t size;
+            size_t offset;
+            size_t chunk_size;
+        };
+
+        struct InboxMessage
+        {
+            DataBuffer buffer;
+            absl::optional<uint8_t> prefix;
+        };
+
+        // Must be called with send_mutex_ locked.
+        void SendPending();
+        void QueueInbox();
+
+        // Must be called without send_mutex_ locked.
+        void SendRequestedPending(bool can_block);
+
+        // Calls the handler when the buffered amount dropped to the low-water mark, must be called without send_mutex_ locked.
+        void NotifyBufferedAmountLow();
+
+        const int id_;
+        DataChannelInterface* const channel_;
+        rtc::Thread* const signaling_thread_;
+        const BufferedAmountLowHandler on_buffered_amount_low_;
+
+        // Calls to the channel from other threads are proxied to the signaling thread,
+        // so the signaling thread never blocks on this mutex, it asks the owner to send the pending messages instead.
+        // Sending can raise OnBufferedAmountChange synchronously on the signaling thread, hence the recursive mutex.
+        std::recursive_mutex send_mutex_;
+        // How many sends of the owning thread hold the lock, to recognize nested OnBufferedAmountChange calls.
+        int send_lock_depth_ = 0;
+        std::deque<DataBuffer> pending_;
+        std::deque<ChunkedMessage> chunked_messages_;
+        uint32_t next_message_id_ = 0;
+
+        // A send without the lock first checks that nothing is queued, then that no queued message is being sent,
+        // since the pending amount already dropped when SendPending takes a message.
+        std::atomic<uint64_t> pending_amount_{ 0 };
+        std::atomic<bool> is_sending_pending_{ false };
+        std::atomic<bool> is_send_pending_requested_{ false };
+        std::atomic<bool> is_buffered_amount_low_{ false };
+
+        // Messages sent on the signaling thread while another thread held send_mutex_.
+        // This mutex is never held while calling the channel.
+        std::mutex inbox_mutex_;
+        std::deque<InboxMessage> inbox_;
+    };
+} // namespace webrtc
@@ -0,0 +1,162 @@
+#include "pch.h"
+#include "DataChunkAssembler.h"
+
+namespace webrtc
+{
+    DataBuffer CreateDataChunk(uint32_t message_id, const rtc::CopyOnWriteBuffer& message, size_t offset, size_t length, bool is_binary,
+        absl::optional<uint8_t> prefix)
+    {
+        const size_t prefix_size = prefix ? 1 : 0;
+        RTC_DCHECK_LE(offset + length, prefix_size + message.size());
+
+        rtc::CopyOnWriteBuffer chunk(DataChunkHeader::kSize + length);
+        auto data = chunk.data();
+
+        rtc::SetLE32(data + 0, message_id);
+        rtc::SetLE32(data + 4, static_cast<uint32_t>(prefix_size + message.size()));
+        rtc::SetLE32(data + 8, static_cast<uint32_t>(offset));
+        data += DataChunkHeader::kSize;
+
+        // The prefix is written here, so the message is only copied once.
+        if (prefix && offset == 0 && length > 0)
+        {
+            *data++ = *prefix;
+            --length;
+        }
+        else if (offset > 0)
+        {
+            offset -= prefix_size;
+        }
+
+        memcpy(data, message.cdata() + offset, length);
+
+        return DataBuffer(std::move(chunk), is_binary);
+    }
+
+    DataBuffer CreateDataMessage(const DataBuffer& message, absl::optional<uint8_t> prefix)
+    {
+        if (!prefix)
+            return message;
+
+        rtc::CopyOnWriteBuffer data(1 + message.size());
+        data.data()[0] = *prefix;
+        memcpy(data.data() + 1, message.data.cdata(), message.size());
+        return DataBuffer(std::move(data), message.binary);
+    }
+
+    DataChunkAssembler::DataChunkAssembler(size_t max_pooled_buffer_count)
+        : max_pooled_buffer_count_(max_pooled_buffer_count)
+    {
+    }
+
+    bool DataChunkAssembler::Add(const rtc::CopyOnWriteBuffer& chunk, size_t max_message_size, rtc::CopyOnWriteBuffer* message, size_t* message_offset)
+    {
+        if (chunk.size() < DataChunkHeader::kSize)
+        {
+            RTC_LOG(LS_ERROR) << "Dropping data chunk of " << chunk.size() << " bytes, it has no header";
+            return false;
+        }
+
+        const auto data = chunk.cdata();
+
+        DataChunkHeader header;
+        header.message_id = rtc::GetLE32(data + 0);
+        header.message_size = rtc::GetLE32(data + 4);
+        header.offset = rtc::GetLE32(data + 8);
+
+        const size_t length = chunk.size() - DataChunkHeader::kSize;
+
+        if (header.offset + length > header.message_size)
+        {
+            RTC_LOG(LS_ERROR) << "Dropping invalid data chunk of message #" << header.message_id;
+            return false;
+        }
+
+        if (header.message_size > max_message_size || header.message_size > kMaxMessageSize)
+        {
+            RTC_LOG(LS_ERROR) << "Dropping data chunk of message #" << header.message_id << ", the message is too large";
+            return false;
+        }
+
+        // A message of a single chunk is delivered as is.
+        if (header.offset == 0 && length == header.message_size)
+        {
+            *message = chunk;
+            *message_offset = DataChunkHeader::kSize;
+            return true;
+        }
+
+        auto it = partial_messages_.find(header.message_id);
+        if (it == partial_messages_.end())
+        {
+            if (partial_messages_.size() >= kMaxPartialMessageCount)
+            {
+                RTC_LOG(LS_WARNING) << "Dropping incomplete data message #" << partial_messages_.begin()->first;
+                Recycle(std::move(partial_messages_.begin()->second.data));
+                partial_messages_.erase(partial_messages_.begin());
+            }
+
+            it = partial_messages_.emplace(header.message_id, PartialMessage{ CreateBuffer(header.message_size), header.message_size, 0 }).first;
+        }
+
+        auto& partial = it->second;
+
+        if (partial.message_size != header.message_size)
+        {
+            RTC_LOG(LS_ERROR) << "Dropping data chunk of message #" << header.message_id << ", its size does not match";
+            return false;
+        }
+
+        // Chunks can arrive out of order on unordered channels, the gap is filled by the chunks that follow.
+        const size_t end = header.offset + length;
+        if (partial.data.size() < end)
+        {
+            partial.data.SetSize(end);
+        }
+
+        memcpy(partial.data.data() + header.offset, data + DataChunkHeader::kSize, length);
+        partial.received_size += length;
+
+        if (partial.received_size < partial.message_size || partial.data.size() < partial.message_size)
+            return false;
+
+        *message = std::move(partial.data);
+        *message_offset = 0;
+        partial_messages_.erase(it);
+        return true;
+    }
+
+    void DataChunkAssembler::Recycle(rtc::CopyOnWriteBuffer&& buffer)
+    {
+        if (buffers_.size() < max_pooled_buffer_count_ && buffer.capacity() > 0)
+        {
+            buffer.Clear();
+            buffers_.push_back(std::move(buffer));
+        }
+    }
+
+    rtc::CopyOnWriteBuffer DataChunkAssembler::CreateBuffer(size_t message_size)
+    {
+        // Prefer the smallest pooled buffer that is large enough, otherwise the largest one, which grows as the chunks arrive.
+        auto best = buffers_.end();
+
+        for (auto it = buffers_.begin(); it != buffers_.end(); ++it)
+        {
+            const bool fits = it->capacity() >= message_size;
+
+            if (best == buffers_.end() ||
+                (fits && (best->capacity() < message_size || it->capacity() < best->capacity())) ||
+                (!fits && best->capacity() < message_size && it->capacity() > best->capacity()))
+            {
+                best = it;
+            }
+        }
+
+        if (best == buffers_.end())
+            return rtc::CopyOnWriteBuffer();
+
+        auto buffer = std::move(*best);
+        buffers_.erase(best);
+        return buffer;
+    }
+} // namespace webrtc
@@ -0,0 +1,65 @@
+#pragma once
+#include "macros.h"
+
+namespace webrtc
+{
+    // Every chunk of a data channel with chunking starts with this header, all fields are little-endian.
+    // Messages that fit in a single chunk are framed too, so the receiver can tell them apart.
+    struct DataChunkHeader
+    {
+        static constexpr size_t kSize = 12;
+
+        uint32_t message_id;
+        uint32_t message_size;
+        uint32_t offset;
+    };
+
+    // Creates the chunk holding the given part of a message.
+    // The message starts with the prefix byte when given, the offset and length include it.
+    DataBuffer CreateDataChunk(uint32_t message_id, const rtc::CopyOnWriteBuffer& message, size_t offset, size_t length, bool is_binary,
+        absl::optional<uint8_t> prefix = absl::nullopt);
+
+    // Creates an unchunked message, which only copies the message when there is a prefix byte to add.
+    DataBuffer CreateDataMessage(const DataBuffer& message, absl::optional<uint8_t> prefix);
+
+    // Reassembles chunked data channel messages, chunks of different messages may be interleaved.
+    // Must be used from a single thread.
+    class DataChunkAssembler final
+    {
+    public:
+        // The peer chooses the message size, so larger messages are dropped unless the limit is raised, up to kMaxMessageSize.
+        static constexpr size_t kDefaultMaxMessageSize = 16 << 20;
+        static constexpr size_t kMaxMessageSize = 256 << 20;
+
+        explicit DataChunkAssembler(size_t max_pooled_buffer_count = 4);
+        ~DataChunkAssembler() = default;
+
+        DISALLOW_COPY_MOVE_ASSIGN(DataChunkAssembler);
+
+        // Adds a received chunk, invalid chunks and chunks of messages larger than max_message_size are dropped.
+        // Returns true when this completes a message, which then starts at message_offset in the message buffer.
+        bool Add(const rtc::CopyOnWriteBuffer& chunk, size_t max_message_size, rtc::CopyOnWriteBuffer* message, size_t* message_offset);
+
+        // Returns the buffer of a delivered message to the pool, the caller must not share it anymore.
+        void Recycle(rtc::CopyOnWriteBuffer&& buffer);
+
+    private:
+        // The buffer grows as the chunks arrive, so a peer can't make us allocate more than it actually sent.
+        struct PartialMessage
+        {
+            rtc::CopyOnWriteBuffer data;
+            size_t message_size;
+            size_t received_size;
+        };
+
+        // Returns an empty buffer, pooled when possible.
+        rtc::CopyOnWriteBuffer CreateBuffer(size_t message_size);
+
+        // Lost chunks of unreliable channels would leak their message, so only this many messages are assembled at once.
+        static constexpr size_t kMaxPartialMessageCount = 64;
+
+        const size_t max_pooled_buffer_count_;
+        std::map<uint32_t, PartialMessage> partial_messages_;
+        std::vector<rtc::CopyOnWriteBuffer> buffers_;
+    };
+} // namespace webrtc
@@ -0,0 +1,155 @@
+#include "pch.h"
+#include "DataCompression.h"
+
+namespace webrtc
+{
+    namespace
+    {
+        const size_t kMinInflateCapacity = 64 * 1024;
+    }
+
+    DataDeflater::~DataDeflater()
+    {
+        if (is_initialized_)
+        {
+            deflateEnd(&stream_);
+        }
+    }
+
+    bool DataDeflater::Deflate(const uint8_t* data, size_t size, int level, rtc::CopyOnWriteBuffer* output)
+    {
+        if (size <= DataCompressionHeader::kDeflateSize || size > std::numeric_limits<uint32_t>::max())
+            return false;
+
+        if (!is_initialized_ || level != level_)
+        {
+            if (is_initialized_)
+            {
+                deflateEnd(&stream_);
+                is_initialized_ = false;
+            }
+
+            stream_ = z_stream{};
+            if (deflateInit(&stream_, level) != Z_OK)
+            {
+                RTC_LOG(LS_ERROR) << "Failed to initialize deflate with level " << level;
+                return false;
+            }
+
+            is_initialized_ = true;
+            level_ = level;
+        }
+        else if (deflateReset(&stream_) != Z_OK)
+        {
+            return false;
+        }
+
+        // Stop deflating as soon as the message would not shrink.
+        const auto max_size = size - DataCompressionHeader::kDeflateSize;
+        output->SetSize(DataCompressionHeader::kDeflateSize + std::min<size_t>(max_size, deflateBound(&stream_, static_cast<uLong>(size))));
+
+        const auto header = output->data();
+        header[0] = DataCompressionHeader::kDeflate;
+        rtc::SetLE32(header + 1, static_cast<uint32_t>(size));
+
+        stream_.next_in = const_cast<Bytef*>(data);
+        stream_.avail_in = static_cast<uInt>(size);
+        stream_.next_out = header + DataCompressionHeader::kDeflateSize;
+        stream_.avail_out = static_cast<uInt>(output->size() - DataCompressionHeader::kDeflateSize);
+
+        if (deflate(&stream_, Z_FINISH) != Z_STREAM_END)
+            return false;
+
+        output->SetSize(DataCompressionHeader::kDeflateSize + stream_.total_out);
+        return true;
+    }
+
+    DataInflater::~DataInflater()
+    {
+        if (is_initialized_)
+        {
+            inflateEnd(&stream_);
+        }
+    }
+
+    DataInflater::Result DataInflater::Decompress(const uint8_t* message, size_t size, size_t max_size, rtc::CopyOnWriteBuffer* output)
+    {
+        if (size >= DataCompressionHeader::kStoredSize && message[0] == DataCompressionHeader::kStored)
+            return Result::kStored;
+
+        if (size < DataCompressionHeader::kDeflateSize || message[0] != DataCompressionHeader::kDeflate)
+        {
+            RTC_LOG(LS_ERROR) << "Data message has no compression header";
+            return Result::kInvalid;
+        }
+
+        const size_t inflated_size = rtc::GetLE32(message + 1);
+        if (inflated_size > max_size)
+        {
+            RTC_LOG(LS_ERROR) << "Compressed data message of " << inflated_size << " bytes exceeds the limit of " << max_size << " bytes";
+            return Result::kInvalid;
+        }
+
+        const bool is_inflated = Inflate(
+            message + DataCompressionHeader::kDeflateSize, size - DataCompressionHeader::kDeflateSize,
+            inflated_size, output);
+
+        return is_inflated ? Result::kInflated : Result::kInvalid;
+    }
+
+    bool DataInflater::Inflate(const uint8_t* data, size_t size, size_t inflated_size, rtc::CopyOnWriteBuffer* output)
+    {
+        if (!is_initialized_)
+        {
+            stream_ = z_stream{};
+            if (inflateInit(&stream_) != Z_OK)
+            {
+                RTC_LOG(LS_ERROR) << "Failed to initialize inflate";
+                return false;
+            }
+
+            is_initialized_ = true;
+        }
+        else if (inflateReset(&stream_) != Z_OK)
+        {
+            return false;
+        }
+
+        // Start with room for a typical compression ratio, and grow by doubling up to the announced size.
+        size_t capacity = std::min(inflated_size, std::max<size_t>(size * 4, kMinInflateCapacity));
+        output->SetSize(capacity);
+
+        stream_.next_in = const_cast<Bytef*>(data);
+        stream_.avail_in = static_cast<uInt>(size);
+        stream_.next_out = output->data();
+        stream_.avail_out = static_cast<uInt>(capacity);
+
+        for (;;)
+        {
+            const auto result = inflate(&stream_, Z_NO_FLUSH);
+
+            if (result == Z_STREAM_END)
+                break;
+
+            // The output is full, otherwise the message ended before its stream did.
+            if ((result != Z_OK && result != Z_BUF_ERROR) || stream_.avail_out > 0)
+                return false;
+
+            // Inflates to more than announced.
+            if (capacity == inflated_size)
+                return false;
+
+            capacity = std::min(inflated_size, capacity * 2);
+            output->SetSize(capacity);
+
+            stream_.next_out = output->data() + stream_.total_out;
+            stream_.avail_out = static_cast<uInt>(capacity - stream_.total_out);
+        }
+
+        if (stream_.total_out != inflated_size)
+            return false;
+
+        output->SetSize(inflated_size);
+        return true;
+    }
+} // namespace webrtc
@@ -0,0 +1,73 @@
+#pragma once
+#include "macros.h"
+
+#include "third_party/zlib/zlib.h"
+
+namespace webrtc
+{
+    // Every message of a data channel with compression starts with this header.
+    // Uncompressed messages only have the method byte, compressed ones also have their uncompressed size (little-endian).
+    struct DataCompressionHeader
+    {
+        enum Method : uint8_t
+        {
+            kStored = 0,
+            kDeflate = 1
+        };
+
+        static constexpr size_t kStoredSize = 1;
+        static constexpr size_t kDeflateSize = 5;
+    };
+
+    // Compresses data channel messages with zlib, reusing its state between messages.
+    // Must be used from a single thread.
+    class DataDeflater final
+    {
+    public:
+        // Smaller messages rarely shrink enough to be worth the time.
+        static constexpr int kDefaultThreshold = 256;
+
+        DataDeflater() = default;
+        ~DataDeflater();
+
+        DISALLOW_COPY_MOVE_ASSIGN(DataDeflater);
+
+        // Returns false when the message could not be made smaller, the output is then undefined.
+        bool Deflate(const uint8_t* data, size_t size, int level, rtc::CopyOnWriteBuffer* output);
+
+    private:
+        z_stream stream_{};
+        bool is_initialized_ = false;
+        int level_ = Z_DEFAULT_COMPRESSION;
+    };
+
+    // Decompresses data channel messages, reusing its state between messages.
+    // Must be used from a single thread.
+    class DataInflater final
+    {
+    public:
+        DataInflater() = default;
+        ~DataInflater();
+
+        DISALLOW_COPY_MOVE_ASSIGN(DataInflater);
+
+        enum class Result
+        {
+            kInvalid,
+            kStored,
+            kInflated
+        };
+
+        // Decodes a message that starts with a DataCompressionHeader.
+        // The payload of a stored message follows its header, deflated messages are inflated into the output.
+        // The uncompressed size in the header is chosen by the peer, so messages that claim more than max_size bytes are invalid,
+        // and the output only grows as far as the message actually inflates.
+        Result Decompress(const uint8_t* message, size_t size, size_t max_size, rtc::CopyOnWriteBuffer* output);
+
+    private:
+        bool Inflate(const uint8_t* data, size_t size, size_t inflated_size, rtc::CopyOnWriteBuffer* output);
+
+        z_stream stream_{};
+        bool is_initialized_ = false;
+    };
+} // namespace webrtc
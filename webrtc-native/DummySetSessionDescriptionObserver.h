@@ -1,6 +1,6 @@
 #pragma once
 
-class DummySetSessionDescriptionObserver abstract
+class DummySetSessionDescriptionObserver
     : public webrtc::SetSessionDescriptionObserver {
 public:
     static DummySetSessionDescriptionObserver* Create();
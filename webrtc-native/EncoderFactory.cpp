@@ -1,6 +1,8 @@
 #include "pch.h"
 #include "EncoderFactory.h"
 #include "NvEncoderH264.h"
+#include "OpenH264Encoder.h"
+#include "TrackedVideoBuffer.h"
 
 using namespace webrtc;
 
@@ -32,6 +34,8 @@ SdpVideoFormat CreateH264Format(H264::Profile profile, H264::Level level, const
          {cricket::kH264FmtpPacketizationMode, packetization_mode} });
 }
 
+#ifdef HAS_NVENC
+
 class NvEncoderFactory : public VideoEncoderFactory
 {
 private:
@@ -69,12 +73,224 @@ public:
     }
 };
 
-std::unique_ptr<VideoEncoderFactory> CreateEncoderFactory(bool force_software_encoder)
+#endif
+
+#ifdef WEBRTC_USE_H264
+
+// Offers H.264 encoded by OpenH264 before the internal formats, for peers without VP8 support.
+class SoftwareEncoderFactory : public VideoEncoderFactory
+{
+private:
+    const int thread_count_;
+    InternalEncoderFactory internal_factory_;
+    std::vector<SdpVideoFormat> h264_formats_;
+
+public:
+    explicit SoftwareEncoderFactory(int thread_count)
+        : thread_count_(thread_count)
+    {
+        // The same level as NVENC, so 1080p and 4K content is not negotiated below its level, see OpenH264Encoder.
+        h264_formats_.push_back(CreateH264Format(H264::kProfileBaseline, H264::kLevel5, "1"));
+        h264_formats_.push_back(CreateH264Format(H264::kProfileBaseline, H264::kLevel5, "0"));
+        h264_formats_.push_back(CreateH264Format(H264::kProfileConstrainedBaseline, H264::kLevel5, "1"));
+        h264_formats_.push_back(CreateH264Format(H264::kProfileConstrainedBaseline, H264::kLevel5, "0"));
+    }
+
+    CodecInfo QueryVideoEncoder(const SdpVideoFormat& format) const override
+    {
+        if (!IsFormatSupported(h264_formats_, format))
+            return internal_factory_.QueryVideoEncoder(format);
+
+        CodecInfo info;
+        info.has_internal_source = false;
+        info.is_hardware_accelerated = false;
+        return info;
+    }
+
+    std::unique_ptr<VideoEncoder> CreateVideoEncoder(const SdpVideoFormat& format) override
+    {
+        if (!IsFormatSupported(h264_formats_, format))
+            return internal_factory_.CreateVideoEncoder(format);
+
+        // Packetization mode 0 sends every NAL unit in its own packet, so the encoder limits the slice size.
+        const auto mode = format.parameters.find(cricket::kH264FmtpPacketizationMode);
+        const auto packetization_mode = mode != format.parameters.end() && mode->second == "1"
+            ? H264PacketizationMode::NonInterleaved
+            : H264PacketizationMode::SingleNalUnit;
+
+        return std::make_unique<OpenH264Encoder>(thread_count_, packetization_mode);
+    }
+
+    std::vector<SdpVideoFormat> GetSupportedFormats() const override
+    {
+        auto formats = h264_formats_;
+
+        for (auto& format : internal_factory_.GetSupportedFormats())
+        {
+            if (!IsFormatSupported(formats, format))
+            {
+                formats.push_back(std::move(format));
+            }
+        }
+
+        return formats;
+    }
+};
+
+#endif
+
+// Marks the tracked frames that the wrapped encoder produced an image for as encoded.
+// Frames that the encoder drops, or never gets because of frame rate limits, are reported as not encoded.
+// Only encoders that deliver the image from within Encode are supported, all encoders we use do.
+class TrackingVideoEncoder final : public VideoEncoder, private EncodedImageCallback
 {
+public:
+    TrackingVideoEncoder(std::unique_ptr<VideoEncoder> encoder, std::shared_ptr<LatencyHistogram> encode_timing)
+        : encoder_(std::move(encoder))
+        , encode_timing_(std::move(encode_timing))
+    {
+    }
+
+    int32_t InitEncode(const VideoCodec* codec_settings, int32_t number_of_cores, size_t max_payload_size) override
+    {
+        return encoder_->InitEncode(codec_settings, number_of_cores, max_payload_size);
+    }
+
+    int32_t RegisterEncodeCompleteCallback(EncodedImageCallback* callback) override
+    {
+        callback_ = callback;
+        return encoder_->RegisterEncodeCompleteCallback(callback ? this : nullptr);
+    }
+
+    int32_t Release() override
+    {
+        return encoder_->Release();
+    }
+
+    int32_t Encode(const VideoFrame& frame, const CodecSpecificInfo* codec_specific_info, const std::vector<FrameType>* frame_types) override
+    {
+        encoding_frame_ = GetLifetime(frame.video_frame_buffer().get());
+
+        if (encoding_frame_)
+        {
+            encoding_frame_->set_encode_started();
+        }
+
+        encode_start_time_us_ = Clock::GetRealTimeClock()->TimeInMicroseconds();
+
+        const auto result = encoder_->Encode(frame, codec_specific_info, frame_types);
+
+        encoding_frame_ = nullptr;
+        encode_start_time_us_ = -1;
+        return result;
+    }
+
+    int32_t SetRateAllocation(const VideoBitrateAllocation& allocation, uint32_t framerate) override
+    {
+        return encoder_->SetRateAllocation(allocation, framerate);
+    }
+
+    EncoderInfo GetEncoderInfo() const override
+    {
+        return encoder_->GetEncoderInfo();
+    }
+
+private:
+    // Tracked buffers that the sender converted for an encoder without native handle support
+    // arrive as TrackedI420Buffer.
+    static VideoFrameLifetime* GetLifetime(VideoFrameBuffer* buffer)
+    {
+        if (const auto tracked = dynamic_cast<TrackedVideoBuffer*>(buffer))
+            return tracked->lifetime();
+
+        if (const auto tracked = dynamic_cast<TrackedI420Buffer*>(buffer))
+            return tracked->lifetime();
+
+        return nullptr;
+    }
+
+    Result OnEncodedImage(const EncodedImage& encoded_image, const CodecSpecificInfo* codec_specific_info, const RTPFragmentationHeader* fragmentation) override
+    {
+        // Only the first image of a frame, the others were produced while encoding it.
+        if (encode_timing_ && encode_start_time_us_ >= 0)
+        {
+            encode_timing_->Record(Clock::GetRealTimeClock()->TimeInMicroseconds() - encode_start_time_us_);
+            encode_start_time_us_ = -1;
+        }
+
+        if (!encoding_frame_)
+            return callback_->OnEncodedImage(encoded_image, codec_specific_info, fragmentation);
+
+        encoding_frame_->set_encoded(true);
+
+        // The image is packetized before the callback returns.
+        const auto result = callback_->OnEncodedImage(encoded_image, codec_specific_info, fragmentation);
+        encoding_frame_->set_sent();
+        return result;
+    }
+
+    void OnDroppedFrame(DropReason reason) override
+    {
+        callback_->OnDroppedFrame(reason);
+    }
+
+    const std::unique_ptr<VideoEncoder> encoder_;
+    const std::shared_ptr<LatencyHistogram> encode_timing_;
+    EncodedImageCallback* callback_ = nullptr;
+    VideoFrameLifetime* encoding_frame_ = nullptr;
+    int64_t encode_start_time_us_ = -1;
+};
+
+class TrackingEncoderFactory : public VideoEncoderFactory
+{
+private:
+    const std::unique_ptr<VideoEncoderFactory> factory_;
+    const std::shared_ptr<LatencyHistogram> encode_timing_;
+
+public:
+    TrackingEncoderFactory(std::unique_ptr<VideoEncoderFactory> factory, std::shared_ptr<LatencyHistogram> encode_timing)
+        : factory_(std::move(factory))
+        , encode_timing_(std::move(encode_timing))
+    {
+    }
+
+    CodecInfo QueryVideoEncoder(const SdpVideoFormat& format) const override
+    {
+        return factory_->QueryVideoEncoder(format);
+    }
+
+    std::unique_ptr<VideoEncoder> CreateVideoEncoder(const SdpVideoFormat& format) override
+    {
+        auto encoder = factory_->CreateVideoEncoder(format);
+        return encoder ? std::make_unique<TrackingVideoEncoder>(std::move(encoder), encode_timing_) : nullptr;
+    }
+
+    std::vector<SdpVideoFormat> GetSupportedFormats() const override
+    {
+        return factory_->GetSupportedFormats();
+    }
+};
+
+std::unique_ptr<VideoEncoderFactory> CreateEncoderFactory(bool force_software_encoder, int software_encoder_thread_count)
+{
+#ifdef HAS_NVENC
     if (!force_software_encoder && NvEncoderH264::IsAvailable())
         return std::make_unique<NvEncoderFactory>();
+#endif
 
+#ifdef WEBRTC_USE_H264
+    // Fallback to OpenH264, or VP8 for peers without H.264, if no licensed NVEnc hardware encoder is found.
+    return std::make_unique<SoftwareEncoderFactory>(software_encoder_thread_count);
+#else
     // Fallback to VP8 if no licensed NVEnc hardware encoder is found.
     return std::make_unique<InternalEncoderFactory>();
+#endif
+}
+
+std::unique_ptr<VideoEncoderFactory> CreateTrackingEncoderFactory(
+    std::unique_ptr<VideoEncoderFactory> factory,
+    std::shared_ptr<LatencyHistogram> encode_timing)
+{
+    return std::make_unique<TrackingEncoderFactory>(std::move(factory), std::move(encode_timing));
 }
 
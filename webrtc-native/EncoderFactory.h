@@ -1,3 +1,12 @@
 #pragma once
+#include "LatencyHistogram.h"
 
-std::unique_ptr<webrtc::VideoEncoderFactory> CreateEncoderFactory(bool force_software_encoder);
+// Without NVENC, H.264 is encoded with OpenH264 when libwebrtc is built with it, using the given number of threads,
+// 0 uses the number of cores.
+std::unique_ptr<webrtc::VideoEncoderFactory> CreateEncoderFactory(bool force_software_encoder, int software_encoder_thread_count);
+
+// Wraps the encoders of the given factory, so that the frames of local video tracks are marked as encoded.
+// The time every encoder takes to produce an image is recorded in the given histogram.
+std::unique_ptr<webrtc::VideoEncoderFactory> CreateTrackingEncoderFactory(
+    std::unique_ptr<webrtc::VideoEncoderFactory> factory,
+    std::shared_ptr<webrtc::LatencyHistogram> encode_timing);
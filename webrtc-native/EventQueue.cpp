@@ -0,0 +1,212 @@
+#include "pch.h"
+#include "EventQueue.h"
+
+#ifndef WEBRTC_WIN
+#   include <poll.h>
+#   include <sys/eventfd.h>
+#   include <unistd.h>
+#endif
+
+namespace webrtc
+{
+    EventQueue::EventQueue()
+        : head_(&stub_)
+        , tail_(&stub_)
+    {
+#ifdef WEBRTC_WIN
+        handle_ = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+#else
+        handle_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+#endif
+    }
+
+    EventQueue::~EventQueue()
+    {
+        bool is_pending;
+        while (const auto node = Pop(&is_pending))
+        {
+            Free(node);
+        }
+
+        for (const auto node : drained_)
+        {
+            Free(node);
+        }
+
+#ifdef WEBRTC_WIN
+        CloseHandle(handle_);
+#else
+        close(handle_);
+#endif
+    }
+
+    void EventQueue::Push(const PeerConnectionEvent& event, const void* data, size_t length, const char* text)
+    {
+        const auto text_length = text ? strlen(text) : 0;
+        const auto data_size = data ? length + 1 : 0;
+        const auto payload_size = data_size + (text ? text_length + 1 : 0);
+
+        const auto node = new (::operator new(sizeof(Node) + payload_size)) Node();
+        node->event = event;
+
+        const auto payload = reinterpret_cast<char*>(node + 1);
+
+        if (data)
+        {
+            memcpy(payload, data, length);
+            payload[length] = 0;
+            node->event.data = payload;
+            node->event.length = static_cast<int32_t>(length);
+        }
+
+        if (text)
+        {
+            memcpy(payload + data_size, text, text_length + 1);
+            node->event.text = payload + data_size;
+        }
+
+        Link(node);
+
+        if (!is_signaled_.exchange(true))
+        {
+            Signal();
+        }
+    }
+
+    int EventQueue::Drain(PeerConnectionEvent* events, int capacity)
+    {
+        std::lock_guard<std::mutex> lock(drain_mutex_);
+
+        for (const auto node : drained_)
+        {
+            Free(node);
+        }
+
+        drained_.clear();
+
+        // Events pushed from now on signal again.
+        ResetSignal();
+        is_signaled_ = false;
+
+        int count = 0;
+        bool is_pending = false;
+
+        while (count < capacity)
+        {
+            const auto node = Pop(&is_pending);
+            if (!node)
+                break;
+
+            events[count++] = node->event;
+            drained_.push_back(node);
+        }
+
+        // The producer that is still linking its node might have seen the signal before it was reset.
+        // Events that did not fit in the array were pushed before the reset, so they will not signal either.
+        const auto is_full = count == capacity && (tail_ != &stub_ || head_.load(std::memory_order_acquire) != &stub_);
+
+        if ((is_pending || is_full) && !is_signaled_.exchange(true))
+        {
+            Signal();
+        }
+
+        return count;
+    }
+
+    bool EventQueue::Wait(int timeout_ms) const
+    {
+#ifdef WEBRTC_WIN
+        return WaitForSingleObject(handle_, timeout_ms < 0 ? INFINITE : static_cast<DWORD>(timeout_ms)) == WAIT_OBJECT_0;
+#else
+        pollfd fd{ handle_, POLLIN, 0 };
+        return poll(&fd, 1, timeout_ms) > 0;
+#endif
+    }
+
+    intptr_t EventQueue::handle() const
+    {
+#ifdef WEBRTC_WIN
+        return reinterpret_cast<intptr_t>(handle_);
+#else
+        return handle_;
+#endif
+    }
+
+    EventQueue::Node* EventQueue::Pop(bool* is_pending)
+    {
+        auto tail = tail_;
+        auto next = tail->next.load(std::memory_order_acquire);
+
+        if (tail == &stub_)
+        {
+            if (!next)
+            {
+                *is_pending = head_.load(std::memory_order_acquire) != tail;
+                return nullptr;
+            }
+
+            tail_ = tail = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+
+        if (next)
+        {
+            tail_ = next;
+            return tail;
+        }
+
+        if (tail != head_.load(std::memory_order_acquire))
+        {
+            *is_pending = true;
+            return nullptr;
+        }
+
+        // The tail is the last node, put the stub behind it so it can be popped.
+        Link(&stub_);
+
+        next = tail->next.load(std::memory_order_acquire);
+        if (next)
+        {
+            tail_ = next;
+            return tail;
+        }
+
+        *is_pending = true;
+        return nullptr;
+    }
+
+    void EventQueue::Link(Node* node)
+    {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        const auto previous = head_.exchange(node, std::memory_order_acq_rel);
+        previous->next.store(node, std::memory_order_release);
+    }
+
+    void EventQueue::Signal()
+    {
+#ifdef WEBRTC_WIN
+        SetEvent(handle_);
+#else
+        const uint64_t value = 1;
+        const auto result = write(handle_, &value, sizeof(value));
+        (void)result;
+#endif
+    }
+
+    void EventQueue::ResetSignal()
+    {
+#ifdef WEBRTC_WIN
+        ResetEvent(handle_);
+#else
+        uint64_t value;
+        const auto result = read(handle_, &value, sizeof(value));
+        (void)result;
+#endif
+    }
+
+    void EventQueue::Free(Node* node)
+    {
+        node->~Node();
+        ::operator delete(node);
+    }
+} // namespace webrtc
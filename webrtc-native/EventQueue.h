@@ -0,0 +1,68 @@
+#pragma once
+#include "macros.h"
+#include "NativeInterface.h"
+
+namespace webrtc
+{
+    // An unbounded lock-free queue of peer connection events, pushed by any WebRTC thread and drained in batches by the host.
+    // Pushing never blocks, so WebRTC threads never wait on the host, and a single DrainEvents call returns many events.
+    // Consumers can wait for events with Wait, or on the handle, an eventfd on Linux and an event on Windows,
+    // which is signaled when the first event is pushed after a drain, or when a drain leaves events behind.
+    //
+    // It is a linked list rather than a ring, so it never drops events when the host falls behind.
+    // The price is an allocation per event on the pushing WebRTC thread. A node pool shared by the producers
+    // would need a lock or an ABA-safe stack, and the variable payload size defeats fixed-size nodes,
+    // while events are rare next to the frames and packets those threads already allocate for.
+    class EventQueue final
+    {
+    public:
+        EventQueue();
+        ~EventQueue();
+
+        DISALLOW_COPY_MOVE_ASSIGN(EventQueue);
+
+        // Copies the length bytes of data, when not null, and the text, each with a null terminator.
+        // Without data the data of the event is kept as is.
+        void Push(const PeerConnectionEvent& event, const void* data, size_t length, const char* text);
+
+        // Moves at most capacity events to the array, and returns the number of moved events.
+        // The data of the events stays valid until the next call. Concurrent calls are serialized.
+        int Drain(PeerConnectionEvent* events, int capacity);
+
+        // Waits until events might be available, or the timeout in milliseconds elapsed. A negative timeout waits forever.
+        bool Wait(int timeout_ms) const;
+
+        intptr_t handle() const;
+
+    private:
+        struct Node
+        {
+            std::atomic<Node*> next{ nullptr };
+            PeerConnectionEvent event{};
+        };
+
+        // Returns null when the queue is empty, or when a push is still linking its node, which sets is_pending.
+        Node* Pop(bool* is_pending);
+        void Link(Node* node);
+        void Signal();
+        void ResetSignal();
+        static void Free(Node* node);
+
+        // Producers swap their node into the head, the consumer pops from the tail.
+        // The stub node keeps the list non-empty, so producers never touch the tail.
+        std::atomic<Node*> head_;
+        Node* tail_;
+        Node stub_;
+
+        std::atomic<bool> is_signaled_{ false };
+
+        std::mutex drain_mutex_;
+        std::vector<Node*> drained_;
+
+#ifdef WEBRTC_WIN
+        HANDLE handle_;
+#else
+        int handle_;
+#endif
+    };
+} // namespace webrtc
@@ -0,0 +1,423 @@
+#include "pch.h"
+#include "H264Packetizer.h"
+#include "rtc_base/bit_buffer.h"
+
+#if defined(__AVX2__)
+#   include <immintrin.h>
+#   define H264_SCAN_AVX2
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   include <emmintrin.h>
+#   define H264_SCAN_SSE2
+#endif
+
+namespace webrtc
+{
+    namespace
+    {
+        // A start code must be followed by at least one byte, like H264::FindNaluIndices requires.
+        const size_t kStartCodeSize = 3;
+
+        // Key frames are several times larger than the average image.
+        const size_t kMaxToAverageImageSizeRatio = 8;
+        const size_t kMinEncodedImageSize = 128 * 1024;
+        const size_t kMinFragmentationCapacity = 16;
+
+        // Like H264BitstreamParser.
+        const int kMaxAbsQpDelta = 51;
+        const int kMinQp = 0;
+        const int kMaxQp = 51;
+
+        inline int CountTrailingZeros(uint32_t mask)
+        {
+#ifdef _MSC_VER
+            unsigned long index;
+            _BitScanForward(&index, mask);
+            return static_cast<int>(index);
+#else
+            return __builtin_ctz(mask);
+#endif
+        }
+
+        // Calls on_start_code with the offset of every 00 00 01 start code, in order.
+        // The vector loops compare the blocks at offsets 0, 1 and 2 to find all start codes that begin in a block.
+        template <typename Callback>
+        void ScanStartCodes(const uint8_t* data, size_t size, Callback&& on_start_code)
+        {
+            size_t i = 0;
+
+#ifdef H264_SCAN_AVX2
+            const auto zero32 = _mm256_setzero_si256();
+            const auto one32 = _mm256_set1_epi8(1);
+
+            for (; i + 32 + kStartCodeSize <= size; i += 32)
+            {
+                const auto b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+                const auto b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 1));
+                const auto b2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 2));
+
+                const auto matches = _mm256_and_si256(
+                    _mm256_and_si256(_mm256_cmpeq_epi8(b0, zero32), _mm256_cmpeq_epi8(b1, zero32)),
+                    _mm256_cmpeq_epi8(b2, one32));
+
+                auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(matches));
+                while (mask)
+                {
+                    on_start_code(i + CountTrailingZeros(mask));
+                    mask &= mask - 1;
+                }
+            }
+#endif
+
+#ifdef H264_SCAN_SSE2
+            const auto zero16 = _mm_setzero_si128();
+            const auto one16 = _mm_set1_epi8(1);
+
+            for (; i + 16 + kStartCodeSize <= size; i += 16)
+            {
+                const auto b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+                const auto b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 1));
+                const auto b2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 2));
+
+                const auto matches = _mm_and_si128(
+                    _mm_and_si128(_mm_cmpeq_epi8(b0, zero16), _mm_cmpeq_epi8(b1, zero16)),
+                    _mm_cmpeq_epi8(b2, one16));
+
+                auto mask = static_cast<uint32_t>(_mm_movemask_epi8(matches));
+                while (mask)
+                {
+                    on_start_code(i + CountTrailingZeros(mask));
+                    mask &= mask - 1;
+                }
+            }
+#endif
+
+            for (; i + kStartCodeSize < size; ++i)
+            {
+                if (data[i + 2] == 1 && data[i + 1] == 0 && data[i] == 0)
+                {
+                    on_start_code(i);
+                }
+            }
+        }
+    }
+
+    void FindH264NaluIndices(const uint8_t* data, size_t size, std::vector<H264::NaluIndex>* nal_indices)
+    {
+        nal_indices->clear();
+
+        ScanStartCodes(data, size, [&](size_t offset)
+        {
+            H264::NaluIndex index{ offset, offset + kStartCodeSize, 0 };
+
+            // Include the leading zero of a 4 byte start code.
+            if (offset > 0 && data[offset - 1] == 0)
+            {
+                --index.start_offset;
+            }
+
+            if (!nal_indices->empty())
+            {
+                auto& previous = nal_indices->back();
+                previous.payload_size = index.start_offset - previous.payload_start_offset;
+            }
+
+            nal_indices->push_back(index);
+        });
+
+        if (!nal_indices->empty())
+        {
+            auto& last = nal_indices->back();
+            last.payload_size = size - last.payload_start_offset;
+        }
+    }
+
+    size_t EstimateMaxEncodedImageSize(const VideoCodec& codec)
+    {
+        const size_t bitrate_bps = std::max(codec.maxBitrate, codec.startBitrate) * size_t{ 1000 };
+        const size_t average_size = bitrate_bps / 8 / std::max(1u, codec.maxFramerate);
+
+        // Never more than an uncompressed I420 image.
+        const size_t raw_size = CalcBufferSize(VideoType::kI420, codec.width, codec.height);
+        return std::min(raw_size, std::max(kMinEncodedImageSize, average_size * kMaxToAverageImageSizeRatio));
+    }
+
+    H264Packetizer::H264Packetizer()
+        : fragmentation_(std::make_unique<RTPFragmentationHeader>())
+    {
+    }
+
+    bool H264Packetizer::Packetize(const uint8_t* data, size_t size, EncodedImage* image)
+    {
+        FindH264NaluIndices(data, size, &nal_indices_);
+
+        const size_t nal_count = nal_indices_.size();
+        if (nal_count == 0)
+            return false;
+
+        if (nal_count > fragmentation_capacity_)
+        {
+            fragmentation_capacity_ = std::max({ nal_count, 2 * fragmentation_capacity_, kMinFragmentationCapacity });
+            fragmentation_ = std::make_unique<RTPFragmentationHeader>();
+            fragmentation_->VerifyAndAllocateFragmentationHeader(fragmentation_capacity_);
+        }
+
+        auto& fragmentation = *fragmentation_;
+        fragmentation.fragmentationVectorSize = static_cast<uint16_t>(nal_count);
+
+        bool is_key_frame = false;
+        const H264::NaluIndex* last_slice = nullptr;
+
+        for (size_t i = 0; i < nal_count; i++)
+        {
+            const auto& index = nal_indices_[i];
+            const auto nal_type = H264::ParseNaluType(data[index.payload_start_offset]);
+
+            fragmentation.fragmentationOffset[i] = index.payload_start_offset;
+            fragmentation.fragmentationLength[i] = index.payload_size;
+            fragmentation.fragmentationPlType[i] = nal_type;
+            fragmentation.fragmentationTimeDiff[i] = 0;
+
+            switch (nal_type)
+            {
+            case H264::NaluType::kSps:
+                sps_ = SpsParser::ParseSps(data + index.payload_start_offset + H264::kNaluTypeSize, index.payload_size - H264::kNaluTypeSize);
+                break;
+            case H264::NaluType::kPps:
+                pps_ = PpsParser::ParsePps(data + index.payload_start_offset + H264::kNaluTypeSize, index.payload_size - H264::kNaluTypeSize);
+                break;
+            case H264::NaluType::kIdr:
+                is_key_frame = true;
+                last_slice = &index;
+                break;
+            case H264::NaluType::kSlice:
+                last_slice = &index;
+                break;
+            default:
+                break;
+            }
+        }
+
+        // The QP of the image is the QP of its last slice, so the other slices need not be parsed.
+        if (last_slice)
+        {
+            ParseSliceQp(data + last_slice->payload_start_offset, last_slice->payload_size, &image->qp_);
+        }
+
+        image->_frameType = is_key_frame ? kVideoFrameKey : kVideoFrameDelta;
+        return true;
+    }
+
+    bool H264Packetizer::ParseSliceQp(const uint8_t* data, size_t size, int* qp)
+    {
+        if (!sps_ || !pps_ || size <= H264::kNaluTypeSize)
+            return false;
+
+        const bool is_idr = H264::ParseNaluType(data[0]) == H264::NaluType::kIdr;
+        const uint32_t nal_ref_idc = (data[0] & 0x60) >> 5;
+
+        // Remove the emulation prevention bytes, like H264::ParseRbsp.
+        size_t header_size = 0;
+        for (size_t i = H264::kNaluTypeSize; i < size && header_size < sizeof(slice_header_);)
+        {
+            if (size - i >= 3 && data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 3)
+            {
+                slice_header_[header_size++] = data[i++];
+
+                if (header_size < sizeof(slice_header_))
+                {
+                    slice_header_[header_size++] = data[i++];
+                }
+
+                ++i;
+            }
+            else
+            {
+                slice_header_[header_size++] = data[i++];
+            }
+        }
+
+        rtc::BitBuffer reader(slice_header_, header_size);
+        uint32_t golomb;
+        uint32_t bits;
+
+#define READ_OR_FAIL(read) do { if (!(read)) return false; } while (false)
+
+        // first_mb_in_slice
+        READ_OR_FAIL(reader.ReadExponentialGolomb(&golomb));
+
+        // Types 5 to 9 mean all slices of the picture have the same type.
+        uint32_t slice_type;
+        READ_OR_FAIL(reader.ReadExponentialGolomb(&slice_type));
+        slice_type %= 5;
+
+        // pic_parameter_set_id
+        READ_OR_FAIL(reader.ReadExponentialGolomb(&golomb));
+
+        if (sps_->separate_colour_plane_flag == 1)
+        {
+            // colour_plane_id
+            READ_OR_FAIL(reader.ReadBits(&bits, 2));
+        }
+
+        // frame_num
+        READ_OR_FAIL(reader.ReadBits(&bits, sps_->log2_max_frame_num));
+
+        uint32_t field_pic_flag = 0;
+        if (sps_->frame_mbs_only_flag == 0)
+        {
+            READ_OR_FAIL(reader.ReadBits(&field_pic_flag, 1));
+
+            if (field_pic_flag != 0)
+            {
+                // bottom_field_flag
+                READ_OR_FAIL(reader.ReadBits(&bits, 1));
+            }
+        }
+
+        if (is_idr)
+        {
+            // idr_pic_id
+            READ_OR_FAIL(reader.ReadExponentialGolomb(&golomb));
+        }
+
+        if (sps_->pic_order_cnt_type == 0)
+        {
+            // pic_order_cnt_lsb
+            READ_OR_FAIL(reader.ReadBits(&bits, sps_->log2_max_pic_order_cnt_lsb));
+
+            if (pps_->bottom_field_pic_order_in_frame_present_flag && field_pic_flag == 0)
+            {
+                // delta_pic_order_cnt_bottom
+                READ_OR_FAIL(reader.ReadExponentialGolomb(&golomb));
+            }
+        }
+
+        if (sps_->pic_order_cnt_type == 1 && !sps_->delta_pic_order_always_zero_flag)
+        {
+            // delta_pic_order_cnt[0] and [1]
+            READ_OR_FAIL(reader.ReadExponentialGolomb(&golomb));
+
+            if (pps_->bottom_field_pic_order_in_frame_present_flag && field_pic_flag == 0)
+            {
+                READ_OR_FAIL(reader.ReadExponentialGolomb(&golomb));
+            }
+        }
+
+        if (pps_->redundant_pic_cnt_present_flag)
+        {
+            // redundant_pic_cnt
+            READ_OR_FAIL(reader.ReadExponentialGolomb(&golomb));
+        }
+
+        if (slice_type == H264::SliceType::kB)
+        {
+            // direct_spatial_mv_pred_flag
+            READ_OR_FAIL(reader.ReadBits(&bits, 1));
+        }
+
+        if (slice_type == H264::SliceType::kP || slice_type == H264::SliceType::kB || slice_type == H264::SliceType::kSp)
+        {
+            uint32_t num_ref_idx_active_override_flag;
+            READ_OR_FAIL(reader.ReadBits(&num_ref_idx_active_override_flag, 1));
+
+            if (num_ref_idx_active_override_flag != 0)
+            {
+                // num_ref_idx_l0_active_minus1 and num_ref_idx_l1_active_minus1
+                READ_OR_FAIL(reader.ReadExponentialGolomb(&golomb));
+
+                if (slice_type == H264::SliceType::kB)
+                {
+                    READ_OR_FAIL(reader.ReadExponentialGolomb(&golomb));
+                }
+            }
+        }
+
+        // ref_pic_list_modification, for list 0 unless I or SI, and for list 1 when B.
+        const int list_count = slice_type == H264::SliceType::kI || slice_type == H264::SliceType::kSi ? 0
+            : slice_type == H264::SliceType::kB ? 2 : 1;
+
+        for (int list = 0; list < list_count; ++list)
+        {
+            uint32_t ref_pic_list_modification_flag;
+            READ_OR_FAIL(reader.ReadBits(&ref_pic_list_modification_flag, 1));
+
+            if (ref_pic_list_modification_flag)
+            {
+                uint32_t modification_of_pic_nums_idc;
+                do
+                {
+                    READ_OR_FAIL(reader.ReadExponentialGolomb(&modification_of_pic_nums_idc));
+
+                    if (modification_of_pic_nums_idc <= 2)
+                    {
+                        // abs_diff_pic_num_minus1 or long_term_pic_num
+                        READ_OR_FAIL(reader.ReadExponentialGolomb(&golomb));
+                    }
+                } while (modification_of_pic_nums_idc != 3);
+            }
+        }
+
+        // pred_weight_table is not supported, like H264BitstreamParser.
+        if ((pps_->weighted_pred_flag && (slice_type == H264::SliceType::kP || slice_type == H264::SliceType::kSp)) ||
+            (pps_->weighted_bipred_idc == 1 && slice_type == H264::SliceType::kB))
+            return false;
+
+        if (nal_ref_idc != 0)
+        {
+            // dec_ref_pic_marking
+            if (is_idr)
+            {
+                // no_output_of_prior_pics_flag and long_term_reference_flag
+                READ_OR_FAIL(reader.ReadBits(&bits, 2));
+            }
+            else
+            {
+                uint32_t adaptive_ref_pic_marking_mode_flag;
+                READ_OR_FAIL(reader.ReadBits(&adaptive_ref_pic_marking_mode_flag, 1));
+
+                if (adaptive_ref_pic_marking_mode_flag)
+                {
+                    uint32_t memory_management_control_operation;
+                    do
+                    {
+                        READ_OR_FAIL(reader.ReadExponentialGolomb(&memory_management_control_operation));
+
+                        // Operation 3 has two arguments, the others at most one.
+                        if (memory_management_control_operation == 3)
+                        {
+                            READ_OR_FAIL(reader.ReadExponentialGolomb(&golomb));
+                        }
+
+                        if (memory_management_control_operation != 0 && memory_management_control_operation != 5)
+                        {
+                            READ_OR_FAIL(reader.ReadExponentialGolomb(&golomb));
+                        }
+                    } while (memory_management_control_operation != 0);
+                }
+            }
+        }
+
+        if (pps_->entropy_coding_mode_flag && slice_type != H264::SliceType::kI && slice_type != H264::SliceType::kSi)
+        {
+            // cabac_init_idc
+            READ_OR_FAIL(reader.ReadExponentialGolomb(&golomb));
+        }
+
+        int32_t slice_qp_delta;
+        READ_OR_FAIL(reader.ReadSignedExponentialGolomb(&slice_qp_delta));
+
+#undef READ_OR_FAIL
+
+        if (std::abs(slice_qp_delta) > kMaxAbsQpDelta)
+            return false;
+
+        const auto slice_qp = 26 + pps_->pic_init_qp_minus26 + slice_qp_delta;
+        if (slice_qp < kMinQp || slice_qp > kMaxQp)
+            return false;
+
+        *qp = slice_qp;
+        return true;
+    }
+} // namespace webrtc
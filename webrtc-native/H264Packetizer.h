@@ -0,0 +1,51 @@
+#pragma once
+#include "macros.h"
+
+namespace webrtc
+{
+    // Finds the NAL units of an Annex B H.264 bitstream like H264::FindNaluIndices,
+    // but scans for start codes 16 (SSE2) or 32 (AVX2) bytes at a time.
+    void FindH264NaluIndices(const uint8_t* data, size_t size, std::vector<H264::NaluIndex>* nal_indices);
+
+    // Estimates the size of the largest images an encoder produces, from its maximum bitrate and frame rate.
+    // Encoders reserve this much for their output buffer, which grows when a larger image is produced.
+    size_t EstimateMaxEncodedImageSize(const VideoCodec& codec);
+
+    // Prepares the encoded images of an encoder for the RTP packetizer in a single pass over the bitstream,
+    // instead of scanning it once for the fragmentation and once more for the QP.
+    // Keeps the last parameter sets, so every encoder needs its own packetizer.
+    // The fragmentation header and slice buffers are reused, so once they are large enough packetizing only allocates
+    // to parse parameter sets, which encoders only send with key frames.
+    class H264Packetizer final
+    {
+    public:
+        H264Packetizer();
+        ~H264Packetizer() = default;
+
+        DISALLOW_COPY_MOVE_ASSIGN(H264Packetizer);
+
+        // Describes the NAL units of the bitstream in the fragmentation header, and sets the frame type
+        // and QP of the image. The QP is left unchanged when the slice header cannot be parsed.
+        // Returns false when the bitstream has no NAL units.
+        bool Packetize(const uint8_t* data, size_t size, EncodedImage* image);
+
+        // The fragmentation of the last packetized bitstream, valid until the next one is packetized.
+        const RTPFragmentationHeader& fragmentation() const { return *fragmentation_; }
+
+    private:
+        // Parses the slice header up to the QP like H264BitstreamParser, which copies every slice to a new buffer.
+        // Only the start of the slice is unescaped, the QP comes before the slice data.
+        bool ParseSliceQp(const uint8_t* data, size_t size, int* qp);
+
+        absl::optional<SpsParser::SpsState> sps_;
+        absl::optional<PpsParser::PpsState> pps_;
+        uint8_t slice_header_[256];
+
+        std::vector<H264::NaluIndex> nal_indices_;
+
+        // The header only allocates when its vector size grows, and has no separate capacity.
+        // It is replaced when more NAL units are needed, so its vector size can be set to the number used.
+        std::unique_ptr<RTPFragmentationHeader> fragmentation_;
+        size_t fragmentation_capacity_ = 0;
+    };
+} // namespace webrtc
@@ -0,0 +1,85 @@
+#include "pch.h"
+#include "LatencyHistogram.h"
+
+namespace webrtc
+{
+    void LatencyHistogram::Record(int64_t latency_us)
+    {
+        latency_us = std::max<int64_t>(0, latency_us);
+
+        buckets_[GetBucketIndex(latency_us)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_us_.fetch_add(latency_us, std::memory_order_relaxed);
+
+        auto max_us = max_us_.load(std::memory_order_relaxed);
+        while (latency_us > max_us && !max_us_.compare_exchange_weak(max_us, latency_us, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    void LatencyHistogram::GetSnapshot(LatencyHistogramSnapshot* snapshot, bool reset)
+    {
+        int64_t counts[kBucketCount];
+        int64_t total = 0;
+
+        for (int i = 0; i < kBucketCount; ++i)
+        {
+            counts[i] = reset
+                ? buckets_[i].exchange(0, std::memory_order_relaxed)
+                : buckets_[i].load(std::memory_order_relaxed);
+
+            total += counts[i];
+        }
+
+        snapshot->count = reset ? count_.exchange(0) : count_.load();
+        snapshot->sum_us = reset ? sum_us_.exchange(0) : sum_us_.load();
+        snapshot->max_us = reset ? max_us_.exchange(0) : max_us_.load();
+
+        // Use the upper bound of the bucket holding the percentile, but never report more than the maximum.
+        const auto percentile = [&](int per_mille)
+        {
+            const auto rank = (total * per_mille + 999) / 1000;
+            int64_t cumulative = 0;
+
+            for (int i = 0; i < kBucketCount; ++i)
+            {
+                cumulative += counts[i];
+                if (cumulative >= rank && cumulative > 0)
+                    return std::min(GetBucketUpperBound(i), snapshot->max_us);
+            }
+
+            return int64_t{ 0 };
+        };
+
+        snapshot->p50_us = percentile(500);
+        snapshot->p90_us = percentile(900);
+        snapshot->p99_us = percentile(990);
+    }
+
+    int LatencyHistogram::GetBucketIndex(int64_t latency_us)
+    {
+        if (latency_us < kLinearBucketCount)
+            return static_cast<int>(latency_us);
+
+        int msb = 4;
+        while (msb < 62 && (latency_us >> (msb + 1)) != 0)
+            ++msb;
+
+        const auto sub_bucket = static_cast<int>(latency_us >> (msb - kSubBucketBits)) & ((1 << kSubBucketBits) - 1);
+        const auto index = kLinearBucketCount + ((msb - 4) << kSubBucketBits) + sub_bucket;
+        return std::min(index, kBucketCount - 1);
+    }
+
+    int64_t LatencyHistogram::GetBucketUpperBound(int index)
+    {
+        if (index < kLinearBucketCount)
+            return index;
+
+        if (index == kBucketCount - 1)
+            return std::numeric_limits<int64_t>::max();
+
+        const auto msb = 4 + ((index - kLinearBucketCount) >> kSubBucketBits);
+        const auto sub_bucket = (index - kLinearBucketCount) & ((1 << kSubBucketBits) - 1);
+        return (int64_t{ (1 << kSubBucketBits) + sub_bucket + 1 } << (msb - kSubBucketBits)) - 1;
+    }
+} // namespace webrtc
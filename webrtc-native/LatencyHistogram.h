@@ -0,0 +1,40 @@
+#pragma once
+#include "macros.h"
+#include "NativeInterface.h"
+
+namespace webrtc
+{
+    // A lock-free histogram of latencies in microseconds, with fixed logarithmic buckets.
+    // Latencies below 16us get their own bucket, larger ones are binned in 4 buckets per power of two,
+    // so percentiles are accurate within 25%. Values can be recorded from any thread.
+    class LatencyHistogram final
+    {
+    public:
+        LatencyHistogram() = default;
+        ~LatencyHistogram() = default;
+
+        DISALLOW_COPY_MOVE_ASSIGN(LatencyHistogram);
+
+        void Record(int64_t latency_us);
+
+        // Values recorded while taking the snapshot might only be partially included.
+        void GetSnapshot(LatencyHistogramSnapshot* snapshot, bool reset);
+
+        // The last bucket holds all larger latencies.
+        static constexpr int kBucketCount = 112;
+
+        static int GetBucketIndex(int64_t latency_us);
+
+        // The largest latency that falls in the bucket.
+        static int64_t GetBucketUpperBound(int index);
+
+    private:
+        static constexpr int kLinearBucketCount = 16;
+        static constexpr int kSubBucketBits = 2;
+
+        std::atomic<int64_t> buckets_[kBucketCount]{};
+        std::atomic<int64_t> count_{ 0 };
+        std::atomic<int64_t> sum_us_{ 0 };
+        std::atomic<int64_t> max_us_{ 0 };
+    };
+} // namespace webrtc
@@ -0,0 +1,109 @@
+#pragma once
+#include <cstdint>
+#include "NativeInterface.h"
+
+// The functions exported by webrtc-native, which the .NET wrapper imports in Native.cs.
+// NativeInterface.cpp includes this header, so the compiler checks these declarations against the definitions.
+
+#if defined(WEBRTC_WIN)
+#   define WEBRTC_PLUGIN_API __declspec(dllexport)
+#else
+#   define WEBRTC_PLUGIN_API __attribute__((visibility("default")))
+#endif
+
+class PeerConnection;
+
+extern "C"
+{
+    WEBRTC_PLUGIN_API bool PumpQueuedMessages(int timeoutInMS);
+
+    WEBRTC_PLUGIN_API bool Configure(
+        bool use_signaling_thread,
+        bool use_worker_thread,
+        bool force_software_video_encoder,
+        bool auto_shutdown,
+        bool use_fake_encoders,
+        bool use_fake_decoders,
+        int yuv_conversion_thread_count,
+        int software_encoder_thread_count,
+        bool allow_loopback_network,
+        bool use_network_thread,
+        int factory_count,
+        FactoryAssignment factory_assignment,
+        bool log_to_stderr,
+        bool log_to_debug,
+        LogSink log_sink,
+        // A value of rtc::LoggingSeverity.
+        int minimum_logging_severity);
+
+    WEBRTC_PLUGIN_API bool CanEncodeHardwareTextures();
+    WEBRTC_PLUGIN_API bool HasFactory();
+    WEBRTC_PLUGIN_API bool Shutdown();
+
+    WEBRTC_PLUGIN_API PeerConnection* CreatePeerConnection(
+        const char** ice_url_array, const int ice_url_count,
+        const char* ice_username, const char* ice_password,
+        bool can_receive_audio, bool can_receive_video,
+        bool is_dtls_srtp_enabled);
+
+    WEBRTC_PLUGIN_API void ClosePeerConnection(PeerConnection* connection);
+    WEBRTC_PLUGIN_API int AddVideoTrack(PeerConnection* connection, const char* label, int min_bps, int max_bps, int max_fps);
+    WEBRTC_PLUGIN_API int AddDataChannel(PeerConnection* connection, const char* label, bool is_ordered, bool is_reliable);
+    WEBRTC_PLUGIN_API bool RemoveDataChannel(PeerConnection* connection, const char* label);
+    WEBRTC_PLUGIN_API bool RemoveDataChannelById(PeerConnection* connection, int channelId);
+    WEBRTC_PLUGIN_API void GetEncoderTiming(LatencyHistogramSnapshot* snapshot, bool reset);
+    WEBRTC_PLUGIN_API bool RequestStats(PeerConnection* connection);
+    WEBRTC_PLUGIN_API int GetStats(PeerConnection* connection, StatsEntry* entries, int capacity, int64_t* timestampUs);
+    WEBRTC_PLUGIN_API int GetStatsJson(PeerConnection* connection, char* buffer, int capacity);
+    WEBRTC_PLUGIN_API bool CreateOffer(PeerConnection* connection);
+    WEBRTC_PLUGIN_API bool CreateAnswer(PeerConnection* connection);
+    WEBRTC_PLUGIN_API bool SendData(PeerConnection* connection, const char* label, const uint8_t* data, int length, bool is_binary);
+    WEBRTC_PLUGIN_API int SendDataBatch(PeerConnection* connection, const DataMessageDescriptor* messages, int count, uint8_t* results);
+    WEBRTC_PLUGIN_API bool ConfigureDataChannelChunking(PeerConnection* connection, int channelId, int chunkSize);
+    WEBRTC_PLUGIN_API bool ConfigureDataChannelMaxMessageSize(PeerConnection* connection, int channelId, int maxMessageSize);
+    WEBRTC_PLUGIN_API bool ConfigureDataChannelCompression(PeerConnection* connection, int channelId, bool isEnabled, int level, int threshold);
+    WEBRTC_PLUGIN_API bool GetDataChannelStats(PeerConnection* connection, int channelId, DataChannelStats* stats);
+    WEBRTC_PLUGIN_API int64_t GetDataChannelBufferedAmount(PeerConnection* connection, int channelId);
+    WEBRTC_PLUGIN_API bool ConfigureDataChannelBuffering(PeerConnection* connection, int channelId, int64_t lowWaterMark, int64_t highWaterMark);
+    WEBRTC_PLUGIN_API bool SendDataById(PeerConnection* connection, int channelId, const uint8_t* data, int length, bool is_binary);
+    WEBRTC_PLUGIN_API bool SendVideoFrame(PeerConnection* connection, int trackId, const uint8_t* pixels, int stride, int width, int height, VideoFrameFormat format);
+
+    WEBRTC_PLUGIN_API bool SendVideoFrameYuv(PeerConnection* connection, int trackId,
+        const uint8_t* dataY, const uint8_t* dataU, const uint8_t* dataV,
+        int strideY, int strideU, int strideV,
+        int width, int height, VideoFrameFormat format);
+
+    WEBRTC_PLUGIN_API bool ConfigureVideoTrackQueue(PeerConnection* connection, int trackId, int queueDepth, VideoFrameDropPolicy dropPolicy);
+    WEBRTC_PLUGIN_API bool SetVideoTrackDeferredConversion(PeerConnection* connection, int trackId, bool isDeferred);
+    WEBRTC_PLUGIN_API bool GetVideoTrackStats(PeerConnection* connection, int trackId, VideoTrackStats* stats);
+    WEBRTC_PLUGIN_API bool GetVideoTrackLatency(PeerConnection* connection, int trackId, VideoTrackLatency* latency, bool reset);
+    WEBRTC_PLUGIN_API bool SetAudioControl(PeerConnection* connection, bool is_mute, bool is_record);
+    WEBRTC_PLUGIN_API bool SetRemoteDescription(PeerConnection* connection, const char* type, const char* sdp);
+
+    WEBRTC_PLUGIN_API bool AddIceCandidate(PeerConnection* connection, const char* candidate, const int sdp_mlineindex,
+        const char* sdp_mid);
+
+    WEBRTC_PLUGIN_API bool RegisterLocalVideoFrameReady(PeerConnection* connection, IncomingVideoFrameCallback callback);
+    WEBRTC_PLUGIN_API bool RegisterRemoteVideoFrameReceived(PeerConnection* connection, IncomingVideoFrameCallback callback);
+    WEBRTC_PLUGIN_API bool SetRemoteVideoFrameOptions(PeerConnection* connection, VideoFrameFormat format, int width, int height);
+    WEBRTC_PLUGIN_API int GetRemoteVideoTrackId(PeerConnection* connection, const char* transceiver_mid);
+    WEBRTC_PLUGIN_API bool RegisterOnLocalDataChannelReady(PeerConnection* connection, LocalDataChannelReadyCallback callback);
+    WEBRTC_PLUGIN_API bool RegisterOnDataFromDataChannelReady(PeerConnection* connection, DataAvailableCallback callback);
+    WEBRTC_PLUGIN_API bool RegisterOnDataBufferAvailable(PeerConnection* connection, DataBufferAvailableCallback callback);
+    WEBRTC_PLUGIN_API bool RegisterOnStatsReady(PeerConnection* connection, StatsReadyCallback callback);
+    WEBRTC_PLUGIN_API bool RegisterOnDataChannelBufferedAmountLow(PeerConnection* connection, DataChannelBufferedAmountLowCallback callback);
+    WEBRTC_PLUGIN_API void ReleaseDataBuffer(void* buffer);
+    WEBRTC_PLUGIN_API bool RegisterOnFailure(PeerConnection* connection, FailureCallback callback);
+    WEBRTC_PLUGIN_API bool RegisterOnAudioBusReady(PeerConnection* connection, AudioBusReadyCallback callback);
+    WEBRTC_PLUGIN_API bool RegisterOnLocalSdpReadyToSend(PeerConnection* connection, LocalSdpReadyToSendCallback callback);
+    WEBRTC_PLUGIN_API bool RegisterOnIceCandidateReadyToSend(PeerConnection* connection, IceCandidateReadyToSendCallback callback);
+    WEBRTC_PLUGIN_API bool RegisterSignalingStateChanged(PeerConnection* connection, StateChangedCallback callback);
+    WEBRTC_PLUGIN_API bool RegisterConnectionStateChanged(PeerConnection* connection, StateChangedCallback callback);
+    WEBRTC_PLUGIN_API bool RegisterVideoFrameProcessed(PeerConnection* connection, VideoFrameProcessedCallback callback);
+    WEBRTC_PLUGIN_API bool RegisterRemoteTrackChanged(PeerConnection* connection, RemoteTrackChangedCallback callback);
+    WEBRTC_PLUGIN_API bool SetEventQueueEnabled(PeerConnection* connection, bool is_enabled, int64_t tag);
+    WEBRTC_PLUGIN_API int DrainEvents(PeerConnectionEvent* events, int capacity);
+    WEBRTC_PLUGIN_API bool WaitForEvents(int timeout_ms);
+    WEBRTC_PLUGIN_API intptr_t GetEventQueueHandle();
+    WEBRTC_PLUGIN_API int64_t GetRealtimeClockTimeInMicroseconds();
+}
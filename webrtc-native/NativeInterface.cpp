@@ -1,36 +1,69 @@
 #include "pch.h"
+#include "NativeExports.h"
 #include "PeerConnection.h"
 #include "NvEncoderH264.h"
 #include "EncoderFactory.h"
 
-#if defined(WEBRTC_WIN)
-#   define WEBRTC_PLUGIN_API __declspec(dllexport)
-#elif 
-#   define WEBRTC_PLUGIN_API __attribute__((visibility("default")))
-#endif
-
 namespace
 {
     // TODO: Bundle these globals in a PeerConnectionBuilder class!
     bool g_auto_shutdown = true;
     bool g_use_worker_thread = true;
     bool g_use_signaling_thread = true;
+
+    // Without a network thread, the worker thread also sends and receives the packets.
+    bool g_use_network_thread = false;
     bool g_force_software_encoder = false;
 
     // For unit testing.
     bool g_use_fake_encoders = false;
     bool g_use_fake_decoders = false;
 
+    // The number of threads that convert RGBA frames to I420, 1 converts on the calling thread only.
+    int g_yuv_conversion_thread_count = 1;
+
+    // The number of threads of the software H.264 encoder, 0 uses the number of cores.
+    int g_software_encoder_thread_count = 0;
+
+    // Also gather ICE candidates on the loopback interface, libwebrtc ignores it by default.
+    bool g_allow_loopback_network = false;
+
     LogSink g_log_sink = nullptr;
 
     rtc::LoggingSeverity g_minimum_logging_severity = rtc::LS_INFO;
 
+    // How new peer connections are spread over the factories.
+    FactoryAssignment g_factory_assignment = FactoryAssignment::RoundRobin;
+
     rtc::CriticalSection g_lock;
 
-    webrtc::PeerConnectionFactoryInterface* g_peer_connection_factory = nullptr;
+    // A peer connection factory with its own threads.
+    // Each thread handles the connections of one factory only, so more factories scale the connections over more cores.
+    struct FactoryShard
+    {
+        webrtc::PeerConnectionFactoryInterface* factory = nullptr;
+
+        std::unique_ptr<rtc::Thread> network_thread;
+        std::unique_ptr<rtc::Thread> worker_thread;
+        std::unique_ptr<rtc::Thread> signaling_thread;
+
+        // The number of open peer connections of the factory.
+        int connection_count = 0;
+    };
+
+    // Only resized by Configure, when none of the factories has threads.
+    std::vector<FactoryShard> g_factories(1);
+
+    size_t g_next_factory_index = 0;
+
+    // Shared by all factories, created with the first one and released with the last one.
+    std::shared_ptr<webrtc::YuvConverter> g_yuv_converter;
+
+    // Shared by all encoders, kept when the factory is recreated.
+    const std::shared_ptr<webrtc::LatencyHistogram> g_encode_timing = std::make_shared<webrtc::LatencyHistogram>();
 
-    std::unique_ptr<rtc::Thread> g_worker_thread;
-    std::unique_ptr<rtc::Thread> g_signaling_thread;
+    // Shared by all peer connections that have the event queue enabled, so the host drains the events of all of them at once.
+    webrtc::EventQueue g_event_queue;
 
     void startThread(std::unique_ptr<rtc::Thread>& thread, bool isUsed)
     {
@@ -67,15 +100,50 @@ namespace
         }
     }
 
-    webrtc::PeerConnectionFactoryInterface* acquireFactory()
+    FactoryShard& selectFactory()
+    {
+        rtc::CritScope scope(&g_lock);
+
+        if (g_factory_assignment == FactoryAssignment::LeastLoaded)
+        {
+            return *std::min_element(g_factories.begin(), g_factories.end(), [](const FactoryShard& a, const FactoryShard& b)
+            {
+                return a.connection_count < b.connection_count;
+            });
+        }
+
+        auto& shard = g_factories[g_next_factory_index % g_factories.size()];
+        g_next_factory_index = (g_next_factory_index + 1) % g_factories.size();
+        return shard;
+    }
+
+    FactoryShard* findFactory(const webrtc::PeerConnectionFactoryInterface* factory)
+    {
+        rtc::CritScope scope(&g_lock);
+
+        for (auto& shard : g_factories)
+        {
+            if (shard.factory == factory)
+                return &shard;
+        }
+
+        return nullptr;
+    }
+
+    webrtc::PeerConnectionFactoryInterface* acquireFactory(FactoryShard& shard)
     {
-        // Create global factory if needed
+        // Create the factory if needed
         rtc::CritScope scope(&g_lock);
 
-        if (g_peer_connection_factory == nullptr)
+        if (shard.factory == nullptr)
         {
-            startThread(g_signaling_thread, g_use_signaling_thread);
-            startThread(g_worker_thread, g_use_worker_thread);
+            startThread(shard.signaling_thread, g_use_signaling_thread);
+            startThread(shard.worker_thread, g_use_worker_thread);
+
+            if (g_use_network_thread)
+            {
+                startThread(shard.network_thread, true);
+            }
 
             // TODO: Support fake audio codec factories. Currently we do not support audio at all.
             const auto audio_encoder_factory = webrtc::CreateBuiltinAudioEncoderFactory();
@@ -88,9 +156,11 @@ namespace
             }
             else
             {
-                video_encoder_factory = CreateEncoderFactory(g_force_software_encoder);
+                video_encoder_factory = CreateEncoderFactory(g_force_software_encoder, g_software_encoder_thread_count);
             }
 
+            video_encoder_factory = CreateTrackingEncoderFactory(std::move(video_encoder_factory), g_encode_timing);
+
             // TODO: Add NVDEC hardware decoder
             std::unique_ptr<webrtc::VideoDecoderFactory> video_decoder_factory;
             if (g_use_fake_decoders)
@@ -107,9 +177,9 @@ namespace
             const std::nullptr_t audio_processing = nullptr;
 
             auto factory = CreatePeerConnectionFactory(
-                g_worker_thread.get(),
-                g_worker_thread.get(),
-                g_signaling_thread.get(),
+                shard.network_thread ? shard.network_thread.get() : shard.worker_thread.get(),
+                shard.worker_thread.get(),
+                shard.signaling_thread.get(),
                 default_adm,
                 audio_encoder_factory,
                 audio_decoder_factory,
@@ -118,36 +188,60 @@ namespace
                 audio_mixer,
                 audio_processing);
 
-            g_peer_connection_factory = std::move(factory);
-            g_peer_connection_factory->AddRef();
+            shard.factory = std::move(factory);
+            shard.factory->AddRef();
+
+            if (g_allow_loopback_network)
+            {
+                webrtc::PeerConnectionFactoryInterface::Options options;
+                options.network_ignore_mask &= ~rtc::ADAPTER_TYPE_LOOPBACK;
+                shard.factory->SetOptions(options);
+            }
+
+            if (!g_yuv_converter)
+            {
+                g_yuv_converter = std::make_shared<webrtc::YuvConverter>(g_yuv_conversion_thread_count);
+            }
         }
         else if (g_auto_shutdown)
         {
-            g_peer_connection_factory->AddRef();
+            shard.factory->AddRef();
         }
 
-        return g_peer_connection_factory;
+        return shard.factory;
     }
 
-    bool releaseFactory(bool should_release = g_auto_shutdown)
+    bool releaseFactory(FactoryShard& shard, bool should_release = g_auto_shutdown)
     {
         // Release the factory on last destruction if auto-shutdown is enabled
         rtc::CritScope scope(&g_lock);
 
-        if (should_release && g_peer_connection_factory)
+        if (should_release && shard.factory)
         {
-            const auto status = g_peer_connection_factory->Release();
+            const auto status = shard.factory->Release();
 
             if (status == rtc::RefCountReleaseStatus::kDroppedLastRef)
             {
-                g_peer_connection_factory = nullptr;
-                stopThread(g_signaling_thread, g_use_signaling_thread);
-                stopThread(g_worker_thread, g_use_signaling_thread);
+                shard.factory = nullptr;
+                stopThread(shard.signaling_thread, g_use_signaling_thread);
+                stopThread(shard.worker_thread, g_use_worker_thread);
+                stopThread(shard.network_thread, true);
+
+                const auto has_factory = std::any_of(g_factories.begin(), g_factories.end(), [](const FactoryShard& other)
+                {
+                    return other.factory != nullptr;
+                });
+
+                if (!has_factory)
+                {
+                    g_yuv_converter = nullptr;
+                }
+
                 return true;
             }
         }
 
-        return g_peer_connection_factory == nullptr;
+        return shard.factory == nullptr;
     }
 
     class ModuleInitializer : public rtc::LogSink
@@ -244,23 +338,47 @@ extern "C"
         bool auto_shutdown,
         bool use_fake_encoders,
         bool use_fake_decoders,
+        int yuv_conversion_thread_count,
+        int software_encoder_thread_count,
+        bool allow_loopback_network,
+        bool use_network_thread,
+        int factory_count,
+        FactoryAssignment factory_assignment,
         bool log_to_stderr,
         bool log_to_debug,
         LogSink log_sink,
-        rtc::LoggingSeverity minimum_logging_severity)
+        int minimum_logging_severity)
     {
         rtc::CritScope scope(&g_lock);
 
         initializeModule();
 
-        if (g_worker_thread || g_signaling_thread)
+        // Without their own threads, all factories would share the thread calling into them.
+        if (factory_count > 1 && (!use_signaling_thread || !use_worker_thread))
+        {
+            RTC_LOG(LS_ERROR) << __FUNCTION__ << ": multiple factories need their own signaling and worker threads";
+            return false;
+        }
+
+        const auto has_threads = std::any_of(g_factories.begin(), g_factories.end(), [](const FactoryShard& shard)
+        {
+            return shard.worker_thread || shard.signaling_thread;
+        });
+
+        if (has_threads)
         {
             if (g_use_signaling_thread != use_signaling_thread ||
                 g_use_worker_thread != use_worker_thread ||
                 g_force_software_encoder != force_software_video_encoder ||
                 g_auto_shutdown != auto_shutdown ||
                 g_use_fake_decoders != use_fake_decoders ||
-                g_use_fake_encoders != use_fake_encoders)
+                g_use_fake_encoders != use_fake_encoders ||
+                g_yuv_conversion_thread_count != std::max(1, yuv_conversion_thread_count) ||
+                g_software_encoder_thread_count != std::max(0, software_encoder_thread_count) ||
+                g_allow_loopback_network != allow_loopback_network ||
+                g_use_network_thread != use_network_thread ||
+                g_factories.size() != static_cast<size_t>(std::max(1, factory_count)) ||
+                g_factory_assignment != factory_assignment)
             {
                 RTC_LOG(LS_ERROR) << __FUNCTION__ << " must be called once, before creating the first peer connection";
                 return false;
@@ -275,30 +393,56 @@ extern "C"
         g_auto_shutdown = auto_shutdown;
         g_use_fake_decoders = use_fake_decoders;
         g_use_fake_encoders = use_fake_encoders;
+        g_yuv_conversion_thread_count = std::max(1, yuv_conversion_thread_count);
+        g_software_encoder_thread_count = std::max(0, software_encoder_thread_count);
+        g_allow_loopback_network = allow_loopback_network;
+        g_use_network_thread = use_network_thread;
+        g_factory_assignment = factory_assignment;
+
+        g_factories.clear();
+        g_factories.resize(std::max(1, factory_count));
+        g_next_factory_index = 0;
 
         g_log_sink = log_sink;
-        g_minimum_logging_severity = minimum_logging_severity;
+        g_minimum_logging_severity = static_cast<rtc::LoggingSeverity>(minimum_logging_severity);
 
         rtc::LogMessage::SetLogToStderr(log_to_stderr);
-        rtc::LogMessage::LogToDebug(log_to_debug ? minimum_logging_severity : rtc::LS_NONE);
+        rtc::LogMessage::LogToDebug(log_to_debug ? g_minimum_logging_severity : rtc::LS_NONE);
 
         return true;
     }
 
     WEBRTC_PLUGIN_API bool CanEncodeHardwareTextures()
     {
+#ifdef HAS_NVENC
         return webrtc::NvEncoderH264::IsAvailable();
+#else
+        return false;
+#endif
     }
 
     WEBRTC_PLUGIN_API bool HasFactory()
     {
         rtc::CritScope scope(&g_lock);
-        return g_peer_connection_factory;
+
+        return std::any_of(g_factories.begin(), g_factories.end(), [](const FactoryShard& shard)
+        {
+            return shard.factory != nullptr;
+        });
     }
 
     WEBRTC_PLUGIN_API bool Shutdown()
     {
-        return releaseFactory(true);
+        rtc::CritScope scope(&g_lock);
+
+        bool is_shut_down = true;
+
+        for (auto& shard : g_factories)
+        {
+            is_shut_down &= releaseFactory(shard, true);
+        }
+
+        return is_shut_down;
     }
 
     WEBRTC_PLUGIN_API PeerConnection* CreatePeerConnection(
@@ -311,11 +455,13 @@ extern "C"
 
         initializeModule();
 
-        auto factory = acquireFactory();
+        auto& shard = selectFactory();
+
+        auto factory = acquireFactory(shard);
         if (!factory)
             return nullptr;
 
-        auto connection = new PeerConnection(factory,
+        auto connection = new PeerConnection(factory, g_use_signaling_thread ? shard.signaling_thread.get() : nullptr, g_yuv_converter,
             ice_url_array, ice_url_count,
             ice_username, ice_password,
             can_receive_audio, can_receive_video,
@@ -324,10 +470,12 @@ extern "C"
         if (!connection->created())
         {
             delete connection;
-            releaseFactory();
-            connection = nullptr;
+            releaseFactory(shard);
+            return nullptr;
         }
 
+        ++shard.connection_count;
+
         return connection;
     }
 
@@ -335,8 +483,16 @@ extern "C"
     {
         if (connection)
         {
+            const auto shard = findFactory(connection->factory().get());
+
             delete connection;
-            releaseFactory();
+
+            if (shard)
+            {
+                rtc::CritScope scope(&g_lock);
+                --shard->connection_count;
+                releaseFactory(*shard);
+            }
         }
     }
 
@@ -345,7 +501,7 @@ extern "C"
         return connection->AddVideoTrack(label, min_bps, max_bps, max_fps);
     }
 
-    WEBRTC_PLUGIN_API bool AddDataChannel(PeerConnection* connection, const char* label, bool is_ordered, bool is_reliable)
+    WEBRTC_PLUGIN_API int AddDataChannel(PeerConnection* connection, const char* label, bool is_ordered, bool is_reliable)
     {
         return connection->AddDataChannel(label, is_ordered, is_reliable);
     }
@@ -355,6 +511,37 @@ extern "C"
         return connection->RemoveDataChannel(label);
     }
 
+    WEBRTC_PLUGIN_API bool RemoveDataChannelById(PeerConnection* connection, int channelId)
+    {
+        return connection->RemoveDataChannelById(channelId);
+    }
+
+    // How long the encoders of all peer connections took to produce an image, since the previous reset.
+    WEBRTC_PLUGIN_API void GetEncoderTiming(LatencyHistogramSnapshot* snapshot, bool reset)
+    {
+        if (snapshot)
+        {
+            g_encode_timing->GetSnapshot(snapshot, reset);
+        }
+    }
+
+    WEBRTC_PLUGIN_API bool RequestStats(PeerConnection* connection)
+    {
+        return connection->RequestStats();
+    }
+
+    // Returns the number of entries of the latest snapshot, which can be more than the capacity.
+    WEBRTC_PLUGIN_API int GetStats(PeerConnection* connection, StatsEntry* entries, int capacity, int64_t* timestampUs)
+    {
+        return connection->GetStats(entries, capacity, timestampUs);
+    }
+
+    // Returns the size of the JSON string including its terminator, which can be more than the capacity.
+    WEBRTC_PLUGIN_API int GetStatsJson(PeerConnection* connection, char* buffer, int capacity)
+    {
+        return connection->GetStatsJson(buffer, capacity);
+    }
+
     WEBRTC_PLUGIN_API bool CreateOffer(PeerConnection* connection)
     {
         return connection->CreateOffer();
@@ -370,11 +557,79 @@ extern "C"
         return connection->SendData(label, data, length, is_binary);
     }
 
+    WEBRTC_PLUGIN_API int SendDataBatch(PeerConnection* connection, const DataMessageDescriptor* messages, int count, uint8_t* results)
+    {
+        return connection->SendDataBatch(messages, count, results);
+    }
+
+    WEBRTC_PLUGIN_API bool ConfigureDataChannelChunking(PeerConnection* connection, int channelId, int chunkSize)
+    {
+        return connection->ConfigureDataChannelChunking(channelId, chunkSize);
+    }
+
+    WEBRTC_PLUGIN_API bool ConfigureDataChannelMaxMessageSize(PeerConnection* connection, int channelId, int maxMessageSize)
+    {
+        return connection->ConfigureDataChannelMaxMessageSize(channelId, maxMessageSize);
+    }
+
+    WEBRTC_PLUGIN_API bool ConfigureDataChannelCompression(PeerConnection* connection, int channelId, bool isEnabled, int level, int threshold)
+    {
+        return connection->ConfigureDataChannelCompression(channelId, isEnabled, level, threshold);
+    }
+
+    WEBRTC_PLUGIN_API bool GetDataChannelStats(PeerConnection* connection, int channelId, DataChannelStats* stats)
+    {
+        return stats && connection->GetDataChannelStats(channelId, stats);
+    }
+
+    WEBRTC_PLUGIN_API int64_t GetDataChannelBufferedAmount(PeerConnection* connection, int channelId)
+    {
+        return connection->GetDataChannelBufferedAmount(channelId);
+    }
+
+    WEBRTC_PLUGIN_API bool ConfigureDataChannelBuffering(PeerConnection* connection, int channelId, int64_t lowWaterMark, int64_t highWaterMark)
+    {
+        return connection->ConfigureDataChannelBuffering(channelId, lowWaterMark, highWaterMark);
+    }
+
+    WEBRTC_PLUGIN_API bool SendDataById(PeerConnection* connection, int channelId, const uint8_t* data, int length, bool is_binary)
+    {
+        return connection->SendDataById(channelId, data, length, is_binary);
+    }
+
     WEBRTC_PLUGIN_API bool SendVideoFrame(PeerConnection* connection, int trackId, const uint8_t* pixels, int stride, int width, int height, VideoFrameFormat format)
     {
         return connection->SendVideoFrame(trackId, pixels, stride, width, height, format);
     }
 
+    WEBRTC_PLUGIN_API bool SendVideoFrameYuv(PeerConnection* connection, int trackId,
+        const uint8_t* dataY, const uint8_t* dataU, const uint8_t* dataV,
+        int strideY, int strideU, int strideV,
+        int width, int height, VideoFrameFormat format)
+    {
+        return connection->SendVideoFrameYuv(trackId, dataY, dataU, dataV, strideY, strideU, strideV, width, height, format);
+    }
+
+    WEBRTC_PLUGIN_API bool ConfigureVideoTrackQueue(PeerConnection* connection, int trackId, int queueDepth, VideoFrameDropPolicy dropPolicy)
+    {
+        return connection->ConfigureVideoTrackQueue(trackId, queueDepth, dropPolicy);
+    }
+
+    WEBRTC_PLUGIN_API bool SetVideoTrackDeferredConversion(PeerConnection* connection, int trackId, bool isDeferred)
+    {
+        return connection->SetVideoTrackDeferredConversion(trackId, isDeferred);
+    }
+
+    WEBRTC_PLUGIN_API bool GetVideoTrackStats(PeerConnection* connection, int trackId, VideoTrackStats* stats)
+    {
+        return stats && connection->GetVideoTrackStats(trackId, stats);
+    }
+
+    WEBRTC_PLUGIN_API bool GetVideoTrackLatency(PeerConnection* connection, int trackId, VideoTrackLatency* latency, bool reset)
+    {
+        return latency && connection->GetVideoTrackLatency(trackId, latency, reset);
+    }
+
     WEBRTC_PLUGIN_API bool SetAudioControl(PeerConnection* connection, bool is_mute, bool is_record)
     {
         return connection->SetAudioControl(is_mute, is_record);
@@ -404,6 +659,16 @@ extern "C"
         return true;
     }
 
+    WEBRTC_PLUGIN_API bool SetRemoteVideoFrameOptions(PeerConnection* connection, VideoFrameFormat format, int width, int height)
+    {
+        return connection->SetRemoteVideoFrameOptions(format, width, height);
+    }
+
+    WEBRTC_PLUGIN_API int GetRemoteVideoTrackId(PeerConnection* connection, const char* transceiver_mid)
+    {
+        return connection->GetRemoteVideoTrackId(transceiver_mid);
+    }
+
     WEBRTC_PLUGIN_API bool RegisterOnLocalDataChannelReady(PeerConnection* connection, LocalDataChannelReadyCallback callback)
     {
         connection->RegisterOnLocalDataChannelReady(callback);
@@ -416,6 +681,29 @@ extern "C"
         return true;
     }
 
+    WEBRTC_PLUGIN_API bool RegisterOnDataBufferAvailable(PeerConnection* connection, DataBufferAvailableCallback callback)
+    {
+        connection->RegisterOnDataBufferAvailable(callback);
+        return true;
+    }
+
+    WEBRTC_PLUGIN_API bool RegisterOnStatsReady(PeerConnection* connection, StatsReadyCallback callback)
+    {
+        connection->RegisterOnStatsReady(callback);
+        return true;
+    }
+
+    WEBRTC_PLUGIN_API bool RegisterOnDataChannelBufferedAmountLow(PeerConnection* connection, DataChannelBufferedAmountLowCallback callback)
+    {
+        connection->RegisterOnDataChannelBufferedAmountLow(callback);
+        return true;
+    }
+
+    WEBRTC_PLUGIN_API void ReleaseDataBuffer(void* buffer)
+    {
+        PeerConnection::ReleaseDataBuffer(buffer);
+    }
+
     WEBRTC_PLUGIN_API bool RegisterOnFailure(PeerConnection* connection, FailureCallback callback)
     {
         connection->RegisterOnFailure(callback);
@@ -464,6 +752,33 @@ extern "C"
         return true;
     }
 
+    // Queues the events of the connection with the tag, instead of calling its callbacks, see DrainEvents.
+    // Events that were queued before the connection is closed are still drained, the tag identifies their connection.
+    WEBRTC_PLUGIN_API bool SetEventQueueEnabled(PeerConnection* connection, bool is_enabled, int64_t tag)
+    {
+        connection->SetEventQueue(is_enabled ? &g_event_queue : nullptr, tag);
+        return true;
+    }
+
+    // Moves at most capacity queued events to the array, and returns the number of moved events.
+    // Their data stays valid until the next call.
+    WEBRTC_PLUGIN_API int DrainEvents(PeerConnectionEvent* events, int capacity)
+    {
+        return events ? g_event_queue.Drain(events, capacity) : 0;
+    }
+
+    // Waits until events might be queued, or the timeout in milliseconds elapsed. A negative timeout waits forever.
+    WEBRTC_PLUGIN_API bool WaitForEvents(int timeout_ms)
+    {
+        return g_event_queue.Wait(timeout_ms);
+    }
+
+    // An eventfd on Linux, or an event handle on Windows, that is signaled when events are queued after a DrainEvents call.
+    WEBRTC_PLUGIN_API intptr_t GetEventQueueHandle()
+    {
+        return g_event_queue.handle();
+    }
+
     WEBRTC_PLUGIN_API int64_t GetRealtimeClockTimeInMicroseconds()
     {
         const auto clock = webrtc::Clock::GetRealTimeClock();
@@ -9,11 +9,243 @@ enum class VideoFrameFormat
     ARGB32,
     ABGR32,
     CpuTexture,
-    GpuTextureD3D11
+    GpuTextureD3D11,
+    // Reserved, pre-encoded frames are not supported yet.
+    EncodedH264,
+    // Planar YUV formats, sent without conversion, see SendVideoFrameYuv.
+    // The NV12 UV plane is passed as the U plane.
+    I420,
+    NV12,
+    I444
+};
+
+inline bool IsTextureFormat(VideoFrameFormat format)
+{
+    return format == VideoFrameFormat::CpuTexture || format == VideoFrameFormat::GpuTextureD3D11;
+}
+
+inline bool IsPlanarYuvFormat(VideoFrameFormat format)
+{
+    return format == VideoFrameFormat::I420 || format == VideoFrameFormat::NV12 || format == VideoFrameFormat::I444;
+}
+
+// What to do when a frame is submitted to a full video frame queue, see ConfigureVideoTrackQueue.
+enum class VideoFrameDropPolicy
+{
+    DropOldest,
+    DropNewest
+};
+
+// How Configure's factories are assigned to new peer connections.
+enum class FactoryAssignment
+{
+    // Each factory in turn.
+    RoundRobin,
+
+    // The factory with the fewest open peer connections.
+    LeastLoaded
+};
+
+// A data channel message of SendDataBatch.
+struct DataMessageDescriptor
+{
+    const uint8_t* data;
+    int32_t length;
+    int32_t channel_id;
+
+    // Non-zero for binary messages, zero for UTF-8 text.
+    int32_t is_binary;
+};
+
+// Statistics of a local video track, see GetVideoTrackStats.
+struct VideoTrackStats
+{
+    // Number of I420 buffers that were recycled from the track's buffer pool.
+    int64_t buffer_pool_hit_count;
+
+    // Number of I420 buffers that had to be allocated.
+    int64_t buffer_pool_miss_count;
+
+    // Maximum number of I420 buffers that were pooled at the same time.
+    int64_t buffer_pool_high_water_mark;
+
+    // Number of frames that were dropped because the video frame queue was full.
+    int64_t queue_dropped_frame_count;
+
+    // Number of frames that were sent on the track.
+    int64_t submitted_frame_count;
+
+    // Number of frames that were encoded.
+    int64_t encoded_frame_count;
+
+    // Number of frames that were dropped, by the video frame queue, the video adapter or the encoder.
+    int64_t dropped_frame_count;
+};
+
+// Summary of a latency histogram, all latencies are in microseconds.
+// The percentiles are the upper bounds of their histogram bucket, which are within 25% of the actual value.
+struct LatencyHistogramSnapshot
+{
+    int64_t count;
+    int64_t sum_us;
+    int64_t max_us;
+    int64_t p50_us;
+    int64_t p90_us;
+    int64_t p99_us;
+};
+
+// Latencies of the frames encoded on a local video track, see GetVideoTrackLatency.
+struct VideoTrackLatency
+{
+    // From sending the frame until the encoder starts encoding it, including queueing and conversion.
+    LatencyHistogramSnapshot submit_to_encode;
+
+    // Until the encoder produced the image.
+    LatencyHistogramSnapshot encode;
+
+    // Until the image was packetized.
+    LatencyHistogramSnapshot encode_to_send;
+};
+
+// Compression statistics of a data channel, see GetDataChannelStats.
+struct DataChannelStats
+{
+    // Number of sent messages that were compressed.
+    int64_t compressed_message_count;
+
+    // Number of sent messages that were not compressed, because they were too small or did not shrink.
+    int64_t stored_message_count;
+
+    // Size of the compressed messages before and after compression.
+    int64_t uncompressed_byte_count;
+    int64_t compressed_byte_count;
+
+    // Time spent compressing, including the attempts that did not shrink the message.
+    int64_t compression_time_us;
+
+    // Number of received messages that were decompressed.
+    int64_t decompressed_message_count;
+
+    // Time spent decompressing.
+    int64_t decompression_time_us;
+};
+
+// Identifies a value of the standard stats, these numbers must never change.
+enum class StatsFieldId : int32_t
+{
+    // Of the nominated ICE candidate pair.
+    CurrentRoundTripTime = 1,       // seconds
+    AvailableOutgoingBitrate = 2,   // bits per second
+    AvailableIncomingBitrate = 3,   // bits per second
+
+    // Of an outbound RTP stream.
+    PacketsSent = 10,
+    BytesSent = 11,
+    FramesEncoded = 12,
+    EncoderQpSum = 13,
+    TargetBitrate = 14,             // bits per second
+    NackCountReceived = 15,
+    PliCountReceived = 16,
+    FirCountReceived = 17,
+    TotalEncodeTime = 18,           // seconds
+
+    // Of an inbound RTP stream.
+    PacketsReceived = 30,
+    BytesReceived = 31,
+    PacketsLost = 32,
+    Jitter = 33,                    // seconds
+    FramesDecoded = 34,
+    DecoderQpSum = 35,
+    NackCountSent = 36,
+    PliCountSent = 37,
+    FirCountSent = 38,
+
+    // Of a media stream track, see StatsEntry::is_remote.
+    FrameWidth = 50,
+    FrameHeight = 51,
+    FramesPerSecond = 52,
+    FramesSent = 53,
+    FramesReceived = 54,
+    FramesDropped = 55,
+    JitterBufferDelay = 56,         // seconds
+    AudioLevel = 57,
+};
+
+enum class StatsMediaKind : int32_t
+{
+    None = 0,
+    Audio = 1,
+    Video = 2
+};
+
+// A single value of a stats snapshot, see GetStats.
+struct StatsEntry
+{
+    double value;
+    StatsFieldId field_id;
+
+    // The SSRC of RTP stream values, 0 otherwise.
+    uint32_t ssrc;
+
+    StatsMediaKind media_kind;
+
+    // Non-zero for values of remote tracks.
+    int32_t is_remote;
+};
+
+// The kind of a queued peer connection event, see PeerConnectionEvent for the meaning of its fields.
+enum class PeerConnectionEventType : int32_t
+{
+    // text: the type, data: the SDP.
+    LocalSdpReadyToSend,
+
+    // data: the candidate, id: the SDP m-line index, text: the SDP mid.
+    IceCandidateReadyToSend,
+
+    // value: the new state.
+    SignalingStateChanged,
+    ConnectionStateChanged,
+
+    // text: the transceiver mid, id: the media kind, value: the change kind.
+    RemoteTrackChanged,
+
+    // data: the message.
+    Failure,
+
+    // id: the data channel, data: the label.
+    LocalDataChannelReady,
+
+    // id: the data channel, data and length: the message, value: non-zero for binary messages.
+    DataAvailable,
+
+    // id: the data channel, value: the buffered amount.
+    DataChannelBufferedAmountLow,
+
+    // id: the video track, data: the pixels of the frame, not copied, value: non-zero when encoded.
+    VideoFrameProcessed,
+
+    // value: the timestamp of the stats report in microseconds.
+    StatsReady
+};
+
+// An event of a peer connection that has the event queue enabled, see SetEventQueueEnabled and DrainEvents.
+// Copied data and text are null terminated, and stay valid until the next DrainEvents call.
+struct PeerConnectionEvent
+{
+    // The tag given to SetEventQueueEnabled.
+    int64_t tag;
+    PeerConnectionEventType type;
+    int32_t id;
+    int64_t value;
+    const void* data;
+    const char* text;
+    int32_t length;
 };
 
 // Definitions of callback functions.
+// The track identifier is zero for local frames, see GetRemoteVideoTrackId for remote frames.
 typedef void(*IncomingVideoFrameCallback)(
+    int track_id,
     const void* texture,
     const uint8_t* data_y,
     const uint8_t* data_u,
@@ -25,11 +257,21 @@ typedef void(*IncomingVideoFrameCallback)(
     int stride_a,
     uint32_t width,
     uint32_t height,
-    uint64_t timeStampUS);
+    uint64_t timeStampUS,
+    VideoFrameFormat format);
+
+typedef void(*LocalDataChannelReadyCallback)(int channel_id, const char* label);
+
+typedef void(*DataAvailableCallback)(int channel_id, const uint8_t* data, int length, bool is_binary);
+
+// The data stays valid until the buffer is passed to ReleaseDataBuffer.
+typedef void(*DataBufferAvailableCallback)(int channel_id, void* buffer, const uint8_t* data, int length, bool is_binary);
 
-typedef void(*LocalDataChannelReadyCallback)(const char* label);
+// Called when the buffered amount of a data channel dropped to its low-water mark, see ConfigureDataChannelBuffering.
+typedef void(*DataChannelBufferedAmountLowCallback)(int channel_id, uint64_t buffered_amount);
 
-typedef void(*DataAvailableCallback)(const char* label, const uint8_t* data, int length, bool is_binary);
+// Called when a stats snapshot requested with RequestStats is available.
+typedef void(*StatsReadyCallback)(int64_t timestamp_us);
 
 typedef void(*FailureCallback)(const char* msg);
 
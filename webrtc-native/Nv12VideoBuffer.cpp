@@ -0,0 +1,51 @@
+#include "pch.h"
+#include "Nv12VideoBuffer.h"
+
+namespace webrtc
+{
+    Nv12VideoBuffer::Nv12VideoBuffer(
+        int width,
+        int height,
+        const uint8_t* data_y,
+        int stride_y,
+        const uint8_t* data_uv,
+        int stride_uv)
+        : width_(width)
+        , height_(height)
+        , data_y_(data_y)
+        , stride_y_(stride_y)
+        , data_uv_(data_uv)
+        , stride_uv_(stride_uv)
+    {
+    }
+
+    VideoFrameBuffer::Type Nv12VideoBuffer::type() const
+    {
+        return Type::kNative;
+    }
+
+    int Nv12VideoBuffer::width() const
+    {
+        return width_;
+    }
+
+    int Nv12VideoBuffer::height() const
+    {
+        return height_;
+    }
+
+    rtc::scoped_refptr<I420BufferInterface> Nv12VideoBuffer::ToI420()
+    {
+        auto buffer = I420Buffer::Create(width_, height_);
+
+        libyuv::NV12ToI420(
+            data_y_, stride_y_,
+            data_uv_, stride_uv_,
+            buffer->MutableDataY(), buffer->StrideY(),
+            buffer->MutableDataU(), buffer->StrideU(),
+            buffer->MutableDataV(), buffer->StrideV(),
+            width_, height_);
+
+        return buffer;
+    }
+} // namespace webrtc
@@ -0,0 +1,37 @@
+#pragma once
+#include "macros.h"
+
+namespace webrtc
+{
+    // Wraps the NV12 planes of the caller without copying them.
+    // This WebRTC version has no NV12 buffer type, so the planes are only converted to I420
+    // when the encoder asks for them, on the encoder thread.
+    class Nv12VideoBuffer : public VideoFrameBuffer
+    {
+    public:
+        Nv12VideoBuffer(int width, int height,
+            const uint8_t* data_y, int stride_y,
+            const uint8_t* data_uv, int stride_uv);
+
+        Type type() const override;
+        int width() const override;
+        int height() const override;
+
+        const uint8_t* DataY() const { return data_y_; }
+        const uint8_t* DataUV() const { return data_uv_; }
+        int StrideY() const { return stride_y_; }
+        int StrideUV() const { return stride_uv_; }
+
+        DISALLOW_COPY_MOVE_ASSIGN(Nv12VideoBuffer);
+
+    private:
+        rtc::scoped_refptr<I420BufferInterface> ToI420() override;
+
+        const int width_;
+        const int height_;
+        const uint8_t* data_y_;
+        const int stride_y_;
+        const uint8_t* data_uv_;
+        const int stride_uv_;
+    };
+} // namespace webrtc
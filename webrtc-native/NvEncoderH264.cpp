@@ -125,13 +125,12 @@ namespace webrtc
                 // Store h264 encoder.
                 encoder_ = nvEncoder;*/
 
-                // Create encoded output buffer
-        const size_t new_capacity = 4 * width * height;
-        encoded_output_buffer_.resize(new_capacity);
+        // Create encoded output buffer, large enough for most key frames.
+        encoded_output_buffer_.reserve(EstimateMaxEncodedImageSize(codec_));
         encoded_image_._completeFrame = true;
         encoded_image_._encodedWidth = width;
         encoded_image_._encodedHeight = height;
-        encoded_image_.set_buffer(&encoded_output_buffer_[0], new_capacity);
+        encoded_image_.set_buffer(encoded_output_buffer_.data(), encoded_output_buffer_.capacity());
         encoded_image_.set_size(0);
 
         SimulcastRateAllocator init_allocator(codec_);
@@ -148,7 +147,8 @@ namespace webrtc
         }
 
         encoded_output_buffer_.clear();
-        encoded_image_.set_buffer(&encoded_output_buffer_[0], 0);
+        encoded_output_buffer_.shrink_to_fit();
+        encoded_image_.set_buffer(encoded_output_buffer_.data(), 0);
 
         is_sending_ = false;
         key_frame_request_ = false;
@@ -283,6 +283,8 @@ namespace webrtc
                 fflush(debug_output_file_);
             }
 
+            // The output buffer grows when an image does not fit.
+            encoded_image_.set_buffer(encoded_output_buffer_.data(), encoded_output_buffer_.capacity());
             encoded_image_.set_size(encoded_output_buffer_.size());
             encoded_image_.qp_ = 5; // TODO: Why was this hardcoded by Microsoft's 3D streaming toolkit? It seems it is replaced anyway by code below (GetLastSliceQp)
             encoded_image_._encodedWidth = width;
@@ -299,58 +301,21 @@ namespace webrtc
             encoded_image_.timing_.flags = VideoSendTiming::kInvalid;
             encoded_image_.SetSpatialIndex(0);
 
-            RTPFragmentationHeader frag_header;
-
-            // This code is copied from the 3D Streaming Toolkit (MIT license)
-            // https://github.com/3DStreamingToolkit/3DStreamingToolkit
+            // Also sets the frame type and parses the QP.
+            if (!packetizer_.Packetize(encoded_output_buffer_.data(), encoded_output_buffer_.size(), &encoded_image_))
             {
-                const auto encoded_buffer_size = encoded_output_buffer_.size();
-
-                std::vector<H264::NaluIndex> NALUidx;
-                auto p_nal = &encoded_output_buffer_[0];
-                NALUidx = H264::FindNaluIndices(p_nal, encoded_buffer_size);
-                size_t i_nal = NALUidx.size();
-                if (i_nal == 0)
-                {
-                    // TODO: Check this
-                    return WEBRTC_VIDEO_CODEC_OK;
-                }
-
-                if (i_nal == 1)
-                {
-                    NALUidx[0].payload_size = encoded_buffer_size - NALUidx[0].payload_start_offset;
-                }
-                else for (size_t i = 0; i < i_nal; i++)
-                {
-                    NALUidx[i].payload_size = i + 1 >= i_nal ? encoded_buffer_size - NALUidx[i].payload_start_offset : NALUidx[i + 1].start_offset - NALUidx[i].payload_start_offset;
-                }
-
-                frag_header.VerifyAndAllocateFragmentationHeader(i_nal);
-
-                uint32_t totalNaluIndex = 0;
-                for (size_t nal_index = 0; nal_index < i_nal; nal_index++)
-                {
-                    const size_t currentNaluSize = NALUidx[nal_index].payload_size; //i_frame_size
-                    frag_header.fragmentationOffset[totalNaluIndex] = NALUidx[nal_index].payload_start_offset;
-                    frag_header.fragmentationLength[totalNaluIndex] = currentNaluSize;
-                    frag_header.fragmentationPlType[totalNaluIndex] = H264::ParseNaluType(p_nal[NALUidx[nal_index].payload_start_offset]);
-                    frag_header.fragmentationTimeDiff[totalNaluIndex] = 0;
-                    totalNaluIndex++;
-                }
+                // TODO: Check this
+                return WEBRTC_VIDEO_CODEC_OK;
             }
 
             // Encoder can skip frames to save bandwidth in which case |encoded_images_[i]._length| == 0.
             if (encoded_image_.size() > 0)
             {
-                // Parse QP.
-                h264_bitstream_parser_.ParseBitstream(encoded_image_.data(), encoded_image_.size());
-                h264_bitstream_parser_.GetLastSliceQp(&encoded_image_.qp_);
-
                 // Deliver encoded image.
                 CodecSpecificInfo codec_specific;
                 codec_specific.codecType = kVideoCodecH264;
                 codec_specific.codecSpecific.H264.packetization_mode = H264PacketizationMode::NonInterleaved;
-                encoded_image_callback_->OnEncodedImage(encoded_image_, &codec_specific, &frag_header);
+                encoded_image_callback_->OnEncodedImage(encoded_image_, &codec_specific, &packetizer_.fragmentation());
             }
         }
         return WEBRTC_VIDEO_CODEC_OK;
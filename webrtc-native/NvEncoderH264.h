@@ -1,5 +1,6 @@
 #pragma once
 #include "macros.h"
+#include "H264Packetizer.h"
 
 class NvEncFacadeD3D11;
 
@@ -40,14 +41,14 @@ namespace webrtc {
         EncoderInfo GetEncoderInfo() const override;
 
     private:
-        H264BitstreamParser h264_bitstream_parser_;
+        H264Packetizer packetizer_;
         
         // Reports statistics with histograms.
         void ReportInit();
         void ReportError();
         void SetStreamState(bool send_stream);
 
-		NvEncFacadeD3D11* encoder;
+		NvEncFacadeD3D11* encoder = nullptr;
         std::vector<uint8_t> encoded_output_buffer_;
         EncodedImage encoded_image_;
 
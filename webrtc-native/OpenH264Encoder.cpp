@@ -0,0 +1,398 @@
+#include "pch.h"
+#include "OpenH264Encoder.h"
+
+#ifdef WEBRTC_USE_H264
+
+#include "third_party/openh264/src/codec/api/svc/codec_api.h"
+#include "third_party/openh264/src/codec/api/svc/codec_app_def.h"
+#include "third_party/openh264/src/codec/api/svc/codec_def.h"
+
+namespace webrtc
+{
+    namespace
+    {
+        // Used by histograms. Values of entries should not be changed.
+        enum H264EncoderImplEvent
+        {
+            kH264EncoderEventInit = 0,
+            kH264EncoderEventError = 1,
+            kH264EncoderEventMax = 16,
+        };
+
+        // OpenH264 splits the frame in one slice per thread, more threads hardly speed up encoding.
+        const int kMaxThreadCount = 8;
+    }
+
+    OpenH264Encoder::OpenH264Encoder(int thread_count, H264PacketizationMode packetization_mode)
+        : thread_count_(thread_count)
+        , packetization_mode_(packetization_mode)
+    {
+    }
+
+    OpenH264Encoder::~OpenH264Encoder()
+    {
+        Release();
+    }
+
+    int32_t OpenH264Encoder::InitEncode(const VideoCodec* codec_settings, int32_t number_of_cores, size_t max_payload_size)
+    {
+        ReportInit();
+        if (!codec_settings || codec_settings->codecType != kVideoCodecH264)
+        {
+            ReportError();
+            return WEBRTC_VIDEO_CODEC_ERR_PARAMETER;
+        }
+        if (codec_settings->maxFramerate == 0)
+        {
+            ReportError();
+            return WEBRTC_VIDEO_CODEC_ERR_PARAMETER;
+        }
+        if (codec_settings->width < 1 || codec_settings->height < 1)
+        {
+            ReportError();
+            return WEBRTC_VIDEO_CODEC_ERR_PARAMETER;
+        }
+
+        const int32_t release_ret = Release();
+        if (release_ret != WEBRTC_VIDEO_CODEC_OK)
+        {
+            ReportError();
+            return release_ret;
+        }
+
+        const int number_of_streams = SimulcastUtility::NumberOfSimulcastStreams(*codec_settings);
+        if (number_of_streams > 1)
+            return WEBRTC_VIDEO_CODEC_ERR_SIMULCAST_PARAMETERS_NOT_SUPPORTED;
+
+        codec_ = *codec_settings;
+
+        // Code expects simulcastStream resolutions to be correct, make sure they are
+        // filled even when there are no simulcast layers.
+        if (codec_.numberOfSimulcastStreams == 0)
+        {
+            codec_.simulcastStream[0].width = codec_.width;
+            codec_.simulcastStream[0].height = codec_.height;
+        }
+
+        // Temporal layers not supported.
+        if (codec_settings->simulcastStream[0].numberOfTemporalLayers > 1)
+        {
+            Release();
+            return WEBRTC_VIDEO_CODEC_ERR_SIMULCAST_PARAMETERS_NOT_SUPPORTED;
+        }
+
+        const auto width = codec_.simulcastStream[0].width;
+        const auto height = codec_.simulcastStream[0].height;
+
+        is_sending_ = false;
+        key_frame_request_ = false;
+
+        if (WelsCreateSVCEncoder(&encoder_) != 0 || !encoder_)
+        {
+            RTC_LOG(LS_ERROR) << "Failed to create OpenH264 encoder";
+            encoder_ = nullptr;
+            ReportError();
+            return WEBRTC_VIDEO_CODEC_ERROR;
+        }
+
+        const auto thread_count = std::min(kMaxThreadCount, thread_count_ > 0 ? thread_count_ : std::max(1, number_of_cores));
+
+        SEncParamExt params;
+        encoder_->GetDefaultParams(&params);
+
+        params.iUsageType = codec_.mode == VideoCodecMode::kScreensharing
+            ? SCREEN_CONTENT_REAL_TIME
+            : CAMERA_VIDEO_REAL_TIME;
+        params.iPicWidth = width;
+        params.iPicHeight = height;
+        params.iTargetBitrate = codec_.startBitrate * 1000;
+        params.iMaxBitrate = codec_.maxBitrate > 0 ? codec_.maxBitrate * 1000 : UNSPECIFIED_BIT_RATE;
+        params.fMaxFrameRate = static_cast<float>(codec_.maxFramerate);
+
+        // Like NVENC: constant bitrate, never skip frames, only send key frames when requested.
+        params.iRCMode = RC_BITRATE_MODE;
+        params.bEnableFrameSkip = false;
+        params.uiIntraPeriod = 0;
+        params.bEnableLongTermReference = false;
+        params.bEnableDenoise = false;
+        params.bEnableBackgroundDetection = false;
+        params.bEnableSceneChangeDetect = false;
+
+        // Baseline profile has no B-frames.
+        params.iSpatialLayerNum = 1;
+        params.iTemporalLayerNum = 1;
+        params.iEntropyCodingModeFlag = 0;
+        params.eSpsPpsIdStrategy = CONSTANT_ID;
+        params.iMultipleThreadIdc = static_cast<unsigned short>(thread_count);
+
+        auto& layer = params.sSpatialLayers[0];
+        layer.iVideoWidth = width;
+        layer.iVideoHeight = height;
+        layer.fFrameRate = params.fMaxFrameRate;
+        layer.iSpatialBitrate = params.iTargetBitrate;
+        layer.iMaxSpatialBitrate = params.iMaxBitrate;
+        layer.uiProfileIdc = PRO_BASELINE;
+        // Matches the level offered by the encoder factory.
+        layer.uiLevelIdc = LEVEL_5_0;
+
+        if (packetization_mode_ == H264PacketizationMode::SingleNalUnit)
+        {
+            // Without fragmentation units, every slice must fit in a packet.
+            layer.sSliceArgument.uiSliceMode = SM_SIZELIMITED_SLICE;
+            layer.sSliceArgument.uiSliceNum = 1;
+            layer.sSliceArgument.uiSliceSizeConstraint = static_cast<unsigned int>(max_payload_size);
+            params.uiMaxNalSize = static_cast<unsigned int>(max_payload_size);
+        }
+        else
+        {
+            // Every thread encodes its own slice.
+            layer.sSliceArgument.uiSliceMode = thread_count > 1 ? SM_FIXEDSLCNUM_SLICE : SM_SINGLE_SLICE;
+            layer.sSliceArgument.uiSliceNum = thread_count;
+        }
+
+        if (encoder_->InitializeExt(&params) != cmResultSuccess)
+        {
+            RTC_LOG(LS_ERROR) << "Failed to initialize OpenH264 encoder";
+            Release();
+            ReportError();
+            return WEBRTC_VIDEO_CODEC_ERROR;
+        }
+
+        int video_format = videoFormatI420;
+        encoder_->SetOption(ENCODER_OPTION_DATAFORMAT, &video_format);
+
+        // Create encoded output buffer, large enough for most key frames.
+        encoded_output_buffer_.reserve(EstimateMaxEncodedImageSize(codec_));
+        encoded_image_._completeFrame = true;
+        encoded_image_._encodedWidth = width;
+        encoded_image_._encodedHeight = height;
+        encoded_image_.set_buffer(encoded_output_buffer_.data(), encoded_output_buffer_.capacity());
+        encoded_image_.set_size(0);
+
+        SimulcastRateAllocator init_allocator(codec_);
+        VideoBitrateAllocation allocation = init_allocator.GetAllocation(codec_.startBitrate * 1000, codec_.maxFramerate);
+        return SetRateAllocation(allocation, codec_.maxFramerate);
+    }
+
+    int32_t OpenH264Encoder::Release()
+    {
+        if (encoder_)
+        {
+            encoder_->Uninitialize();
+            WelsDestroySVCEncoder(encoder_);
+            encoder_ = nullptr;
+        }
+
+        encoded_output_buffer_.clear();
+        encoded_output_buffer_.shrink_to_fit();
+        encoded_image_.set_buffer(encoded_output_buffer_.data(), 0);
+
+        is_sending_ = false;
+        key_frame_request_ = false;
+
+        return WEBRTC_VIDEO_CODEC_OK;
+    }
+
+    int32_t OpenH264Encoder::RegisterEncodeCompleteCallback(
+        EncodedImageCallback* callback)
+    {
+        encoded_image_callback_ = callback;
+        return WEBRTC_VIDEO_CODEC_OK;
+    }
+
+    int32_t OpenH264Encoder::SetRateAllocation(const VideoBitrateAllocation& bitrate, uint32_t new_framerate)
+    {
+        if (!encoder_)
+            return WEBRTC_VIDEO_CODEC_UNINITIALIZED;
+
+        if (new_framerate < 1)
+            return WEBRTC_VIDEO_CODEC_ERR_PARAMETER;
+
+        if (bitrate.get_sum_bps() == 0)
+        {
+            // Encoder paused, turn off all encoding.
+            SetStreamState(false);
+            return WEBRTC_VIDEO_CODEC_OK;
+        }
+
+        // At this point, bitrate allocation should already match codec settings.
+        if (codec_.maxBitrate > 0)
+            RTC_DCHECK_LE(bitrate.get_sum_kbps(), codec_.maxBitrate);
+        RTC_DCHECK_GE(bitrate.get_sum_kbps(), codec_.minBitrate);
+        if (codec_.numberOfSimulcastStreams > 0)
+            RTC_DCHECK_GE(bitrate.get_sum_kbps(), codec_.simulcastStream[0].minBitrate);
+
+        codec_.maxFramerate = new_framerate;
+
+        SetStreamState(true);
+
+        SBitrateInfo target_bitrate{};
+        target_bitrate.iLayer = SPATIAL_LAYER_ALL;
+        target_bitrate.iBitrate = static_cast<int>(bitrate.get_sum_bps());
+        encoder_->SetOption(ENCODER_OPTION_BITRATE, &target_bitrate);
+
+        float max_framerate = static_cast<float>(new_framerate);
+        encoder_->SetOption(ENCODER_OPTION_FRAME_RATE, &max_framerate);
+
+        return WEBRTC_VIDEO_CODEC_OK;
+    }
+
+    int32_t OpenH264Encoder::Encode(const VideoFrame& input_frame,
+        const CodecSpecificInfo* codec_specific_info,
+        const std::vector<FrameType>* frame_types)
+    {
+        if (!encoder_)
+        {
+            ReportError();
+            return WEBRTC_VIDEO_CODEC_UNINITIALIZED;
+        }
+        if (!encoded_image_callback_)
+        {
+            RTC_LOG(LS_WARNING)
+                << "InitEncode() has been called, but a callback function "
+                << "has not been set with RegisterEncodeCompleteCallback()";
+            ReportError();
+            return WEBRTC_VIDEO_CODEC_UNINITIALIZED;
+        }
+
+        bool send_key_frame = false;
+        if (key_frame_request_ && is_sending_)
+        {
+            send_key_frame = true;
+        }
+
+        if (!send_key_frame && frame_types && !frame_types->empty())
+        {
+            if ((*frame_types)[0] == kVideoFrameKey && is_sending_)
+            {
+                send_key_frame = true;
+            }
+        }
+
+        if (!is_sending_ || (frame_types && frame_types->at(0) == kEmptyFrame))
+            return WEBRTC_VIDEO_CODEC_OK;
+
+        const auto frame_buffer = input_frame.video_frame_buffer()->ToI420();
+        const auto width = frame_buffer->width();
+        const auto height = frame_buffer->height();
+
+        RTC_DCHECK_EQ(encoded_image_._encodedWidth, width);
+        RTC_DCHECK_EQ(encoded_image_._encodedHeight, height);
+
+        SSourcePicture picture{};
+        picture.iPicWidth = width;
+        picture.iPicHeight = height;
+        picture.iColorFormat = videoFormatI420;
+        picture.uiTimeStamp = input_frame.ntp_time_ms();
+        picture.iStride[0] = frame_buffer->StrideY();
+        picture.iStride[1] = frame_buffer->StrideU();
+        picture.iStride[2] = frame_buffer->StrideV();
+        picture.pData[0] = const_cast<uint8_t*>(frame_buffer->DataY());
+        picture.pData[1] = const_cast<uint8_t*>(frame_buffer->DataU());
+        picture.pData[2] = const_cast<uint8_t*>(frame_buffer->DataV());
+
+        if (send_key_frame)
+        {
+            encoder_->ForceIntraFrame(true);
+            key_frame_request_ = false;
+        }
+
+        SFrameBSInfo info{};
+        const auto result = encoder_->EncodeFrame(&picture, &info);
+        if (result != cmResultSuccess)
+        {
+            RTC_LOG(LS_ERROR) << "OpenH264 frame encoding failed, EncodeFrame returned " << result;
+            ReportError();
+            return WEBRTC_VIDEO_CODEC_ERROR;
+        }
+
+        // The encoder has no output when it skips the frame.
+        if (info.eFrameType == videoFrameTypeSkip)
+            return WEBRTC_VIDEO_CODEC_OK;
+
+        // Concatenate the NAL units of all layers, these already have start codes.
+        encoded_output_buffer_.clear();
+
+        for (int layer_index = 0; layer_index < info.iLayerNum; ++layer_index)
+        {
+            const auto& layer = info.sLayerInfo[layer_index];
+
+            size_t layer_size = 0;
+            for (int nal_index = 0; nal_index < layer.iNalCount; ++nal_index)
+            {
+                layer_size += layer.pNalLengthInByte[nal_index];
+            }
+
+            encoded_output_buffer_.insert(encoded_output_buffer_.end(), layer.pBsBuf, layer.pBsBuf + layer_size);
+        }
+
+        encoded_image_.set_buffer(encoded_output_buffer_.data(), encoded_output_buffer_.capacity());
+        encoded_image_.set_size(encoded_output_buffer_.size());
+        encoded_image_._encodedWidth = width;
+        encoded_image_._encodedHeight = height;
+        encoded_image_.SetTimestamp(input_frame.timestamp());
+        encoded_image_.ntp_time_ms_ = input_frame.ntp_time_ms();
+        encoded_image_.capture_time_ms_ = input_frame.render_time_ms();
+        encoded_image_.rotation_ = input_frame.rotation();
+        encoded_image_.SetColorSpace(input_frame.color_space());
+        encoded_image_.content_type_ =
+            (codec_.mode == VideoCodecMode::kScreensharing)
+            ? VideoContentType::SCREENSHARE
+            : VideoContentType::UNSPECIFIED;
+        encoded_image_.timing_.flags = VideoSendTiming::kInvalid;
+        encoded_image_.SetSpatialIndex(0);
+
+        // Also sets the frame type and parses the QP.
+        if (!packetizer_.Packetize(encoded_output_buffer_.data(), encoded_output_buffer_.size(), &encoded_image_))
+            return WEBRTC_VIDEO_CODEC_OK;
+
+        // Deliver encoded image.
+        CodecSpecificInfo codec_specific;
+        codec_specific.codecType = kVideoCodecH264;
+        codec_specific.codecSpecific.H264.packetization_mode = packetization_mode_;
+        encoded_image_callback_->OnEncodedImage(encoded_image_, &codec_specific, &packetizer_.fragmentation());
+
+        return WEBRTC_VIDEO_CODEC_OK;
+    }
+
+    void OpenH264Encoder::ReportInit()
+    {
+        if (has_reported_init_)
+            return;
+        RTC_HISTOGRAM_ENUMERATION("WebRTC.Video.OpenH264Encoder.Event",
+            kH264EncoderEventInit, kH264EncoderEventMax);
+        has_reported_init_ = true;
+    }
+
+    void OpenH264Encoder::ReportError()
+    {
+        if (has_reported_error_)
+            return;
+        RTC_HISTOGRAM_ENUMERATION("WebRTC.Video.OpenH264Encoder.Event",
+            kH264EncoderEventError, kH264EncoderEventMax);
+        has_reported_error_ = true;
+    }
+
+    VideoEncoder::EncoderInfo OpenH264Encoder::GetEncoderInfo() const
+    {
+        EncoderInfo info;
+        info.supports_native_handle = false;
+        info.implementation_name = "WMP_OPENH264";
+        info.scaling_settings = ScalingSettings(ScalingSettings::kOff);
+        info.is_hardware_accelerated = false;
+        info.has_internal_source = false;
+        return info;
+    }
+
+    void OpenH264Encoder::SetStreamState(bool send_stream)
+    {
+        if (send_stream && !is_sending_)
+        {
+            // Need a key frame if we have not sent this stream before.
+            key_frame_request_ = true;
+        }
+        is_sending_ = send_stream;
+    }
+}  // namespace webrtc
+
+#endif
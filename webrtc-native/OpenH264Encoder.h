@@ -0,0 +1,73 @@
+#pragma once
+#include "macros.h"
+#include "H264Packetizer.h"
+
+class ISVCEncoder;
+
+namespace webrtc {
+
+    // A software H.264 encoder for machines without NVENC, tuned like NvEncoderH264 for low latency:
+    // constant bitrate, a single key frame unless one is requested, no B-frames and no frame skipping.
+    // Only available when libwebrtc is built with H.264 support (WEBRTC_USE_H264), which links OpenH264.
+    class OpenH264Encoder final : public VideoEncoder {
+    public:
+        // |thread_count| is the number of encoding threads, 0 uses the number of cores.
+        // With |packetization_mode| SingleNalUnit, every slice fits in a single RTP packet.
+        OpenH264Encoder(int thread_count, H264PacketizationMode packetization_mode);
+        ~OpenH264Encoder() override;
+
+        DISALLOW_COPY_MOVE_ASSIGN(OpenH264Encoder);
+
+        // |max_payload_size| limits the slice size in SingleNalUnit packetization mode.
+        // The following members of |codec_settings| are used. The rest are ignored.
+        // - codecType (must be kVideoCodecH264)
+        // - targetBitrate
+        // - maxBitrate
+        // - maxFramerate
+        // - width
+        // - height
+        // - mode
+        int32_t InitEncode(const VideoCodec* codec_settings,
+            int32_t number_of_cores,
+            size_t max_payload_size) override;
+        int32_t Release() override;
+
+        int32_t RegisterEncodeCompleteCallback(
+            EncodedImageCallback* callback) override;
+        int32_t SetRateAllocation(const VideoBitrateAllocation& bitrate_allocation,
+            uint32_t framerate) override;
+
+        // The result of encoding - an EncodedImage and RTPFragmentationHeader - are
+        // passed to the encode complete callback.
+        int32_t Encode(const VideoFrame& frame,
+            const CodecSpecificInfo* codec_specific_info,
+            const std::vector<FrameType>* frame_types) override;
+
+        EncoderInfo GetEncoderInfo() const override;
+
+    private:
+        H264Packetizer packetizer_;
+
+        // Reports statistics with histograms.
+        void ReportInit();
+        void ReportError();
+        void SetStreamState(bool send_stream);
+
+        const int thread_count_;
+        const H264PacketizationMode packetization_mode_;
+
+        ISVCEncoder* encoder_ = nullptr;
+        std::vector<uint8_t> encoded_output_buffer_;
+        EncodedImage encoded_image_;
+
+        VideoCodec codec_;
+        EncodedImageCallback* encoded_image_callback_ = nullptr;
+
+        bool has_reported_init_ = false;
+        bool has_reported_error_ = false;
+
+        bool is_sending_ = false;
+        bool key_frame_request_ = false;
+    };
+
+}  // namespace webrtc
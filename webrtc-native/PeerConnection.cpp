@@ -4,21 +4,14 @@
 #include "InjectableVideoTrackSource.h"
 #include "DummySetSessionDescriptionObserver.h"
 #include "NativeVideoBuffer.h"
+#include "TrackedVideoBuffer.h"
+#include "Nv12VideoBuffer.h"
+#include "RgbaVideoBuffer.h"
 
 namespace
 {
-    auto getYuvConverter(VideoFrameFormat pf)
-    {
-        switch (pf)
-        {
-        case VideoFrameFormat::BGRA32: return libyuv::ARGBToI420;
-        case VideoFrameFormat::RGBA32: return libyuv::ABGRToI420;
-        case VideoFrameFormat::ARGB32: return libyuv::BGRAToI420;
-        case VideoFrameFormat::ABGR32: return libyuv::RGBAToI420;
-        default:
-            throw std::runtime_error("No YUV converter for pixel format " + std::to_string(static_cast<int>(pf)));
-        }
-    }
+    // Larger messages are not supported by every SCTP implementation.
+    const int kMaxDataChunkSize = 256 * 1024;
 
     std::string GetEnvVarOrDefault(const char* env_var_name, const char* default_value)
     {
@@ -36,22 +29,24 @@ namespace
 
 PeerConnection::PeerConnection(
     webrtc::PeerConnectionFactoryInterface* factory,
+    rtc::Thread* signaling_thread,
+    std::shared_ptr<webrtc::YuvConverter> yuv_converter,
     const char** ice_url_array, const int ice_url_count,
     const char* ice_username, const char* ice_password,
     bool can_receive_audio, bool can_receive_video,
     bool enable_dtls_srtp)
     : factory_(factory)
+    , signaling_thread_(signaling_thread)
+    , yuv_converter_(std::move(yuv_converter))
+    , stats_snapshot_(std::make_shared<webrtc::StatsSnapshot>())
     , can_receive_audio_(can_receive_audio)
     , can_receive_video_(can_receive_video)
 {
     RTC_DCHECK(factory_.get() != nullptr);
+    RTC_DCHECK(yuv_converter_ != nullptr);
 
 #ifdef HAS_LOCAL_VIDEO_OBSERVER
-    local_video_observer_.reset(new VideoObserver());
-#endif
-
-#ifdef HAS_REMOTE_VIDEO_OBSERVER
-    remote_video_observer_.reset(new VideoObserver());
+    local_video_observer_.reset(new VideoObserver(0));
 #endif
 
     // Add the turn and sturn servers.
@@ -91,8 +86,12 @@ PeerConnection::PeerConnection(
 
 PeerConnection::~PeerConnection()
 {
+    // Stop all video frame queues, these report dropped frames to us.
+    video_tracks_.clear();
+
     // Destruct all data channels.
     data_channels_.clear();
+    data_channel_ids_.clear();
 }
 
 bool PeerConnection::CreateOffer()
@@ -155,6 +154,9 @@ void PeerConnection::OnSuccess(
     std::string sdp;
     desc->ToString(&sdp);
 
+    if (PostEvent(PeerConnectionEventType::LocalSdpReadyToSend, 0, 0, sdp.data(), sdp.size(), desc->type().c_str()))
+        return;
+
     if (OnLocalSdpReadyToSend)
         OnLocalSdpReadyToSend(desc->type().c_str(), sdp.c_str());
 }
@@ -164,6 +166,9 @@ void PeerConnection::OnFailure(webrtc::RTCError error)
     RTC_LOG(LERROR) << ToString(error.type()) << ": " << error.message();
 
     // TODO(hta): include error.type in the message
+    if (PostEvent(PeerConnectionEventType::Failure, 0, 0, error.message(), strlen(error.message())))
+        return;
+
     if (OnFailureMessage)
         OnFailureMessage(error.message());
 }
@@ -180,6 +185,10 @@ void PeerConnection::OnIceCandidate(
         return;
     }
 
+    if (PostEvent(PeerConnectionEventType::IceCandidateReadyToSend, candidate->sdp_mline_index(), 0,
+        sdp.data(), sdp.size(), candidate->sdp_mid().c_str()))
+        return;
+
     if (OnIceCandidateReady)
         OnIceCandidateReady(sdp.c_str(), candidate->sdp_mline_index(),
             candidate->sdp_mid().c_str());
@@ -193,11 +202,55 @@ void PeerConnection::RegisterOnLocalI420FrameReady(IncomingVideoFrameCallback ca
 #endif
 }
 
-void PeerConnection::RegisterOnRemoteI420FrameReady(IncomingVideoFrameCallback callback) const
+void PeerConnection::RegisterOnRemoteI420FrameReady(IncomingVideoFrameCallback callback)
+{
+#ifdef HAS_REMOTE_VIDEO_OBSERVER
+    std::lock_guard<std::mutex> lock(remote_video_observers_mutex_);
+
+    remote_video_callback_ = callback;
+
+    for (auto& pair : remote_video_observers_)
+    {
+        pair.second->SetVideoCallback(callback);
+    }
+#endif
+}
+
+bool PeerConnection::SetRemoteVideoFrameOptions(VideoFrameFormat format, int width, int height)
+{
+#ifdef HAS_REMOTE_VIDEO_OBSERVER
+    if (format != VideoFrameFormat::I420 && (format < VideoFrameFormat::RGBA32 || format > VideoFrameFormat::ABGR32))
+    {
+        RTC_LOG(LS_ERROR) << "Remote video frames can't be converted to pixel format " << static_cast<int>(format);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(remote_video_observers_mutex_);
+
+    remote_video_format_ = format;
+    remote_video_width_ = width;
+    remote_video_height_ = height;
+
+    for (auto& pair : remote_video_observers_)
+    {
+        pair.second->SetOutputOptions(format, width, height);
+    }
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+int PeerConnection::GetRemoteVideoTrackId(const std::string& transceiver_mid)
 {
 #ifdef HAS_REMOTE_VIDEO_OBSERVER
-    if (remote_video_observer_)
-        remote_video_observer_->SetVideoCallback(callback);
+    std::lock_guard<std::mutex> lock(remote_video_observers_mutex_);
+
+    const auto it = remote_video_observers_.find(transceiver_mid);
+    return it == remote_video_observers_.end() ? 0 : it->second->track_id();
+#else
+    return 0;
 #endif
 }
 
@@ -211,6 +264,26 @@ void PeerConnection::RegisterOnDataFromDataChannelReady(DataAvailableCallback ca
     OnDataFromDataChannelReady = callback;
 }
 
+void PeerConnection::RegisterOnDataBufferAvailable(DataBufferAvailableCallback callback)
+{
+    OnDataBufferAvailable = callback;
+}
+
+void PeerConnection::RegisterOnStatsReady(StatsReadyCallback callback)
+{
+    stats_snapshot_->callback = callback;
+}
+
+void PeerConnection::RegisterOnDataChannelBufferedAmountLow(DataChannelBufferedAmountLowCallback callback)
+{
+    OnDataChannelBufferedAmountLow = callback;
+}
+
+void PeerConnection::ReleaseDataBuffer(void* buffer)
+{
+    delete static_cast<rtc::CopyOnWriteBuffer*>(buffer);
+}
+
 void PeerConnection::RegisterOnFailure(FailureCallback callback)
 {
     OnFailureMessage = callback;
@@ -251,6 +324,31 @@ void PeerConnection::RegisterRemoteTrackChanged(RemoteTrackChangedCallback callb
     OnRemoteTrackChanged = callback;
 }
 
+void PeerConnection::SetEventQueue(webrtc::EventQueue* event_queue, int64_t tag)
+{
+    event_tag_ = tag;
+    event_queue_ = event_queue;
+
+    stats_snapshot_->event_tag = tag;
+    stats_snapshot_->event_queue = event_queue;
+}
+
+bool PeerConnection::PostEvent(PeerConnectionEventType type, int id, int64_t value,
+    const void* data, size_t length, const char* text) const
+{
+    const auto event_queue = event_queue_.load();
+    if (!event_queue)
+        return false;
+
+    PeerConnectionEvent event{};
+    event.tag = event_tag_;
+    event.type = type;
+    event.id = id;
+    event.value = value;
+    event_queue->Push(event, data, length, text);
+    return true;
+}
+
 bool PeerConnection::SetRemoteDescription(const char* type, const char* sdp) const
 {
     if (!peer_connection_)
@@ -341,6 +439,9 @@ void PeerConnection::OnSignalingChange(webrtc::PeerConnectionInterface::Signalin
 {
     RTC_LOG(INFO) << __FUNCTION__ << " state: " << new_state;
 
+    if (PostEvent(PeerConnectionEventType::SignalingStateChanged, 0, new_state))
+        return;
+
     if (OnSignalingStateChanged)
         OnSignalingStateChanged(new_state);
 }
@@ -349,6 +450,9 @@ void PeerConnection::OnConnectionChange(webrtc::PeerConnectionInterface::PeerCon
 {
     RTC_LOG(INFO) << __FUNCTION__ << " state: " << static_cast<int>(new_state);
 
+    if (PostEvent(PeerConnectionEventType::ConnectionStateChanged, 0, static_cast<int>(new_state)))
+        return;
+
     if (OnConnectionStateChanged)
         OnConnectionStateChanged(static_cast<int>(new_state));
 }
@@ -357,35 +461,48 @@ void PeerConnection::OnTrack(rtc::scoped_refptr<webrtc::RtpTransceiverInterface>
 {
     RTC_LOG(INFO) << __FUNCTION__ << " mid: " << transceiver->mid().value_or("(unknown)");
 
-    if (OnRemoteTrackChanged)
-{
-        OnRemoteTrackChanged(
-            transceiver->mid()->c_str(),
-            transceiver->media_type(),
-            transceiver->stopped() ? 1 : 0);
-    }
-
 #ifdef HAS_REMOTE_VIDEO_OBSERVER
-    if (remote_video_observer_)
+    const auto receiver = transceiver->receiver();
+    auto track = receiver->track();
+    auto video_track = dynamic_cast<webrtc::VideoTrackInterface*>(track.get());
+    if (video_track)
     {
-        const auto receiver = transceiver->receiver();
-        auto track = receiver->track();
-        auto video_track = dynamic_cast<webrtc::VideoTrackInterface*>(track.get());
-        if (video_track)
+        const auto mid = transceiver->mid().value_or(std::string());
+
+        std::lock_guard<std::mutex> lock(remote_video_observers_mutex_);
+
+        auto& observer = remote_video_observers_[mid];
+        if (!observer)
         {
-            if (transceiver->stopped())
-            {
-                video_track->RemoveSink(remote_video_observer_.get());
-            }
-            else
-            {
-            video_track->AddOrUpdateSink(remote_video_observer_.get(), rtc::VideoSinkWants());
+            observer = std::make_unique<VideoObserver>(++last_remote_video_track_id_);
+            observer->SetVideoCallback(remote_video_callback_);
+            observer->SetOutputOptions(remote_video_format_, remote_video_width_, remote_video_height_);
+        }
+
+        if (transceiver->stopped())
+        {
+            video_track->RemoveSink(observer.get());
+        }
+        else
+        {
+            video_track->AddOrUpdateSink(observer.get(), rtc::VideoSinkWants());
         }
-    }
     }
 
     SetAudioControl();
 #endif
+
+    // Raised after the observer was added, so the handler can look up the identifier of the remote video track.
+    const bool is_posted = PostEvent(PeerConnectionEventType::RemoteTrackChanged,
+        transceiver->media_type(), transceiver->stopped() ? 1 : 0, nullptr, 0, transceiver->mid()->c_str());
+
+    if (!is_posted && OnRemoteTrackChanged)
+    {
+        OnRemoteTrackChanged(
+            transceiver->mid()->c_str(),
+            transceiver->media_type(),
+            transceiver->stopped() ? 1 : 0);
+    }
 }
 
 void PeerConnection::OnRenegotiationNeeded()
@@ -410,7 +527,7 @@ int PeerConnection::AddVideoTrack(const std::string& label, int min_bps, int max
 {
     for (auto&& pair : video_tracks_)
     {
-        if (pair.second->id() == label)
+        if (pair.second->track->id() == label)
         {
             RTC_LOG(LS_ERROR) << "Video track '" << label << "' already exists!";
             return 0;
@@ -449,61 +566,353 @@ int PeerConnection::AddVideoTrack(const std::string& label, int min_bps, int max
         return 0;
 
     const auto id = ++last_video_track_id_;
-    video_tracks_.emplace(id, video_track);
+    video_tracks_.emplace(id, std::make_unique<VideoTrackEntry>(id, video_track));
     return id;
 }
 
-bool PeerConnection::AddDataChannel(const char* label, bool is_ordered, bool is_reliable)
+int PeerConnection::AddDataChannel(const char* label, bool is_ordered, bool is_reliable)
 {
     struct webrtc::DataChannelInit init;
     init.ordered = is_ordered;
     init.reliable = is_reliable;
 
-    if (data_channels_.count(label))
+    if (FindDataChannel(label))
     {
         RTC_LOG(LS_ERROR) << "Data channel '" << label << "' already exists!";
-        return false;
+        return 0;
     }
 
     auto data_channel = peer_connection_->CreateDataChannel(label, &init);
     if (data_channel)
     {
-        data_channels_.emplace(label, std::make_unique<DataChannelEntry>(this, data_channel));
-        RTC_LOG(LS_INFO) << "Data channel '" << label << "' added";
-        return true;
+        const auto id = AddDataChannelEntry(label, data_channel);
+        if (!id)
+        {
+            // Another thread added the label meanwhile.
+            RTC_LOG(LS_ERROR) << "Data channel '" << label << "' already exists!";
+            data_channel->Close();
+            return 0;
+        }
+
+        RTC_LOG(LS_INFO) << "Data channel '" << label << "' added as #" << id;
+        return id;
     }
 
     RTC_LOG(LS_ERROR) << "Failed to create data channel '" << label << "'!";
-    return false;
+    return 0;
+}
+
+int PeerConnection::AddDataChannelEntry(const std::string& label, rtc::scoped_refptr<webrtc::DataChannelInterface> channel)
+{
+    int id;
+    {
+        std::lock_guard<std::mutex> lock(data_channels_mutex_);
+
+        if (data_channel_ids_.count(label))
+            return 0;
+
+        // Reserve the identifier and label, the entry registers itself with the channel outside the lock.
+        id = static_cast<int>(data_channels_.size()) + 1;
+        data_channels_.emplace_back();
+        data_channel_ids_.emplace(label, id);
+    }
+
+    auto entry = std::make_shared<DataChannelEntry>(this, id, label, std::move(channel));
+
+    std::lock_guard<std::mutex> lock(data_channels_mutex_);
+    data_channels_[id - 1] = std::move(entry);
+    return id;
+}
+
+std::shared_ptr<PeerConnection::DataChannelEntry> PeerConnection::FindDataChannel(int channel_id) const
+{
+    std::lock_guard<std::mutex> lock(data_channels_mutex_);
+
+    if (channel_id <= 0 || channel_id > static_cast<int>(data_channels_.size()))
+        return nullptr;
+
+    return data_channels_[channel_id - 1];
+}
+
+std::shared_ptr<PeerConnection::DataChannelEntry> PeerConnection::FindDataChannel(const std::string& label) const
+{
+    std::lock_guard<std::mutex> lock(data_channels_mutex_);
+
+    const auto it = data_channel_ids_.find(label);
+    if (it == data_channel_ids_.end())
+        return nullptr;
+
+    return data_channels_[it->second - 1];
 }
 
 bool PeerConnection::RemoveDataChannel(const char* label)
 {
-    const auto it = data_channels_.find(label);
-    if (it == data_channels_.end())
+    const auto entry = FindDataChannel(label);
+    if (!entry)
     {
         RTC_LOG(LS_ERROR) << "Data channel '" << label << "' not found";
         return false;
     }
 
-    data_channels_.erase(it);
+    return RemoveDataChannelById(entry->id);
+}
+
+bool PeerConnection::RemoveDataChannelById(int channel_id)
+{
+    std::shared_ptr<DataChannelEntry> entry;
+    {
+        std::lock_guard<std::mutex> lock(data_channels_mutex_);
+
+        if (channel_id > 0 && channel_id <= static_cast<int>(data_channels_.size()))
+        {
+            entry = std::move(data_channels_[channel_id - 1]);
+        }
+
+        if (entry)
+        {
+            data_channel_ids_.erase(entry->label);
+        }
+    }
+
+    if (!entry)
+    {
+        RTC_LOG(LS_ERROR) << "Data channel #" << channel_id << " not found";
+        return false;
+    }
+
+    // The entry is destroyed outside the lock, when the last sender holding it is done.
     return true;
 }
 
 bool PeerConnection::SendData(const char* label, const uint8_t* data, int length, bool is_binary)
 {
-    const auto it = data_channels_.find(label);
-    if (it == data_channels_.end())
+    const auto entry = FindDataChannel(label);
+    if (!entry)
     {
         RTC_LOG(LS_ERROR) << "Data channel '" << label << "' not found";
         return false;
     }
 
+    return SendDataById(entry->id, data, length, is_binary);
+}
+
+bool PeerConnection::SendDataById(int channel_id, const uint8_t* data, int length, bool is_binary)
+{
+    const auto entry = FindDataChannel(channel_id);
+    if (!entry)
+    {
+        RTC_LOG(LS_ERROR) << "Data channel #" << channel_id << " not found";
+        return false;
+    }
+
     const webrtc::DataBuffer buffer(rtc::CopyOnWriteBuffer(data, length), is_binary);
-    return it->second->channel->Send(buffer);
+    return entry->Send(buffer);
+}
+
+int PeerConnection::SendDataBatch(const DataMessageDescriptor* messages, int count, uint8_t* results)
+{
+    if (count <= 0)
+        return 0;
+
+    if (!messages)
+    {
+        RTC_LOG(LS_ERROR) << "No data messages to send";
+        return 0;
+    }
+
+    // Every channel call is proxied to the signaling thread, so hop there once for the whole batch.
+    // There the entries never block on their send lock, which a host thread might hold while waiting for us.
+    if (signaling_thread_ && !signaling_thread_->IsCurrent())
+    {
+        return signaling_thread_->Invoke<int>(RTC_FROM_HERE, [this, messages, count, results]()
+        {
+            return SendDataBatch(messages, count, results);
+        });
+    }
+
+    int sent_count = 0;
+    std::shared_ptr<DataChannelEntry> entry;
+
+    for (int i = 0; i < count; ++i)
+    {
+        const auto& message = messages[i];
+
+        if (!entry || entry->id != message.channel_id)
+        {
+            entry = FindDataChannel(message.channel_id);
+        }
+
+        bool is_sent = false;
+
+        if (!entry)
+        {
+            RTC_LOG(LS_ERROR) << "Data channel #" << message.channel_id << " not found";
+        }
+        else if (message.length < 0 || (message.length > 0 && !message.data))
+        {
+            RTC_LOG(LS_ERROR) << "Invalid data message #" << i << " for data channel #" << message.channel_id;
+        }
+        else
+        {
+            const webrtc::DataBuffer buffer(rtc::CopyOnWriteBuffer(message.data, message.length), message.is_binary != 0);
+            is_sent = entry->Send(buffer);
+        }
+
+        if (results)
+        {
+            results[i] = is_sent ? 1 : 0;
+        }
+
+        sent_count += is_sent;
+    }
+
+    return sent_count;
+}
+
+bool PeerConnection::ConfigureDataChannelChunking(int channel_id, int chunk_size)
+{
+    const auto entry = FindDataChannel(channel_id);
+    if (!entry)
+    {
+        RTC_LOG(LS_ERROR) << "Data channel #" << channel_id << " not found";
+        return false;
+    }
+
+    if (chunk_size != 0 && (chunk_size <= static_cast<int>(webrtc::DataChunkHeader::kSize) || chunk_size > kMaxDataChunkSize))
+    {
+        RTC_LOG(LS_ERROR) << "Invalid data channel chunk size " << chunk_size;
+        return false;
+    }
+
+    entry->sender.chunk_size = chunk_size;
+    return true;
+}
+
+bool PeerConnection::ConfigureDataChannelMaxMessageSize(int channel_id, int max_message_size)
+{
+    const auto entry = FindDataChannel(channel_id);
+    if (!entry)
+    {
+        RTC_LOG(LS_ERROR) << "Data channel #" << channel_id << " not found";
+        return false;
+    }
+
+    if (max_message_size <= 0 || static_cast<size_t>(max_message_size) > webrtc::DataChunkAssembler::kMaxMessageSize)
+    {
+        RTC_LOG(LS_ERROR) << "Invalid data channel message size limit " << max_message_size;
+        return false;
+    }
+
+    entry->max_message_size = max_message_size;
+    return true;
+}
+
+bool PeerConnection::ConfigureDataChannelCompression(int channel_id, bool is_enabled, int level, int threshold)
+{
+    const auto entry = FindDataChannel(channel_id);
+    if (!entry)
+    {
+        RTC_LOG(LS_ERROR) << "Data channel #" << channel_id << " not found";
+        return false;
+    }
+
+    if (level < Z_DEFAULT_COMPRESSION || level > Z_BEST_COMPRESSION)
+    {
+        RTC_LOG(LS_ERROR) << "Invalid data channel compression level " << level;
+        return false;
+    }
+
+    entry->compression_level = level;
+    entry->compression_threshold = std::max(0, threshold);
+    entry->is_compression_enabled = is_enabled;
+    return true;
+}
+
+bool PeerConnection::GetDataChannelStats(int channel_id, DataChannelStats* stats) const
+{
+    const auto entry = FindDataChannel(channel_id);
+    if (!entry)
+    {
+        RTC_LOG(LS_ERROR) << "Data channel #" << channel_id << " not found";
+        return false;
+    }
+
+    entry->GetStats(stats);
+    return true;
+}
+
+int64_t PeerConnection::GetDataChannelBufferedAmount(int channel_id) const
+{
+    const auto entry = FindDataChannel(channel_id);
+    if (!entry)
+    {
+        RTC_LOG(LS_ERROR) << "Data channel #" << channel_id << " not found";
+        return -1;
+    }
+
+    return static_cast<int64_t>(entry->sender.buffered_amount());
+}
+
+bool PeerConnection::ConfigureDataChannelBuffering(int channel_id, int64_t low_water_mark, int64_t high_water_mark)
+{
+    const auto entry = FindDataChannel(channel_id);
+    if (!entry)
+    {
+        RTC_LOG(LS_ERROR) << "Data channel #" << channel_id << " not found";
+        return false;
+    }
+
+    entry->sender.low_water_mark = low_water_mark;
+    entry->sender.high_water_mark = std::max<int64_t>(0, high_water_mark);
+    return true;
 }
 
 bool PeerConnection::SendVideoFrame(int video_track_id, const uint8_t* pixels, int stride, int width, int height, VideoFrameFormat format)
+{
+#ifndef HAS_D3D11
+    if (format == VideoFrameFormat::GpuTextureD3D11)
+    {
+        RTC_LOG(LS_ERROR) << "Direct3D 11 textures are only supported on Windows";
+        return false;
+    }
+#endif
+
+    if (IsPlanarYuvFormat(format))
+    {
+        // The planes are stored contiguously, the chroma planes follow the Y plane without padding.
+        const int chroma_height = format == VideoFrameFormat::I444 ? height : (height + 1) / 2;
+        const int chroma_stride = format == VideoFrameFormat::I420 ? (stride + 1) / 2 : stride;
+
+        const auto data_u = pixels + static_cast<ptrdiff_t>(stride) * height;
+        const auto data_v = format == VideoFrameFormat::NV12 ? nullptr : data_u + static_cast<ptrdiff_t>(chroma_stride) * chroma_height;
+
+        return SendVideoFrameYuv(video_track_id, pixels, data_u, data_v, stride, chroma_stride, chroma_stride, width, height, format);
+    }
+
+    return SubmitVideoFrame(video_track_id, VideoFrameRequest{ pixels, stride, nullptr, 0, nullptr, 0, width, height, format, 0 });
+}
+
+bool PeerConnection::SendVideoFrameYuv(int video_track_id,
+    const uint8_t* data_y, const uint8_t* data_u, const uint8_t* data_v,
+    int stride_y, int stride_u, int stride_v,
+    int width, int height, VideoFrameFormat format)
+{
+    if (!IsPlanarYuvFormat(format))
+    {
+        RTC_LOG(LS_ERROR) << "Pixel format " << static_cast<int>(format) << " is not a planar YUV format";
+        return false;
+    }
+
+    if (!data_y || !data_u || (!data_v && format != VideoFrameFormat::NV12))
+    {
+        RTC_LOG(LS_ERROR) << "Missing YUV plane for video track #" << video_track_id;
+        return false;
+    }
+
+    return SubmitVideoFrame(video_track_id, VideoFrameRequest{ data_y, stride_y, data_u, stride_u, data_v, stride_v, width, height, format, 0 });
+}
+
+bool PeerConnection::SubmitVideoFrame(int video_track_id, VideoFrameRequest request)
 {
     auto it = video_tracks_.find(video_track_id);
     if (it == video_tracks_.end())
@@ -512,8 +921,9 @@ bool PeerConnection::SendVideoFrame(int video_track_id, const uint8_t* pixels, i
         return false;
     }
 
-    auto source = dynamic_cast<rtc::VideoSinkInterface<webrtc::VideoFrame>*>(it->second->GetSource());
-    if (!source)
+    auto& entry = *it->second;
+
+    if (!entry.source)
     {
         RTC_LOG(LS_ERROR) << "Video track #" << video_track_id << " does not support sending frames";
         return false;
@@ -546,47 +956,179 @@ bool PeerConnection::SendVideoFrame(int video_track_id, const uint8_t* pixels, i
 		}
     }*/
 
-    rtc::scoped_refptr<webrtc::VideoFrameBuffer> buffer;
-
     const auto clock = webrtc::Clock::GetRealTimeClock();
 
-    if (format >= VideoFrameFormat::CpuTexture)
+    request.timestamp_us = clock->TimeInMicroseconds();
+
+    ++entry.frame_counters->submitted;
+
+    if (entry.frame_queue)
     {
-        buffer = new rtc::RefCountedObject<webrtc::NativeVideoBuffer>(
-            video_track_id, format, width, height, static_cast<const void*>(pixels), this);
+        // The frame is converted and injected on the queue's worker thread.
+        entry.frame_queue->Push(request);
     }
     else
     {
-        auto yuvBuffer = webrtc::I420Buffer::Create(width, height);
+        InjectVideoFrame(entry, request);
+    }
 
-        const auto convertToYUV = getYuvConverter(format);
+    return true;
+}
+
+bool PeerConnection::ConfigureVideoTrackQueue(int video_track_id, int queue_depth, VideoFrameDropPolicy drop_policy)
+{
+    auto it = video_tracks_.find(video_track_id);
+    if (it == video_tracks_.end())
+    {
+        RTC_LOG(LS_ERROR) << "Video track #" << video_track_id << " not found";
+        return false;
+    }
+
+    auto& entry = *it->second;
 
-        convertToYUV(pixels, stride,
-            yuvBuffer->MutableDataY(), yuvBuffer->StrideY(),
-            yuvBuffer->MutableDataU(), yuvBuffer->StrideU(),
-            yuvBuffer->MutableDataV(), yuvBuffer->StrideV(),
-            width,
-            height);
+    // Stop the previous worker first, so the buffer pool is never used by two threads.
+    entry.frame_queue = nullptr;
 
-        buffer = yuvBuffer;
+    if (queue_depth > 0)
+    {
+        entry.frame_queue = std::make_unique<VideoFrameQueue>(queue_depth, drop_policy,
+            [this, &entry](const VideoFrameRequest& request)
+            {
+                InjectVideoFrame(entry, request);
+            },
+            [this, &entry](const VideoFrameRequest& request)
+            {
+                ++entry.queue_dropped_frame_count;
+                ++entry.frame_counters->dropped;
+                OnFrameProcessed(entry.id, request.pixels, false);
+            });
+    }
+
+    return true;
+}
+
+bool PeerConnection::SetVideoTrackDeferredConversion(int video_track_id, bool is_deferred)
+{
+    auto it = video_tracks_.find(video_track_id);
+    if (it == video_tracks_.end())
+    {
+        RTC_LOG(LS_ERROR) << "Video track #" << video_track_id << " not found";
+        return false;
+    }
+
+    it->second->is_conversion_deferred = is_deferred;
+    return true;
+}
+
+void PeerConnection::InjectVideoFrame(VideoTrackEntry& entry, const VideoFrameRequest& request)
+{
+    // Reports the frame as processed once the encoder and all sinks released it.
+    rtc::scoped_refptr<webrtc::VideoFrameLifetime> lifetime = new rtc::RefCountedObject<webrtc::VideoFrameLifetime>(
+        entry.id, request.pixels, this, entry.frame_counters, request.timestamp_us);
+
+    rtc::scoped_refptr<webrtc::VideoFrameBuffer> buffer;
+
+    if (IsTextureFormat(request.format))
+    {
+        buffer = new rtc::RefCountedObject<webrtc::NativeVideoBuffer>(
+            lifetime, request.format, request.width, request.height, static_cast<const void*>(request.pixels));
+    }
+    else if (IsPlanarYuvFormat(request.format))
+    {
+        buffer = new rtc::RefCountedObject<webrtc::CpuVideoBuffer>(lifetime, WrapPlanarVideoFrame(lifetime, request));
+    }
+    else if (entry.is_conversion_deferred)
+    {
+        buffer = new rtc::RefCountedObject<webrtc::CpuVideoBuffer>(lifetime, new rtc::RefCountedObject<webrtc::RgbaVideoBuffer>(
+            request.format, request.width, request.height, request.pixels, request.stride, yuv_converter_));
+    }
+    else
+    {
+        auto yuvBuffer = entry.buffer_pool.CreateBuffer(request.width, request.height);
+
+        yuv_converter_->Convert(request.format, request.pixels, request.stride, request.width, request.height, *yuvBuffer);
+
+        // Although the RGBA frame is already available again, it is only reported when we know whether it was encoded.
+        buffer = new rtc::RefCountedObject<webrtc::CpuVideoBuffer>(lifetime, yuvBuffer);
     }
 
     const auto yuvFrame = webrtc::VideoFrame::Builder()
         .set_video_frame_buffer(buffer)
         .set_rotation(webrtc::kVideoRotation_0)
-        .set_timestamp_us(clock->TimeInMicroseconds())
+        .set_timestamp_us(request.timestamp_us)
         .build();
 
-    source->OnFrame(yuvFrame);
+    entry.source->OnFrame(yuvFrame);
+}
 
-    if (format < VideoFrameFormat::CpuTexture)
+rtc::scoped_refptr<webrtc::VideoFrameBuffer> PeerConnection::WrapPlanarVideoFrame(
+    const rtc::scoped_refptr<webrtc::VideoFrameLifetime>& lifetime, const VideoFrameRequest& request)
+{
+    // The planes are not copied, so the wrapped planes keep the frame lifetime alive too,
+    // in case the encoder holds on to them longer than to the frame.
+    const auto on_released = [lifetime] {};
+
+    switch (request.format)
     {
-        // Since we copied the RGBA frame to a YUV buffer, the input frame is already available again.
-        // Native textures become available when the H264 encoder has processed them.
-		// TODO: For now we assume the frame will be encoded, we don't know that yet here...
-        OnFrameProcessed(video_track_id, pixels, true);
+    case VideoFrameFormat::I420:
+        return webrtc::WrapI420Buffer(request.width, request.height,
+            request.pixels, request.stride,
+            request.pixels_u, request.stride_u,
+            request.pixels_v, request.stride_v,
+            on_released);
+
+    case VideoFrameFormat::I444:
+        return webrtc::WrapI444Buffer(request.width, request.height,
+            request.pixels, request.stride,
+            request.pixels_u, request.stride_u,
+            request.pixels_v, request.stride_v,
+            on_released);
+
+    case VideoFrameFormat::NV12:
+        return new rtc::RefCountedObject<webrtc::Nv12VideoBuffer>(request.width, request.height,
+            request.pixels, request.stride,
+            request.pixels_u, request.stride_u);
+
+    default:
+        throw std::runtime_error("Pixel format " + std::to_string(static_cast<int>(request.format)) + " is not a planar YUV format");
     }
+}
 
+bool PeerConnection::GetVideoTrackStats(int video_track_id, VideoTrackStats* stats) const
+{
+    const auto it = video_tracks_.find(video_track_id);
+    if (it == video_tracks_.end())
+    {
+        RTC_LOG(LS_ERROR) << "Video track #" << video_track_id << " not found";
+        return false;
+    }
+
+    const auto& pool = it->second->buffer_pool;
+    stats->buffer_pool_hit_count = pool.hit_count();
+    stats->buffer_pool_miss_count = pool.miss_count();
+    stats->buffer_pool_high_water_mark = pool.high_water_mark();
+    stats->queue_dropped_frame_count = it->second->queue_dropped_frame_count;
+
+    const auto& counters = *it->second->frame_counters;
+    stats->submitted_frame_count = counters.submitted;
+    stats->encoded_frame_count = counters.encoded;
+    stats->dropped_frame_count = counters.dropped;
+    return true;
+}
+
+bool PeerConnection::GetVideoTrackLatency(int video_track_id, VideoTrackLatency* latency, bool reset)
+{
+    const auto it = video_tracks_.find(video_track_id);
+    if (it == video_tracks_.end())
+    {
+        RTC_LOG(LS_ERROR) << "Video track #" << video_track_id << " not found";
+        return false;
+    }
+
+    auto& counters = *it->second->frame_counters;
+    counters.submit_to_encode.GetSnapshot(&latency->submit_to_encode, reset);
+    counters.encode.GetSnapshot(&latency->encode, reset);
+    counters.encode_to_send.GetSnapshot(&latency->encode_to_send, reset);
     return true;
 }
 
@@ -594,13 +1136,10 @@ void PeerConnection::OnDataChannel(rtc::scoped_refptr<webrtc::DataChannelInterfa
 {
     const auto label = channel->label();
 
-    if (data_channels_.count(label))
+    if (!AddDataChannelEntry(label, channel))
     {
         RTC_LOG(LS_ERROR) << "Data channel '" << label << "' already exists!";
-        return;
     }
-
-    data_channels_.emplace(label, std::make_unique<DataChannelEntry>(this, channel));
 }
 
 // AudioTrackSinkInterface implementation.
@@ -618,10 +1157,43 @@ void PeerConnection::OnData(const void* audio_data,
 
 void PeerConnection::OnFrameProcessed(int video_track_id, const void* pixels, bool is_encoded)
 {
+    const auto event_queue = event_queue_.load();
+    if (event_queue)
+    {
+        // The pixels belong to the host, only their address is passed.
+        PeerConnectionEvent event{};
+        event.tag = event_tag_;
+        event.type = PeerConnectionEventType::VideoFrameProcessed;
+        event.id = video_track_id;
+        event.value = is_encoded ? 1 : 0;
+        event.data = pixels;
+        event_queue->Push(event, nullptr, 0, nullptr);
+        return;
+    }
+
     if (OnVideoFrameProcessed)
         OnVideoFrameProcessed(video_track_id, pixels, is_encoded);
 }
 
+bool PeerConnection::RequestStats()
+{
+    if (!peer_connection_.get())
+        return false;
+
+    peer_connection_->GetStats(webrtc::StatsSnapshot::CreateCallback(stats_snapshot_));
+    return true;
+}
+
+int PeerConnection::GetStats(StatsEntry* entries, int capacity, int64_t* timestamp_us) const
+{
+    return stats_snapshot_->CopyEntries(entries, capacity, timestamp_us);
+}
+
+int PeerConnection::GetStatsJson(char* buffer, int capacity) const
+{
+    return stats_snapshot_->CopyJson(buffer, capacity);
+}
+
 std::vector<uint32_t> PeerConnection::GetRemoteAudioTrackSynchronizationSources() const
 {
     std::vector<rtc::scoped_refptr<webrtc::RtpReceiverInterface>> receivers =
@@ -647,11 +1219,26 @@ std::vector<uint32_t> PeerConnection::GetRemoteAudioTrackSynchronizationSources(
     return synchronizationSources;
 }
 
+PeerConnection::VideoTrackEntry::VideoTrackEntry(
+    int video_track_id,
+    rtc::scoped_refptr<webrtc::VideoTrackInterface> video_track)
+    : id(video_track_id)
+    , track(std::move(video_track))
+    , source(dynamic_cast<rtc::VideoSinkInterface<webrtc::VideoFrame>*>(track->GetSource()))
+    , frame_counters(std::make_shared<webrtc::VideoFrameCounters>())
+{
+}
+
 PeerConnection::DataChannelEntry::DataChannelEntry(
     PeerConnection* connection,
+    int channel_id,
+    std::string channel_label,
     rtc::scoped_refptr<webrtc::DataChannelInterface> data_channel)
-    : channel(std::move(std::move(data_channel)))
+    : id(channel_id)
+    , label(std::move(channel_label))
+    , channel(std::move(data_channel))
     , connection(connection)
+    , sender(channel_id, channel.get(), connection->signaling_thread_, [this](uint64_t amount) { OnBufferedAmountLow(amount); })
 {
     channel->RegisterObserver(this);
 }
@@ -673,8 +1260,11 @@ void PeerConnection::DataChannelEntry::OnStateChange()
         const webrtc::DataChannelInterface::DataState state = channel->state();
         if (state == webrtc::DataChannelInterface::kOpen)
         {
-            if (connection->OnLocalDataChannelReady)
-                connection->OnLocalDataChannelReady(channel->label().c_str());
+            const bool is_posted = connection->PostEvent(PeerConnectionEventType::LocalDataChannelReady, id, 0, label.data(), label.size());
+
+            if (!is_posted && connection->OnLocalDataChannelReady)
+                connection->OnLocalDataChannelReady(id, label.c_str());
+
             RTC_LOG(LS_INFO) << "Data channel is open";
         }
     }
@@ -683,18 +1273,153 @@ void PeerConnection::DataChannelEntry::OnStateChange()
 //  A data buffer was successfully received.
 void PeerConnection::DataChannelEntry::OnMessage(const webrtc::DataBuffer& buffer)
 {
-    const size_t size = buffer.data.size();
-    const bool is_large = size >= 1024;
-    uint8_t* msg = is_large ? new uint8_t[size] : static_cast<uint8_t*>(_alloca(size));
-    memcpy(msg, buffer.data.cdata(), size);
-    
+    const bool is_chunked = sender.chunk_size > 0;
+
+    rtc::CopyOnWriteBuffer message = buffer.data;
+    size_t offset = 0;
+
+    if (is_chunked && !assembler_.Add(buffer.data, static_cast<size_t>(max_message_size.load()), &message, &offset))
+        return;
+
+    const bool is_shared = is_compression_enabled
+        ? DeliverCompressed(message, offset, buffer.binary)
+        : Deliver(message, offset, buffer.binary);
+
+    // Reassembled messages are not shared with the received chunks, so their buffer can be reused.
+    if (is_chunked && !is_shared && offset == 0)
+    {
+        assembler_.Recycle(std::move(message));
+    }
+}
+
+bool PeerConnection::DataChannelEntry::DeliverCompressed(const rtc::CopyOnWriteBuffer& data, size_t offset, bool is_binary)
+{
+    const auto start_time = std::chrono::high_resolution_clock::now();
+
+    auto inflated = std::move(inflated_buffer_);
+    const auto result = inflater_.Decompress(data.cdata() + offset, data.size() - offset,
+        static_cast<size_t>(max_message_size.load()), &inflated);
+
+    if (result == webrtc::DataInflater::Result::kStored)
+    {
+        inflated_buffer_ = std::move(inflated);
+        return Deliver(data, offset + webrtc::DataCompressionHeader::kStoredSize, is_binary);
+    }
+
+    decompression_time_us_ += std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::high_resolution_clock::now() - start_time).count();
+
+    if (result == webrtc::DataInflater::Result::kInvalid)
+    {
+        inflated_buffer_ = std::move(inflated);
+        RTC_LOG(LS_ERROR) << "Dropping message of data channel #" << id << ", failed to decompress it";
+        return false;
+    }
+
+    ++decompressed_message_count_;
+
+    // Reuse the buffer for the next message, unless the callback shares it.
+    if (!Deliver(inflated, 0, is_binary))
+    {
+        inflated_buffer_ = std::move(inflated);
+    }
+
+    // The compressed message itself is never shared.
+    return false;
+}
+
+bool PeerConnection::DataChannelEntry::Deliver(const rtc::CopyOnWriteBuffer& data, size_t offset, bool is_binary)
+{
+    const auto size = static_cast<int>(data.size() - offset);
+
+    if (connection->OnDataBufferAvailable)
+    {
+        // Shares the received bytes with the caller, without copying them.
+        const auto shared = new rtc::CopyOnWriteBuffer(data);
+        connection->OnDataBufferAvailable(id, shared, shared->cdata() + offset, size, is_binary);
+        return true;
+    }
+
+    // The event queue copies the received bytes.
+    if (connection->PostEvent(PeerConnectionEventType::DataAvailable, id, is_binary ? 1 : 0, data.cdata() + offset, size))
+        return false;
+
     if (connection->OnDataFromDataChannelReady)
-        connection->OnDataFromDataChannelReady(channel->label().c_str(), msg, static_cast<int>(size), buffer.binary);
+    {
+        // The received bytes stay alive during the callback, no need to copy them.
+        connection->OnDataFromDataChannelReady(id, data.cdata() + offset, size, is_binary);
+    }
+
+    return false;
+}
 
-    if (is_large)
+void PeerConnection::DataChannelEntry::OnBufferedAmountChange(uint64_t previous_amount)
+{
+    sender.OnBufferedAmountChange(previous_amount);
+}
+
+void PeerConnection::DataChannelEntry::OnBufferedAmountLow(uint64_t amount)
+{
+    if (!connection->PostEvent(PeerConnectionEventType::DataChannelBufferedAmountLow, id, static_cast<int64_t>(amount)))
+    {
+        if (connection->OnDataChannelBufferedAmountLow)
+            connection->OnDataChannelBufferedAmountLow(id, amount);
+    }
+}
+
+bool PeerConnection::DataChannelEntry::Send(const webrtc::DataBuffer& buffer)
+{
+    if (!is_compression_enabled)
+        return sender.Send(buffer);
+
+    rtc::CopyOnWriteBuffer compressed;
+    if (Compress(buffer, &compressed))
+        return sender.Send(webrtc::DataBuffer(std::move(compressed), buffer.binary));
+
+    // The sender writes the method byte while framing the message.
+    return sender.Send(buffer, webrtc::DataCompressionHeader::kStored);
+}
+
+bool PeerConnection::DataChannelEntry::Compress(const webrtc::DataBuffer& buffer, rtc::CopyOnWriteBuffer* compressed)
+{
+    const auto size = buffer.size();
+
+    if (size >= static_cast<size_t>(compression_threshold.load()))
     {
-        delete[] msg;
+        const auto start_time = std::chrono::high_resolution_clock::now();
+
+        bool is_compressed;
+
+        {
+            std::lock_guard<std::mutex> lock(deflate_mutex_);
+            is_compressed = deflater_.Deflate(buffer.data.cdata(), size, compression_level, compressed);
+        }
+
+        compression_time_us_ += std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::high_resolution_clock::now() - start_time).count();
+
+        if (is_compressed)
+        {
+            ++compressed_message_count_;
+            uncompressed_byte_count_ += size;
+            compressed_byte_count_ += compressed->size();
+            return true;
+        }
     }
+
+    ++stored_message_count_;
+    return false;
+}
+
+void PeerConnection::DataChannelEntry::GetStats(DataChannelStats* stats) const
+{
+    stats->compressed_message_count = compressed_message_count_;
+    stats->stored_message_count = stored_message_count_;
+    stats->uncompressed_byte_count = uncompressed_byte_count_;
+    stats->compressed_byte_count = compressed_byte_count_;
+    stats->compression_time_us = compression_time_us_;
+    stats->decompressed_message_count = decompressed_message_count_;
+    stats->decompression_time_us = decompression_time_us_;
 }
 
 void PeerConnection::AddRef() const
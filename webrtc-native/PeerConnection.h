@@ -3,6 +3,15 @@
 #include "NativeInterface.h"
 #include "VideoObserver.h"
 #include "VideoFrameEvents.h"
+#include "VideoFrameLifetime.h"
+#include "VideoBufferPool.h"
+#include "YuvConverter.h"
+#include "VideoFrameQueue.h"
+#include "DataChunkAssembler.h"
+#include "DataChannelSender.h"
+#include "DataCompression.h"
+#include "StatsSnapshot.h"
+#include "EventQueue.h"
 
 #undef HAS_LOCAL_VIDEO_OBSERVER
 #define HAS_REMOTE_VIDEO_OBSERVER
@@ -16,6 +25,8 @@ class PeerConnection final
 public:
     PeerConnection(
         webrtc::PeerConnectionFactoryInterface* factory,
+        rtc::Thread* signaling_thread,
+        std::shared_ptr<webrtc::YuvConverter> yuv_converter,
         const char** ice_url_array, const int ice_url_count,
         const char* ice_username, const char* ice_password, 
         bool can_receive_audio, bool can_receive_video, 
@@ -31,20 +42,86 @@ public:
     int AddVideoTrack(const std::string& label, int min_bps, int max_bps, int max_fps);
     bool SendVideoFrame(int video_track_id, const uint8_t* pixels, int stride, int width, int height, VideoFrameFormat format);
 
+    // Sends a planar YUV frame without converting it. The planes must stay valid until the frame is reported as processed.
+    bool SendVideoFrameYuv(int video_track_id,
+        const uint8_t* data_y, const uint8_t* data_u, const uint8_t* data_v,
+        int stride_y, int stride_u, int stride_v,
+        int width, int height, VideoFrameFormat format);
+    bool GetVideoTrackStats(int video_track_id, VideoTrackStats* stats) const;
+
+    // Summarizes the latency histograms of the track, and optionally resets them.
+    bool GetVideoTrackLatency(int video_track_id, VideoTrackLatency* latency, bool reset);
+
+    // A queue depth of 0 sends frames synchronously, otherwise SendVideoFrame only queues the frame.
+    bool ConfigureVideoTrackQueue(int video_track_id, int queue_depth, VideoFrameDropPolicy drop_policy);
+
+    // When deferred, RGBA frames are wrapped without copying and only converted to I420 when the encoder needs them.
+    // The pixels must then stay valid until the frame is reported as processed.
+    bool SetVideoTrackDeferredConversion(int video_track_id, bool is_deferred);
+
     bool CreateOffer();
     bool CreateAnswer();
+
+    // Starts collecting the standard stats, the snapshot is updated when they are delivered on the signaling thread.
+    bool RequestStats();
+
+    // Copies the latest stats snapshot, see StatsSnapshot.
+    int GetStats(StatsEntry* entries, int capacity, int64_t* timestamp_us) const;
+    int GetStatsJson(char* buffer, int capacity) const;
     bool SetAudioControl(bool is_mute, bool is_record);
 
-    bool AddDataChannel(const char* label, bool is_ordered, bool is_reliable);
+    // Returns the identifier of the data channel, or 0 on failure.
+    int AddDataChannel(const char* label, bool is_ordered, bool is_reliable);
     bool SendData(const char* label, const uint8_t* data, int length, bool is_binary);
+    bool SendDataById(int channel_id, const uint8_t* data, int length, bool is_binary);
     bool RemoveDataChannel(const char* label);
+    bool RemoveDataChannelById(int channel_id);
+
+    // Sends all messages with a single hop to the signaling thread.
+    // When results is not null, it receives a non-zero value for each message that was sent.
+    // Returns the number of messages that were sent.
+    int SendDataBatch(const DataMessageDescriptor* messages, int count, uint8_t* results);
+
+    // Returns the number of bytes that are buffered or queued for sending, or -1 when the data channel is not found.
+    int64_t GetDataChannelBufferedAmount(int channel_id) const;
+
+    // A negative low-water mark disables the buffered-amount-low callback.
+    // With a positive high-water mark, messages that don't fit are queued natively, and sent when the buffered amount drops,
+    // instead of overflowing the channel, which closes it.
+    bool ConfigureDataChannelBuffering(int channel_id, int64_t low_water_mark, int64_t high_water_mark);
+
+    // With a positive chunk size, messages are framed, and large messages are split in chunks of at most this size,
+    // which are reassembled on receive. Both peers must enable it before sending any message, a chunk size of 0 disables it.
+    bool ConfigureDataChannelChunking(int channel_id, int chunk_size);
+
+    // When enabled, messages of at least threshold bytes are deflated with the given zlib level, when that makes them smaller.
+    // Both peers must enable it before sending any message.
+    bool ConfigureDataChannelCompression(int channel_id, bool is_enabled, int level, int threshold);
+
+    // Received messages that are reassembled from chunks or inflated are dropped when they are larger than this.
+    bool ConfigureDataChannelMaxMessageSize(int channel_id, int max_message_size);
+    bool GetDataChannelStats(int channel_id, DataChannelStats* stats) const;
 
 
     // Register callback functions.
     void RegisterOnLocalI420FrameReady(IncomingVideoFrameCallback callback) const;
-    void RegisterOnRemoteI420FrameReady(IncomingVideoFrameCallback callback) const;
+    void RegisterOnRemoteI420FrameReady(IncomingVideoFrameCallback callback);
+
+    // Converts and scales the remote video frames before they are passed to the callback, see VideoObserver::SetOutputOptions.
+    bool SetRemoteVideoFrameOptions(VideoFrameFormat format, int width, int height);
+
+    // The identifier passed to the frame callback for the remote video track of the transceiver,
+    // zero when the transceiver has no remote video track yet.
+    int GetRemoteVideoTrackId(const std::string& transceiver_mid);
     void RegisterOnLocalDataChannelReady(LocalDataChannelReadyCallback callback);
     void RegisterOnDataFromDataChannelReady(DataAvailableCallback callback);
+
+    // When registered, received messages are handed over as a buffer that must be released with ReleaseDataBuffer,
+    // instead of being passed to the DataAvailableCallback.
+    void RegisterOnDataBufferAvailable(DataBufferAvailableCallback callback);
+    void RegisterOnDataChannelBufferedAmountLow(DataChannelBufferedAmountLowCallback callback);
+    void RegisterOnStatsReady(StatsReadyCallback callback);
+    static void ReleaseDataBuffer(void* buffer);
     void RegisterOnFailure(FailureCallback callback);
     void RegisterOnAudioBusReady(AudioBusReadyCallback callback);
     void RegisterOnLocalSdpReadyToSend(LocalSdpReadyToSendCallback callback);
@@ -54,6 +131,10 @@ public:
     void RegisterVideoFrameProcessed(VideoFrameProcessedCallback callback);
     void RegisterRemoteTrackChanged(RemoteTrackChangedCallback callback);
 
+    // When set, the events are pushed on the queue with the tag, instead of calling the registered callbacks.
+    // The video frame, audio and data buffer callbacks are still called, their data is only valid during the call.
+    void SetEventQueue(webrtc::EventQueue* event_queue, int64_t tag);
+
     bool SetRemoteDescription(const char* type, const char* sdp) const;
     bool AddIceCandidate(const char* sdp, const int sdp_mlineindex, const char* sdp_mid) const;
 
@@ -100,43 +181,153 @@ protected:
     std::vector<uint32_t> GetRemoteAudioTrackSynchronizationSources() const;
 
 private:
+    // Declared before the peer connection, so the observers outlive the tracks delivering frames to them.
+#ifdef HAS_LOCAL_VIDEO_OBSERVER
+    std::unique_ptr<VideoObserver> local_video_observer_;
+#endif
+
+#ifdef HAS_REMOTE_VIDEO_OBSERVER
+    // One observer per remote video transceiver, keyed on mid.
+    // Observers are kept until the connection is destroyed, since a decoder thread might still be delivering a frame.
+    std::map<std::string, std::unique_ptr<VideoObserver>> remote_video_observers_;
+    std::mutex remote_video_observers_mutex_;
+    int last_remote_video_track_id_ = 0;
+    IncomingVideoFrameCallback remote_video_callback_ = nullptr;
+    VideoFrameFormat remote_video_format_ = VideoFrameFormat::I420;
+    int remote_video_width_ = 0;
+    int remote_video_height_ = 0;
+#endif
+
     rtc::scoped_refptr<webrtc::PeerConnectionFactoryInterface> factory_;
     rtc::scoped_refptr<webrtc::PeerConnectionInterface> peer_connection_;
 
+    // The factory's signaling thread, null when the application pumps the messages itself.
+    rtc::Thread* const signaling_thread_;
+
+    // Shared by all peer connections of the factory.
+    std::shared_ptr<webrtc::YuvConverter> yuv_converter_;
+
+    // Shared with the pending stats requests.
+    const std::shared_ptr<webrtc::StatsSnapshot> stats_snapshot_;
+
     class DataChannelEntry : public webrtc::DataChannelObserver
     {
     public:
-        DataChannelEntry(PeerConnection* connection,
+        DataChannelEntry(PeerConnection* connection, int channel_id, std::string channel_label,
             rtc::scoped_refptr<webrtc::DataChannelInterface> data_channel);
         ~DataChannelEntry() override;
 
         // DataChannelObserver implementation.
         void OnStateChange() override;
         void OnMessage(const webrtc::DataBuffer& buffer) override;
+        void OnBufferedAmountChange(uint64_t previous_amount) override;
+
+        // Compresses the message when enabled.
+        bool Send(const webrtc::DataBuffer& buffer);
 
+        void GetStats(DataChannelStats* stats) const;
+
+        const int id;
+        // Kept here, since reading it from the channel proxy blocks on the signaling thread.
+        const std::string label;
         rtc::scoped_refptr<webrtc::DataChannelInterface> channel;
         PeerConnection* connection;
 
+        // Declared after the channel it sends on.
+        webrtc::DataChannelSender sender;
+
+        std::atomic<int> max_message_size{ static_cast<int>(webrtc::DataChunkAssembler::kDefaultMaxMessageSize) };
+
+        std::atomic<bool> is_compression_enabled{ false };
+        std::atomic<int> compression_level{ Z_DEFAULT_COMPRESSION };
+        std::atomic<int> compression_threshold{ webrtc::DataDeflater::kDefaultThreshold };
+
     private:
+        // Compresses the message with its header when worth it, returns false when the message is to be stored.
+        bool Compress(const webrtc::DataBuffer& buffer, rtc::CopyOnWriteBuffer* compressed);
+
+        void OnBufferedAmountLow(uint64_t amount);
+
+        // Returns true when the data is shared with the callback.
+        bool Deliver(const rtc::CopyOnWriteBuffer& data, size_t offset, bool is_binary);
+        bool DeliverCompressed(const rtc::CopyOnWriteBuffer& data, size_t offset, bool is_binary);
+
+        std::mutex deflate_mutex_;
+        webrtc::DataDeflater deflater_;
+
+        // Only used on the signaling thread.
+        webrtc::DataChunkAssembler assembler_;
+        webrtc::DataInflater inflater_;
+        rtc::CopyOnWriteBuffer inflated_buffer_;
+
+        std::atomic<int64_t> compressed_message_count_{ 0 };
+        std::atomic<int64_t> stored_message_count_{ 0 };
+        std::atomic<int64_t> uncompressed_byte_count_{ 0 };
+        std::atomic<int64_t> compressed_byte_count_{ 0 };
+        std::atomic<int64_t> compression_time_us_{ 0 };
+        std::atomic<int64_t> decompressed_message_count_{ 0 };
+        std::atomic<int64_t> decompression_time_us_{ 0 };
+
         // disallow copy-and-assign
         DataChannelEntry(const DataChannelEntry&) = delete;
         DataChannelEntry& operator=(const DataChannelEntry&) = delete;
     };
 
-    int last_video_track_id_ = 0;
+    class VideoTrackEntry
+    {
+    public:
+        VideoTrackEntry(int video_track_id, rtc::scoped_refptr<webrtc::VideoTrackInterface> video_track);
 
-    // TODO: Also use an identifier of a data-channel.
-    std::map<std::string, std::unique_ptr<DataChannelEntry>> data_channels_;
+        const int id;
+        rtc::scoped_refptr<webrtc::VideoTrackInterface> track;
+        rtc::VideoSinkInterface<webrtc::VideoFrame>* source;
 
-    std::map<int, rtc::scoped_refptr<webrtc::VideoTrackInterface>> video_tracks_;
+        // Recycles the I420 buffers that RGBA frames are converted into.
+        webrtc::VideoBufferPool buffer_pool;
 
-#ifdef HAS_LOCAL_VIDEO_OBSERVER
-    std::unique_ptr<VideoObserver> local_video_observer_;
-#endif
+        // Shared with the frames in flight, which might outlive the track.
+        const std::shared_ptr<webrtc::VideoFrameCounters> frame_counters;
 
-#ifdef HAS_REMOTE_VIDEO_OBSERVER
-    std::unique_ptr<VideoObserver> remote_video_observer_;
-#endif
+        std::atomic<bool> is_conversion_deferred{ false };
+
+        std::atomic<int64_t> queue_dropped_frame_count{ 0 };
+
+        // Only set when frames are sent asynchronously.
+        // Declared last, so its worker is stopped and its frames are dropped before the members it uses are destroyed.
+        std::unique_ptr<VideoFrameQueue> frame_queue;
+
+    private:
+        // disallow copy-and-assign
+        VideoTrackEntry(const VideoTrackEntry&) = delete;
+        VideoTrackEntry& operator=(const VideoTrackEntry&) = delete;
+    };
+
+    // Returns false when the event queue is not set, the callback must be called instead.
+    bool PostEvent(PeerConnectionEventType type, int id, int64_t value,
+        const void* data = nullptr, size_t length = 0, const char* text = nullptr) const;
+
+    bool SubmitVideoFrame(int video_track_id, VideoFrameRequest request);
+    void InjectVideoFrame(VideoTrackEntry& entry, const VideoFrameRequest& request);
+
+    // The returned entry stays valid while it is referenced, even when the channel is removed meanwhile.
+    std::shared_ptr<DataChannelEntry> FindDataChannel(int channel_id) const;
+    std::shared_ptr<DataChannelEntry> FindDataChannel(const std::string& label) const;
+    // Returns 0 when a channel with the label already exists.
+    int AddDataChannelEntry(const std::string& label, rtc::scoped_refptr<webrtc::DataChannelInterface> channel);
+    static rtc::scoped_refptr<webrtc::VideoFrameBuffer> WrapPlanarVideoFrame(
+        const rtc::scoped_refptr<webrtc::VideoFrameLifetime>& lifetime, const VideoFrameRequest& request);
+
+    int last_video_track_id_ = 0;
+
+    // Indexed by channel identifier minus one. Identifiers are not reused, removed channels leave a null entry.
+    // Remote channels are added on the signaling thread while the host looks up channels, hence the mutex.
+    // It is never held while calling a channel, since the channel proxies block on the signaling thread.
+    std::vector<std::shared_ptr<DataChannelEntry>> data_channels_;
+    // The identifiers of the channels by label, for the label-based exports.
+    std::map<std::string, int> data_channel_ids_;
+    mutable std::mutex data_channels_mutex_;
+
+    std::map<int, std::unique_ptr<VideoTrackEntry>> video_tracks_;
 
     // rtc::scoped_refptr<webrtc::MediaStreamInterface> remote_stream_;
 
@@ -144,6 +335,8 @@ private:
 
     LocalDataChannelReadyCallback OnLocalDataChannelReady = nullptr;
     DataAvailableCallback OnDataFromDataChannelReady = nullptr;
+    DataBufferAvailableCallback OnDataBufferAvailable = nullptr;
+    DataChannelBufferedAmountLowCallback OnDataChannelBufferedAmountLow = nullptr;
     FailureCallback OnFailureMessage = nullptr;
     AudioBusReadyCallback OnAudioReady = nullptr;
     VideoFrameProcessedCallback OnVideoFrameProcessed = nullptr;
@@ -154,6 +347,9 @@ private:
     StateChangedCallback OnConnectionStateChanged = nullptr;
     RemoteTrackChangedCallback OnRemoteTrackChanged = nullptr;
 
+    std::atomic<webrtc::EventQueue*> event_queue_{ nullptr };
+    std::atomic<int64_t> event_tag_{ 0 };
+
     bool is_mute_audio_ = false;
     bool is_record_audio_ = false;
     bool can_receive_audio_ = false;
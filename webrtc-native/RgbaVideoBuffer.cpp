@@ -0,0 +1,52 @@
+#include "pch.h"
+#include "RgbaVideoBuffer.h"
+
+namespace webrtc
+{
+    RgbaVideoBuffer::RgbaVideoBuffer(
+        VideoFrameFormat format,
+        int width,
+        int height,
+        const uint8_t* pixels,
+        int stride,
+        std::shared_ptr<YuvConverter> yuv_converter)
+        : format_(format)
+        , width_(width)
+        , height_(height)
+        , pixels_(pixels)
+        , stride_(stride)
+        , yuv_converter_(std::move(yuv_converter))
+    {
+        RTC_DCHECK(yuv_converter_);
+    }
+
+    VideoFrameBuffer::Type RgbaVideoBuffer::type() const
+    {
+        return Type::kNative;
+    }
+
+    int RgbaVideoBuffer::width() const
+    {
+        return width_;
+    }
+
+    int RgbaVideoBuffer::height() const
+    {
+        return height_;
+    }
+
+    rtc::scoped_refptr<I420BufferInterface> RgbaVideoBuffer::ToI420()
+    {
+        // Both the encoder and a local video sink might ask for the pixels, on different threads.
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if (!converted_)
+        {
+            auto buffer = I420Buffer::Create(width_, height_);
+            yuv_converter_->Convert(format_, pixels_, stride_, width_, height_, *buffer);
+            converted_ = buffer;
+        }
+
+        return converted_;
+    }
+} // namespace webrtc
@@ -0,0 +1,40 @@
+#pragma once
+#include "macros.h"
+#include "YuvConverter.h"
+
+namespace webrtc
+{
+    // Wraps the packed 32-bit RGB pixels of the caller without copying them.
+    // The pixels are only converted to I420 when a sink or the encoder asks for them,
+    // so frames that are dropped by the video adapter or the encoder are never converted.
+    class RgbaVideoBuffer : public VideoFrameBuffer
+    {
+    public:
+        RgbaVideoBuffer(VideoFrameFormat format, int width, int height,
+            const uint8_t* pixels, int stride,
+            std::shared_ptr<YuvConverter> yuv_converter);
+
+        Type type() const override;
+        int width() const override;
+        int height() const override;
+
+        const uint8_t* pixels() const { return pixels_; }
+        VideoFrameFormat format() const { return format_; }
+
+        DISALLOW_COPY_MOVE_ASSIGN(RgbaVideoBuffer);
+
+    private:
+        // Converts on the calling thread, typically the encoder thread. The result is cached.
+        rtc::scoped_refptr<I420BufferInterface> ToI420() override;
+
+        const VideoFrameFormat format_;
+        const int width_;
+        const int height_;
+        const uint8_t* pixels_;
+        const int stride_;
+        const std::shared_ptr<YuvConverter> yuv_converter_;
+
+        std::mutex mutex_;
+        rtc::scoped_refptr<I420Buffer> converted_;
+    };
+} // namespace webrtc
@@ -0,0 +1,93 @@
+#pragma once
+#include "macros.h"
+
+// A bounded lock-free queue with a single producer and a single consumer.
+// To support dropping the oldest item when the queue is full, the producer may also pop items.
+// Each slot has a sequence number, so an item is only read after its pop claimed the slot,
+// and the slot is only reused after that read completed.
+// A single slot cannot tell a full slot from a free one, so a queue of capacity one has two slots
+// and limits its length with the positions instead.
+template <typename T>
+class SpscQueue final
+{
+public:
+    explicit SpscQueue(size_t capacity)
+        : capacity_(std::max<size_t>(1, capacity))
+        , slot_count_(std::max<size_t>(2, capacity_))
+        , slots_(new Slot[slot_count_])
+    {
+        for (size_t i = 0; i < slot_count_; ++i)
+        {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    DISALLOW_COPY_MOVE_ASSIGN(SpscQueue);
+
+    size_t capacity() const { return capacity_; }
+
+    // Only called by the producer. Returns false when the queue is full,
+    // or when the consumer is still reading the item in the slot.
+    bool TryPush(const T& item)
+    {
+        const auto tail = tail_.load(std::memory_order_relaxed);
+        auto& slot = slots_[tail % slot_count_];
+
+        if (capacity_ < slot_count_ && tail - head_.load(std::memory_order_acquire) >= capacity_)
+            return false;
+
+        if (slot.sequence.load(std::memory_order_acquire) != tail)
+            return false;
+
+        slot.item = item;
+        slot.sequence.store(tail + 1, std::memory_order_release);
+        tail_.store(tail + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Called by the consumer, or by the producer to drop the oldest item. Returns false when the queue is empty.
+    bool TryPop(T& item)
+    {
+        auto head = head_.load(std::memory_order_relaxed);
+
+        for (;;)
+        {
+            auto& slot = slots_[head % slot_count_];
+            const auto sequence = slot.sequence.load(std::memory_order_acquire);
+            const auto difference = static_cast<int64_t>(sequence - (head + 1));
+
+            if (difference < 0)
+                return false;
+
+            if (difference > 0)
+            {
+                // Another pop claimed the slot.
+                head = head_.load(std::memory_order_relaxed);
+                continue;
+            }
+
+            if (head_.compare_exchange_weak(head, head + 1, std::memory_order_relaxed))
+            {
+                item = std::move(slot.item);
+                slot.sequence.store(head + slot_count_, std::memory_order_release);
+                return true;
+            }
+        }
+    }
+
+private:
+    struct Slot
+    {
+        // Equals the position when the slot is free to push, the position + 1 when it holds an item.
+        std::atomic<uint64_t> sequence{ 0 };
+        T item{};
+    };
+
+    const size_t capacity_;
+    const size_t slot_count_;
+    const std::unique_ptr<Slot[]> slots_;
+
+    // Monotonically increasing positions, so they never wrap in practice.
+    std::atomic<uint64_t> head_{ 0 };
+    std::atomic<uint64_t> tail_{ 0 };
+};
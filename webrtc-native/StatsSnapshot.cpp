@@ -0,0 +1,243 @@
+#include "pch.h"
+#include "StatsSnapshot.h"
+
+namespace webrtc
+{
+    namespace
+    {
+        struct StatsField
+        {
+            const char* type;
+            const char* member;
+            StatsFieldId id;
+        };
+
+        // The members are looked up by name, so values a libwebrtc version does not report are simply left out.
+        const StatsField kStatsFields[] =
+        {
+            { "candidate-pair", "currentRoundTripTime", StatsFieldId::CurrentRoundTripTime },
+            { "candidate-pair", "availableOutgoingBitrate", StatsFieldId::AvailableOutgoingBitrate },
+            { "candidate-pair", "availableIncomingBitrate", StatsFieldId::AvailableIncomingBitrate },
+
+            { "outbound-rtp", "packetsSent", StatsFieldId::PacketsSent },
+            { "outbound-rtp", "bytesSent", StatsFieldId::BytesSent },
+            { "outbound-rtp", "framesEncoded", StatsFieldId::FramesEncoded },
+            { "outbound-rtp", "qpSum", StatsFieldId::EncoderQpSum },
+            { "outbound-rtp", "targetBitrate", StatsFieldId::TargetBitrate },
+            { "outbound-rtp", "nackCount", StatsFieldId::NackCountReceived },
+            { "outbound-rtp", "pliCount", StatsFieldId::PliCountReceived },
+            { "outbound-rtp", "firCount", StatsFieldId::FirCountReceived },
+            { "outbound-rtp", "totalEncodeTime", StatsFieldId::TotalEncodeTime },
+
+            { "inbound-rtp", "packetsReceived", StatsFieldId::PacketsReceived },
+            { "inbound-rtp", "bytesReceived", StatsFieldId::BytesReceived },
+            { "inbound-rtp", "packetsLost", StatsFieldId::PacketsLost },
+            { "inbound-rtp", "jitter", StatsFieldId::Jitter },
+            { "inbound-rtp", "framesDecoded", StatsFieldId::FramesDecoded },
+            { "inbound-rtp", "qpSum", StatsFieldId::DecoderQpSum },
+            { "inbound-rtp", "nackCount", StatsFieldId::NackCountSent },
+            { "inbound-rtp", "pliCount", StatsFieldId::PliCountSent },
+            { "inbound-rtp", "firCount", StatsFieldId::FirCountSent },
+
+            { "track", "frameWidth", StatsFieldId::FrameWidth },
+            { "track", "frameHeight", StatsFieldId::FrameHeight },
+            { "track", "framesPerSecond", StatsFieldId::FramesPerSecond },
+            { "track", "framesSent", StatsFieldId::FramesSent },
+            { "track", "framesReceived", StatsFieldId::FramesReceived },
+            { "track", "framesDropped", StatsFieldId::FramesDropped },
+            { "track", "jitterBufferDelay", StatsFieldId::JitterBufferDelay },
+            { "track", "audioLevel", StatsFieldId::AudioLevel },
+        };
+
+        bool GetNumber(const RTCStatsMemberInterface& member, double* value)
+        {
+            if (!member.is_defined())
+                return false;
+
+            switch (member.type())
+            {
+            case RTCStatsMemberInterface::kBool:
+                *value = *member.cast_to<RTCStatsMember<bool>>() ? 1 : 0;
+                return true;
+            case RTCStatsMemberInterface::kInt32:
+                *value = *member.cast_to<RTCStatsMember<int32_t>>();
+                return true;
+            case RTCStatsMemberInterface::kUint32:
+                *value = *member.cast_to<RTCStatsMember<uint32_t>>();
+                return true;
+            case RTCStatsMemberInterface::kInt64:
+                *value = static_cast<double>(*member.cast_to<RTCStatsMember<int64_t>>());
+                return true;
+            case RTCStatsMemberInterface::kUint64:
+                *value = static_cast<double>(*member.cast_to<RTCStatsMember<uint64_t>>());
+                return true;
+            case RTCStatsMemberInterface::kDouble:
+                *value = *member.cast_to<RTCStatsMember<double>>();
+                return true;
+            default:
+                return false;
+            }
+        }
+
+        const std::string* GetString(const RTCStatsMemberInterface& member)
+        {
+            if (!member.is_defined() || member.type() != RTCStatsMemberInterface::kString)
+                return nullptr;
+
+            return &*member.cast_to<RTCStatsMember<std::string>>();
+        }
+
+        class StatsSnapshotCallback : public RTCStatsCollectorCallback
+        {
+        public:
+            explicit StatsSnapshotCallback(std::shared_ptr<StatsSnapshot> snapshot)
+                : snapshot_(std::move(snapshot))
+            {
+            }
+
+            void OnStatsDelivered(const rtc::scoped_refptr<const RTCStatsReport>& report) override
+            {
+                snapshot_->Update(report);
+
+                const auto event_queue = snapshot_->event_queue.load();
+                if (event_queue)
+                {
+                    PeerConnectionEvent event{};
+                    event.tag = snapshot_->event_tag;
+                    event.type = PeerConnectionEventType::StatsReady;
+                    event.value = report->timestamp_us();
+                    event_queue->Push(event, nullptr, 0, nullptr);
+                    return;
+                }
+
+                const auto callback = snapshot_->callback.load();
+                if (callback)
+                {
+                    callback(report->timestamp_us());
+                }
+            }
+
+        private:
+            const std::shared_ptr<StatsSnapshot> snapshot_;
+        };
+    } // namespace
+
+    rtc::scoped_refptr<RTCStatsCollectorCallback> StatsSnapshot::CreateCallback(std::shared_ptr<StatsSnapshot> snapshot)
+    {
+        return new rtc::RefCountedObject<StatsSnapshotCallback>(std::move(snapshot));
+    }
+
+    void StatsSnapshot::Update(const rtc::scoped_refptr<const RTCStatsReport>& report)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        report_ = report;
+
+        // The entries keep their capacity, so polling does not allocate once warmed up.
+        entries_.clear();
+
+        for (const auto& stats : *report)
+        {
+            const auto type = stats.type();
+            const auto members = stats.Members();
+
+            StatsEntry entry{};
+
+            bool is_nominated = true;
+
+            for (const auto member : members)
+            {
+                const auto name = member->name();
+                double value;
+
+                if (strcmp(name, "ssrc") == 0 && GetNumber(*member, &value))
+                {
+                    entry.ssrc = static_cast<uint32_t>(value);
+                }
+                else if (strcmp(name, "remoteSource") == 0 && GetNumber(*member, &value))
+                {
+                    entry.is_remote = value != 0;
+                }
+                else if (strcmp(name, "nominated") == 0 && GetNumber(*member, &value))
+                {
+                    is_nominated = value != 0;
+                }
+                else if (strcmp(name, "kind") == 0 || strcmp(name, "mediaType") == 0)
+                {
+                    const auto kind = GetString(*member);
+                    if (kind)
+                    {
+                        entry.media_kind = *kind == "audio" ? StatsMediaKind::Audio
+                            : *kind == "video" ? StatsMediaKind::Video
+                            : StatsMediaKind::None;
+                    }
+                }
+            }
+
+            // Only report the candidate pair that is used.
+            if (!is_nominated)
+                continue;
+
+            for (const auto member : members)
+            {
+                for (const auto& field : kStatsFields)
+                {
+                    if (strcmp(field.type, type) == 0 && strcmp(field.member, member->name()) == 0)
+                    {
+                        if (GetNumber(*member, &entry.value))
+                        {
+                            entry.field_id = field.id;
+                            entries_.push_back(entry);
+                        }
+
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    int StatsSnapshot::CopyEntries(StatsEntry* entries, int capacity, int64_t* timestamp_us) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if (timestamp_us)
+        {
+            *timestamp_us = report_ ? report_->timestamp_us() : 0;
+        }
+
+        const auto count = static_cast<int>(entries_.size());
+
+        if (entries && capacity > 0)
+        {
+            std::copy_n(entries_.begin(), std::min(count, capacity), entries);
+        }
+
+        return count;
+    }
+
+    int StatsSnapshot::CopyJson(char* buffer, int capacity) const
+    {
+        std::string json;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            if (report_)
+            {
+                json = report_->ToJson();
+            }
+        }
+
+        const auto size = static_cast<int>(json.size()) + 1;
+
+        if (buffer && capacity > 0)
+        {
+            const auto length = std::min(size, capacity) - 1;
+            memcpy(buffer, json.data(), length);
+            buffer[length] = 0;
+        }
+
+        return size;
+    }
+} // namespace webrtc
@@ -0,0 +1,40 @@
+#pragma once
+#include "macros.h"
+#include "NativeInterface.h"
+#include "EventQueue.h"
+
+namespace webrtc
+{
+    // Keeps the latest stats report of a peer connection, flattened into StatsEntry values.
+    // Shared with the pending stats requests, so these never outlive it.
+    class StatsSnapshot final
+    {
+    public:
+        StatsSnapshot() = default;
+        ~StatsSnapshot() = default;
+
+        DISALLOW_COPY_MOVE_ASSIGN(StatsSnapshot);
+
+        // Creates the callback that updates the snapshot when the requested report is delivered.
+        static rtc::scoped_refptr<RTCStatsCollectorCallback> CreateCallback(std::shared_ptr<StatsSnapshot> snapshot);
+
+        void Update(const rtc::scoped_refptr<const RTCStatsReport>& report);
+
+        // Copies at most capacity entries, and returns the number of entries of the snapshot.
+        int CopyEntries(StatsEntry* entries, int capacity, int64_t* timestamp_us) const;
+
+        // Copies the report as a null terminated JSON string, and returns the size needed, including the terminator.
+        int CopyJson(char* buffer, int capacity) const;
+
+        std::atomic<StatsReadyCallback> callback{ nullptr };
+
+        // When set, the StatsReady event is queued instead of calling the callback.
+        std::atomic<EventQueue*> event_queue{ nullptr };
+        std::atomic<int64_t> event_tag{ 0 };
+
+    private:
+        mutable std::mutex mutex_;
+        rtc::scoped_refptr<const RTCStatsReport> report_;
+        std::vector<StatsEntry> entries_;
+    };
+} // namespace webrtc
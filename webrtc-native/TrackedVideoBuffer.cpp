@@ -0,0 +1,54 @@
+#include "pch.h"
+#include "TrackedVideoBuffer.h"
+
+namespace webrtc
+{
+    TrackedVideoBuffer::TrackedVideoBuffer(rtc::scoped_refptr<VideoFrameLifetime> lifetime)
+        : lifetime_(std::move(lifetime))
+    {
+        RTC_DCHECK(lifetime_);
+    }
+
+    VideoFrameBuffer::Type TrackedVideoBuffer::type() const
+    {
+        return Type::kNative;
+    }
+
+    rtc::scoped_refptr<I420BufferInterface> TrackedVideoBuffer::ToI420()
+    {
+        auto buffer = ConvertToI420();
+        if (!buffer)
+            return nullptr;
+
+        return new rtc::RefCountedObject<TrackedI420Buffer>(lifetime_, std::move(buffer));
+    }
+
+    TrackedI420Buffer::TrackedI420Buffer(rtc::scoped_refptr<VideoFrameLifetime> lifetime, rtc::scoped_refptr<I420BufferInterface> buffer)
+        : lifetime_(std::move(lifetime))
+        , buffer_(std::move(buffer))
+    {
+        RTC_DCHECK(buffer_);
+    }
+
+    CpuVideoBuffer::CpuVideoBuffer(rtc::scoped_refptr<VideoFrameLifetime> lifetime, rtc::scoped_refptr<VideoFrameBuffer> buffer)
+        : TrackedVideoBuffer(std::move(lifetime))
+        , buffer_(std::move(buffer))
+    {
+        RTC_DCHECK(buffer_);
+    }
+
+    int CpuVideoBuffer::width() const
+    {
+        return buffer_->width();
+    }
+
+    int CpuVideoBuffer::height() const
+    {
+        return buffer_->height();
+    }
+
+    rtc::scoped_refptr<I420BufferInterface> CpuVideoBuffer::ConvertToI420()
+    {
+        return buffer_->ToI420();
+    }
+} // namespace webrtc
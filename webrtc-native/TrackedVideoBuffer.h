@@ -0,0 +1,81 @@
+#pragma once
+#include "macros.h"
+#include "VideoFrameLifetime.h"
+
+namespace webrtc
+{
+    // A native buffer of a frame that was sent on a local video track, see VideoFrameLifetime.
+    class TrackedVideoBuffer : public VideoFrameBuffer
+    {
+    public:
+        explicit TrackedVideoBuffer(rtc::scoped_refptr<VideoFrameLifetime> lifetime);
+
+        Type type() const override;
+
+        int track_id() const { return lifetime_->track_id(); }
+
+        bool is_encoded() const { return lifetime_->is_encoded(); }
+        void set_encoded(bool is_encoded) { lifetime_->set_encoded(is_encoded); }
+        void set_encode_started() { lifetime_->set_encode_started(); }
+        void set_sent() { lifetime_->set_sent(); }
+
+        std::chrono::microseconds request_encode_delay() const { return lifetime_->request_encode_delay(); }
+
+        VideoFrameLifetime* lifetime() const { return lifetime_.get(); }
+
+        // The converted buffer keeps tracking the frame, so encoders without native handle support
+        // still report it as encoded or dropped.
+        rtc::scoped_refptr<I420BufferInterface> ToI420() final;
+
+        DISALLOW_COPY_MOVE_ASSIGN(TrackedVideoBuffer);
+
+    protected:
+        virtual rtc::scoped_refptr<I420BufferInterface> ConvertToI420() = 0;
+
+        const rtc::scoped_refptr<VideoFrameLifetime> lifetime_;
+    };
+
+    // The I420 pixels of a tracked frame, created by TrackedVideoBuffer::ToI420.
+    class TrackedI420Buffer final : public I420BufferInterface
+    {
+    public:
+        TrackedI420Buffer(rtc::scoped_refptr<VideoFrameLifetime> lifetime, rtc::scoped_refptr<I420BufferInterface> buffer);
+
+        int width() const override { return buffer_->width(); }
+        int height() const override { return buffer_->height(); }
+
+        const uint8_t* DataY() const override { return buffer_->DataY(); }
+        const uint8_t* DataU() const override { return buffer_->DataU(); }
+        const uint8_t* DataV() const override { return buffer_->DataV(); }
+
+        int StrideY() const override { return buffer_->StrideY(); }
+        int StrideU() const override { return buffer_->StrideU(); }
+        int StrideV() const override { return buffer_->StrideV(); }
+
+        VideoFrameLifetime* lifetime() const { return lifetime_.get(); }
+
+        DISALLOW_COPY_MOVE_ASSIGN(TrackedI420Buffer);
+
+    private:
+        const rtc::scoped_refptr<VideoFrameLifetime> lifetime_;
+        const rtc::scoped_refptr<I420BufferInterface> buffer_;
+    };
+
+    // Tracks a frame in system memory. The encoder gets the pixels of the wrapped buffer.
+    class CpuVideoBuffer final : public TrackedVideoBuffer
+    {
+    public:
+        CpuVideoBuffer(rtc::scoped_refptr<VideoFrameLifetime> lifetime, rtc::scoped_refptr<VideoFrameBuffer> buffer);
+
+        int width() const override;
+        int height() const override;
+
+        DISALLOW_COPY_MOVE_ASSIGN(CpuVideoBuffer);
+
+    protected:
+        rtc::scoped_refptr<I420BufferInterface> ConvertToI420() override;
+
+    private:
+        const rtc::scoped_refptr<VideoFrameBuffer> buffer_;
+    };
+} // namespace webrtc
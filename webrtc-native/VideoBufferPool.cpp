@@ -0,0 +1,54 @@
+#include "pch.h"
+#include "VideoBufferPool.h"
+
+namespace webrtc
+{
+    VideoBufferPool::VideoBufferPool(size_t max_buffer_count)
+        : max_buffer_count_(max_buffer_count)
+    {
+    }
+
+    rtc::scoped_refptr<I420Buffer> VideoBufferPool::CreateBuffer(int width, int height)
+    {
+        // Drop the unused buffers of another resolution, the in-use ones are freed by their last owner.
+        buffers_.erase(std::remove_if(buffers_.begin(), buffers_.end(), [width, height](const auto& buffer)
+        {
+            return buffer->width() != width || buffer->height() != height;
+        }), buffers_.end());
+
+        for (auto& buffer : buffers_)
+        {
+            // If we hold the only reference, nobody is using this buffer anymore.
+            if (buffer->HasOneRef())
+            {
+                ++hit_count_;
+                return buffer;
+            }
+        }
+
+        ++miss_count_;
+
+        if (buffers_.size() >= max_buffer_count_)
+        {
+            // The pool is exhausted, don't grow it any further.
+            RTC_LOG(LS_WARNING) << "I420 buffer pool exhausted, allocating an unpooled " << width << "x" << height << " buffer";
+            return I420Buffer::Create(width, height);
+        }
+
+        rtc::scoped_refptr<PooledBuffer> buffer(new PooledBuffer(width, height));
+        buffers_.push_back(buffer);
+
+        const auto count = static_cast<int64_t>(buffers_.size());
+        if (count > high_water_mark_)
+        {
+            high_water_mark_ = count;
+        }
+
+        return buffer;
+    }
+
+    void VideoBufferPool::Release()
+    {
+        buffers_.clear();
+    }
+} // namespace webrtc
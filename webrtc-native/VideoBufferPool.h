@@ -0,0 +1,43 @@
+#pragma once
+#include "macros.h"
+
+namespace webrtc
+{
+    // A pool of I420 buffers, keyed on resolution.
+    // A buffer is recycled as soon as the encoder (and everybody else) released it.
+    // Must be used from a single thread, the counters can be read from any thread.
+    class VideoBufferPool final
+    {
+    public:
+        explicit VideoBufferPool(size_t max_buffer_count = 8);
+        ~VideoBufferPool() = default;
+
+        DISALLOW_COPY_MOVE_ASSIGN(VideoBufferPool);
+
+        // Returns an unused pooled buffer of the given resolution.
+        // When all pooled buffers are in use, a new buffer is allocated.
+        rtc::scoped_refptr<I420Buffer> CreateBuffer(int width, int height);
+
+        // Releases all buffers that are not in use.
+        void Release();
+
+        // Number of buffers that were recycled.
+        int64_t hit_count() const { return hit_count_; }
+
+        // Number of buffers that had to be allocated.
+        int64_t miss_count() const { return miss_count_; }
+
+        // Maximum number of buffers that were pooled at the same time.
+        int64_t high_water_mark() const { return high_water_mark_; }
+
+    private:
+        using PooledBuffer = rtc::RefCountedObject<I420Buffer>;
+
+        const size_t max_buffer_count_;
+        std::vector<rtc::scoped_refptr<PooledBuffer>> buffers_;
+
+        std::atomic<int64_t> hit_count_{ 0 };
+        std::atomic<int64_t> miss_count_{ 0 };
+        std::atomic<int64_t> high_water_mark_{ 0 };
+    };
+} // namespace webrtc
@@ -1,6 +1,6 @@
 #pragma once
 
-class VideoFrameEvents abstract
+class VideoFrameEvents
 {
 public:
     virtual ~VideoFrameEvents() = default;
@@ -0,0 +1,67 @@
+#include "pch.h"
+#include "VideoFrameLifetime.h"
+
+namespace webrtc
+{
+    VideoFrameLifetime::VideoFrameLifetime(
+        int track_id,
+        const void* pixels,
+        VideoFrameEvents* events,
+        std::shared_ptr<VideoFrameCounters> counters,
+        int64_t submit_time_us)
+        : track_id_(track_id)
+        , pixels_(pixels)
+        , events_(events)
+        , counters_(std::move(counters))
+        , submit_time_us_(submit_time_us)
+    {
+    }
+
+    VideoFrameLifetime::~VideoFrameLifetime()
+    {
+        if (counters_)
+        {
+            ++(is_encoded_ ? counters_->encoded : counters_->dropped);
+        }
+
+        if (events_ && pixels_)
+        {
+            events_->OnFrameProcessed(track_id_, pixels_, is_encoded_);
+        }
+    }
+
+    void VideoFrameLifetime::set_encoded(bool is_encoded)
+    {
+        // Keep the time the encoder finished, not when the image was delivered.
+        if (is_encoded && !is_encoded_)
+        {
+            encoded_time_us_ = Clock::GetRealTimeClock()->TimeInMicroseconds();
+        }
+
+        is_encoded_ = is_encoded;
+    }
+
+    void VideoFrameLifetime::set_encode_started()
+    {
+        if (encode_start_time_us_ < 0)
+        {
+            encode_start_time_us_ = Clock::GetRealTimeClock()->TimeInMicroseconds();
+        }
+    }
+
+    void VideoFrameLifetime::set_sent()
+    {
+        if (is_sent_ || !is_encoded_ || encode_start_time_us_ < 0)
+            return;
+
+        is_sent_ = true;
+
+        if (counters_)
+        {
+            const auto sent_time_us = Clock::GetRealTimeClock()->TimeInMicroseconds();
+            counters_->submit_to_encode.Record(encode_start_time_us_ - submit_time_us_);
+            counters_->encode.Record(encoded_time_us_ - encode_start_time_us_);
+            counters_->encode_to_send.Record(sent_time_us - encoded_time_us_);
+        }
+    }
+} // namespace webrtc
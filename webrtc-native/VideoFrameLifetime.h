@@ -0,0 +1,59 @@
+#pragma once
+#include "macros.h"
+#include "VideoFrameEvents.h"
+#include "LatencyHistogram.h"
+
+namespace webrtc
+{
+    // Counts what happened to the frames sent on a local video track, and how long it took.
+    struct VideoFrameCounters
+    {
+        std::atomic<int64_t> submitted{ 0 };
+        std::atomic<int64_t> encoded{ 0 };
+        std::atomic<int64_t> dropped{ 0 };
+
+        LatencyHistogram submit_to_encode;
+        LatencyHistogram encode;
+        LatencyHistogram encode_to_send;
+    };
+
+    // Tracks whether a frame sent on a local video track got encoded.
+    // The outcome is counted and reported through VideoFrameEvents when the last reference is released,
+    // at which point the caller can reuse the pixels.
+    class VideoFrameLifetime : public rtc::RefCountInterface
+    {
+    public:
+        // The submit time is in microseconds of the WebRTC clock.
+        VideoFrameLifetime(int track_id, const void* pixels, VideoFrameEvents* events, std::shared_ptr<VideoFrameCounters> counters, int64_t submit_time_us);
+        ~VideoFrameLifetime() override;
+
+        int track_id() const { return track_id_; }
+        const void* pixels() const { return pixels_; }
+
+        bool is_encoded() const { return is_encoded_; }
+        void set_encoded(bool is_encoded);
+
+        // Called by the encoder, the first calls record the latencies of the frame.
+        void set_encode_started();
+        void set_sent();
+
+        // Delay between the request to encode the frame, and the actual encoding time point.
+        std::chrono::microseconds request_encode_delay() const
+        {
+            return std::chrono::microseconds(encoded_time_us_ - submit_time_us_);
+        }
+
+        DISALLOW_COPY_MOVE_ASSIGN(VideoFrameLifetime);
+
+    private:
+        const int track_id_;
+        const void* pixels_;
+        VideoFrameEvents* events_;
+        const std::shared_ptr<VideoFrameCounters> counters_;
+        bool is_encoded_ = false;
+        bool is_sent_ = false;
+        const int64_t submit_time_us_;
+        int64_t encode_start_time_us_ = -1;
+        int64_t encoded_time_us_ = -1;
+    };
+} // namespace webrtc
@@ -0,0 +1,64 @@
+#include "pch.h"
+#include "VideoFrameQueue.h"
+
+VideoFrameQueue::VideoFrameQueue(size_t depth, VideoFrameDropPolicy drop_policy, FrameHandler process_frame, FrameHandler drop_frame)
+    : queue_(depth)
+    , drop_policy_(drop_policy)
+    , process_frame_(std::move(process_frame))
+    , drop_frame_(std::move(drop_frame))
+    , wakeup_(false, false)
+{
+    worker_ = std::thread([this] { Run(); });
+}
+
+VideoFrameQueue::~VideoFrameQueue()
+{
+    is_stopping_ = true;
+    wakeup_.Set();
+    worker_.join();
+
+    VideoFrameRequest request;
+    while (queue_.TryPop(request))
+    {
+        drop_frame_(request);
+    }
+}
+
+void VideoFrameQueue::Push(const VideoFrameRequest& request)
+{
+    if (drop_policy_ == VideoFrameDropPolicy::DropNewest)
+    {
+        if (!queue_.TryPush(request))
+        {
+            drop_frame_(request);
+        }
+    }
+    else
+    {
+        while (!queue_.TryPush(request))
+        {
+            // The worker might have emptied a slot in the meantime, then we just retry.
+            VideoFrameRequest oldest;
+            if (queue_.TryPop(oldest))
+            {
+                drop_frame_(oldest);
+            }
+        }
+    }
+
+    wakeup_.Set();
+}
+
+void VideoFrameQueue::Run()
+{
+    while (!is_stopping_)
+    {
+        VideoFrameRequest request;
+        while (!is_stopping_ && queue_.TryPop(request))
+        {
+            process_frame_(request);
+        }
+
+        wakeup_.Wait(rtc::Event::kForever);
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include "macros.h"
+#include "NativeInterface.h"
+#include "SpscQueue.h"
+
+// A video frame as submitted by SendVideoFrame or SendVideoFrameYuv, the pixels are owned by the caller.
+// For planar YUV formats, pixels and stride describe the Y plane.
+struct VideoFrameRequest
+{
+    const uint8_t* pixels;
+    int stride;
+    const uint8_t* pixels_u;
+    int stride_u;
+    const uint8_t* pixels_v;
+    int stride_v;
+    int width;
+    int height;
+    VideoFrameFormat format;
+    int64_t timestamp_us;
+};
+
+// Hands submitted video frames to a worker thread that converts and injects them,
+// so the submitting thread never blocks on the conversion and broadcaster fan-out.
+class VideoFrameQueue final
+{
+public:
+    using FrameHandler = std::function<void(const VideoFrameRequest& request)>;
+
+    // Frames are processed on the worker thread, but dropped on the submitting thread.
+    VideoFrameQueue(size_t depth, VideoFrameDropPolicy drop_policy, FrameHandler process_frame, FrameHandler drop_frame);
+
+    // Stops the worker thread, frames that are still queued are dropped.
+    ~VideoFrameQueue();
+
+    DISALLOW_COPY_MOVE_ASSIGN(VideoFrameQueue);
+
+    void Push(const VideoFrameRequest& request);
+
+private:
+    void Run();
+
+    SpscQueue<VideoFrameRequest> queue_;
+    const VideoFrameDropPolicy drop_policy_;
+    const FrameHandler process_frame_;
+    const FrameHandler drop_frame_;
+
+    rtc::Event wakeup_;
+    std::atomic<bool> is_stopping_{ false };
+    std::thread worker_;
+};
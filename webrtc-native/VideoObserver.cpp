@@ -2,21 +2,58 @@
 #include "VideoObserver.h"
 #include "NativeVideoBuffer.h"
 
+VideoObserver::VideoObserver(int track_id)
+    : track_id_(track_id)
+{
+}
+
 void VideoObserver::SetVideoCallback(IncomingVideoFrameCallback callback)
 {
-    std::lock_guard<std::mutex> lock(mutex);
-    OnIncomingVideoFrame = callback;
+    callback_.store(callback, std::memory_order_release);
+}
+
+void VideoObserver::SetOutputOptions(VideoFrameFormat format, int width, int height)
+{
+    output_format_ = format;
+    output_width_ = std::max(0, width);
+    output_height_ = std::max(0, height);
 }
 
 void VideoObserver::OnFrame(const webrtc::VideoFrame& frame)
 {
-    std::unique_lock<std::mutex> lock(mutex);
-    if (!OnIncomingVideoFrame)
+    const auto callback = callback_.load(std::memory_order_acquire);
+    if (!callback)
         return;
 
     rtc::scoped_refptr<webrtc::VideoFrameBuffer> buffer(
         frame.video_frame_buffer());
 
+    const auto format = output_format_.load();
+    int width = output_width_;
+    int height = output_height_;
+
+    if (width == 0 && height == 0)
+    {
+        width = frame.width();
+        height = frame.height();
+    }
+    else if (width == 0)
+    {
+        width = std::max(1, frame.width() * height / std::max(1, frame.height()));
+    }
+    else if (height == 0)
+    {
+        height = std::max(1, frame.height() * width / std::max(1, frame.width()));
+    }
+
+    const bool is_converted = format != VideoFrameFormat::I420 || width != frame.width() || height != frame.height();
+
+    if (is_converted && !dynamic_cast<webrtc::NativeVideoBuffer*>(buffer.get()))
+    {
+        DeliverConverted(callback, frame, format, width, height);
+        return;
+    }
+
     switch (buffer->type())
     {
     case webrtc::VideoFrameBuffer::Type::kI420A:
@@ -24,12 +61,12 @@ void VideoObserver::OnFrame(const webrtc::VideoFrame& frame)
         // The buffer has alpha channel.
         webrtc::I420ABufferInterface* i420a_buffer = buffer->GetI420A();
 
-        OnIncomingVideoFrame(nullptr,
+        callback(track_id_, nullptr,
             i420a_buffer->DataY(), i420a_buffer->DataU(),
             i420a_buffer->DataV(), i420a_buffer->DataA(),
             i420a_buffer->StrideY(), i420a_buffer->StrideU(),
             i420a_buffer->StrideV(), i420a_buffer->StrideA(),
-            frame.width(), frame.height(), frame.timestamp_us());
+            frame.width(), frame.height(), frame.timestamp_us(), VideoFrameFormat::I420);
     }
     break;
 
@@ -38,10 +75,10 @@ void VideoObserver::OnFrame(const webrtc::VideoFrame& frame)
         const auto native_buffer = dynamic_cast<webrtc::NativeVideoBuffer*>(buffer.get());
         if (native_buffer)
         {
-            OnIncomingVideoFrame(native_buffer->texture(),
+            callback(track_id_, native_buffer->texture(),
                 nullptr, nullptr, nullptr, nullptr,
                 0, 0, 0, 0,
-                frame.width(), frame.height(), frame.timestamp_us());
+                frame.width(), frame.height(), frame.timestamp_us(), native_buffer->format());
             break;
         }
         // goto default:
@@ -50,12 +87,66 @@ void VideoObserver::OnFrame(const webrtc::VideoFrame& frame)
     default:
     {
         rtc::scoped_refptr<webrtc::I420BufferInterface> i420_buffer = buffer->ToI420();
-        OnIncomingVideoFrame(nullptr,
+        callback(track_id_, nullptr,
             i420_buffer->DataY(), i420_buffer->DataU(),
             i420_buffer->DataV(), nullptr, i420_buffer->StrideY(),
             i420_buffer->StrideU(), i420_buffer->StrideV(), 0,
-            frame.width(), frame.height(), frame.timestamp_us());
+            frame.width(), frame.height(), frame.timestamp_us(), VideoFrameFormat::I420);
     }
     break;
     }
 }
+
+void VideoObserver::DeliverConverted(IncomingVideoFrameCallback callback, const webrtc::VideoFrame& frame,
+    VideoFrameFormat format, int width, int height)
+{
+    rtc::scoped_refptr<webrtc::I420BufferInterface> i420_buffer = frame.video_frame_buffer()->ToI420();
+
+    if (width != i420_buffer->width() || height != i420_buffer->height())
+    {
+        if (!scaled_buffer_ || scaled_buffer_->width() != width || scaled_buffer_->height() != height || !scaled_buffer_->HasOneRef())
+        {
+            scaled_buffer_ = webrtc::I420Buffer::Create(width, height);
+        }
+
+        scaled_buffer_->ScaleFrom(*i420_buffer);
+        i420_buffer = scaled_buffer_;
+    }
+
+    if (format == VideoFrameFormat::I420)
+    {
+        callback(track_id_, nullptr,
+            i420_buffer->DataY(), i420_buffer->DataU(),
+            i420_buffer->DataV(), nullptr, i420_buffer->StrideY(),
+            i420_buffer->StrideU(), i420_buffer->StrideV(), 0,
+            width, height, frame.timestamp_us(), format);
+        return;
+    }
+
+    // libyuv names packed formats after the little-endian word, we name them after the byte order.
+    decltype(&libyuv::I420ToARGB) convert;
+    switch (format)
+    {
+    case VideoFrameFormat::BGRA32: convert = libyuv::I420ToARGB; break;
+    case VideoFrameFormat::RGBA32: convert = libyuv::I420ToABGR; break;
+    case VideoFrameFormat::ARGB32: convert = libyuv::I420ToBGRA; break;
+    case VideoFrameFormat::ABGR32: convert = libyuv::I420ToRGBA; break;
+    default:
+        RTC_LOG(LS_ERROR) << "Unsupported remote video frame format " << static_cast<int>(format);
+        return;
+    }
+
+    const int stride = width * 4;
+    packed_buffer_.resize(static_cast<size_t>(stride) * height);
+
+    convert(i420_buffer->DataY(), i420_buffer->StrideY(),
+        i420_buffer->DataU(), i420_buffer->StrideU(),
+        i420_buffer->DataV(), i420_buffer->StrideV(),
+        packed_buffer_.data(), stride,
+        width, height);
+
+    callback(track_id_, nullptr,
+        packed_buffer_.data(), nullptr, nullptr, nullptr,
+        stride, 0, 0, 0,
+        width, height, frame.timestamp_us(), format);
+}
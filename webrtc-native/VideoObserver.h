@@ -2,19 +2,41 @@
 
 #include "NativeInterface.h"
 
+// Passes the frames of a video track to a callback, tagged with the identifier of the track.
+// The callback can be swapped at any time, without blocking the thread delivering the frames.
+// Frames can optionally be scaled and converted to a packed RGB format on the delivering thread.
 class VideoObserver final : public rtc::VideoSinkInterface<webrtc::VideoFrame>
 {
 public:
-    VideoObserver() = default;
+    explicit VideoObserver(int track_id);
     ~VideoObserver() = default;
 
+    int track_id() const { return track_id_; }
+
     void SetVideoCallback(IncomingVideoFrameCallback callback);
 
+    // The format must be I420 or a packed 32-bit RGB format.
+    // When only the width or height is positive, the other one follows the aspect ratio of the frame,
+    // when both are zero, frames are not scaled. Native texture frames are passed as is.
+    // Options are read without locking, so a frame received while changing them might get an intermediate size.
+    void SetOutputOptions(VideoFrameFormat format, int width, int height);
+
 protected:
     // VideoSinkInterface implementation
     void OnFrame(const webrtc::VideoFrame& frame) override;
 
 private:
-    IncomingVideoFrameCallback OnIncomingVideoFrame = nullptr;
-    std::mutex mutex;
+    void DeliverConverted(IncomingVideoFrameCallback callback, const webrtc::VideoFrame& frame,
+        VideoFrameFormat format, int width, int height);
+
+    const int track_id_;
+    std::atomic<IncomingVideoFrameCallback> callback_{ nullptr };
+
+    std::atomic<VideoFrameFormat> output_format_{ VideoFrameFormat::I420 };
+    std::atomic<int> output_width_{ 0 };
+    std::atomic<int> output_height_{ 0 };
+
+    // Reused between frames, only touched by the thread delivering the frames.
+    rtc::scoped_refptr<webrtc::I420Buffer> scaled_buffer_;
+    std::vector<uint8_t> packed_buffer_;
 };
@@ -0,0 +1,153 @@
+#include "pch.h"
+#include "YuvConverter.h"
+
+namespace webrtc
+{
+    namespace
+    {
+        // Stripes smaller than this are not worth the synchronization overhead.
+        constexpr int kMinStripeHeight = 64;
+    }
+
+    YuvConverter::ConvertFunction YuvConverter::GetConvertFunction(VideoFrameFormat format)
+    {
+        switch (format)
+        {
+        case VideoFrameFormat::BGRA32: return libyuv::ARGBToI420;
+        case VideoFrameFormat::RGBA32: return libyuv::ABGRToI420;
+        case VideoFrameFormat::ARGB32: return libyuv::BGRAToI420;
+        case VideoFrameFormat::ABGR32: return libyuv::RGBAToI420;
+        default:
+            throw std::runtime_error("No YUV converter for pixel format " + std::to_string(static_cast<int>(format)));
+        }
+    }
+
+    YuvConverter::YuvConverter(int thread_count)
+    {
+        // The calling thread also converts stripes, so we need one worker less.
+        for (int i = 1; i < thread_count; ++i)
+        {
+            workers_.emplace_back([this] { WorkerLoop(); });
+        }
+    }
+
+    YuvConverter::~YuvConverter()
+    {
+        {
+            std::lock_guard<std::mutex> lock(job_mutex_);
+            is_stopping_ = true;
+        }
+
+        job_available_.notify_all();
+
+        for (auto& worker : workers_)
+        {
+            worker.join();
+        }
+    }
+
+    void YuvConverter::Convert(VideoFrameFormat format, const uint8_t* pixels, int stride, int width, int height, I420Buffer& buffer)
+    {
+        const auto convert = GetConvertFunction(format);
+
+        const int part_count = thread_count();
+
+        std::unique_lock<std::mutex> convert_lock(convert_mutex_, std::defer_lock);
+
+        if (part_count <= 1 || height < 2 * kMinStripeHeight || !convert_lock.try_lock())
+        {
+            convert(pixels, stride,
+                buffer.MutableDataY(), buffer.StrideY(),
+                buffer.MutableDataU(), buffer.StrideU(),
+                buffer.MutableDataV(), buffer.StrideV(),
+                width, height);
+            return;
+        }
+
+        // Stripes must start at an even row, so that they map to whole chroma rows.
+        int stripe_height = (height + part_count - 1) / part_count;
+        stripe_height = std::max(kMinStripeHeight, (stripe_height + 1) & ~1);
+
+        Job job;
+        job.convert = convert;
+        job.pixels = pixels;
+        job.stride = stride;
+        job.width = width;
+        job.height = height;
+        job.buffer = &buffer;
+        job.stripe_height = stripe_height;
+        job.stripe_count = (height + stripe_height - 1) / stripe_height;
+        job.next_stripe = 0;
+        job.pending_stripes = job.stripe_count;
+        job.active_workers = 0;
+
+        {
+            std::lock_guard<std::mutex> lock(job_mutex_);
+            job_ = &job;
+            ++job_generation_;
+        }
+
+        job_available_.notify_all();
+
+        ConvertStripes(job);
+
+        // Wait until all stripes are converted, and no worker references the job anymore.
+        std::unique_lock<std::mutex> lock(job_mutex_);
+        job_done_.wait(lock, [&job] { return job.pending_stripes == 0 && job.active_workers == 0; });
+        job_ = nullptr;
+    }
+
+    void YuvConverter::ConvertStripes(Job& job)
+    {
+        auto& buffer = *job.buffer;
+
+        for (;;)
+        {
+            const int stripe = job.next_stripe++;
+            if (stripe >= job.stripe_count)
+                return;
+
+            const int y = stripe * job.stripe_height;
+            const int rows = std::min(job.stripe_height, job.height - y);
+
+            job.convert(job.pixels + static_cast<ptrdiff_t>(y) * job.stride, job.stride,
+                buffer.MutableDataY() + y * buffer.StrideY(), buffer.StrideY(),
+                buffer.MutableDataU() + (y / 2) * buffer.StrideU(), buffer.StrideU(),
+                buffer.MutableDataV() + (y / 2) * buffer.StrideV(), buffer.StrideV(),
+                job.width, rows);
+
+            --job.pending_stripes;
+        }
+    }
+
+    void YuvConverter::WorkerLoop()
+    {
+        uint64_t generation = 0;
+
+        for (;;)
+        {
+            Job* job;
+
+            {
+                std::unique_lock<std::mutex> lock(job_mutex_);
+                job_available_.wait(lock, [this, generation] { return is_stopping_ || (job_ && job_generation_ != generation); });
+
+                if (is_stopping_)
+                    return;
+
+                generation = job_generation_;
+                job = job_;
+                ++job->active_workers;
+            }
+
+            ConvertStripes(*job);
+
+            {
+                std::lock_guard<std::mutex> lock(job_mutex_);
+                --job->active_workers;
+            }
+
+            job_done_.notify_all();
+        }
+    }
+} // namespace webrtc
@@ -0,0 +1,67 @@
+#pragma once
+#include "macros.h"
+#include "NativeInterface.h"
+
+namespace webrtc
+{
+    // Converts packed 32-bit RGB frames to I420.
+    // When created with more than one thread, large frames are split into horizontal stripes
+    // that are converted in parallel by a small dedicated worker pool, with the calling thread helping out.
+    class YuvConverter final
+    {
+    public:
+        using ConvertFunction = int(*)(
+            const uint8_t* src, int src_stride,
+            uint8_t* dst_y, int dst_stride_y,
+            uint8_t* dst_u, int dst_stride_u,
+            uint8_t* dst_v, int dst_stride_v,
+            int width, int height);
+
+        // Throws when the format is not a packed 32-bit RGB format.
+        static ConvertFunction GetConvertFunction(VideoFrameFormat format);
+
+        explicit YuvConverter(int thread_count = 1);
+        ~YuvConverter();
+
+        DISALLOW_COPY_MOVE_ASSIGN(YuvConverter);
+
+        int thread_count() const { return static_cast<int>(workers_.size()) + 1; }
+
+        // Can be called from any thread. When the worker pool is busy converting a frame for another thread,
+        // the frame is converted on the calling thread only.
+        void Convert(VideoFrameFormat format, const uint8_t* pixels, int stride, int width, int height, I420Buffer& buffer);
+
+    private:
+        struct Job
+        {
+            ConvertFunction convert;
+            const uint8_t* pixels;
+            int stride;
+            int width;
+            int height;
+            I420Buffer* buffer;
+            int stripe_height;
+            int stripe_count;
+            std::atomic<int> next_stripe;
+            std::atomic<int> pending_stripes;
+
+            // Guarded by job_mutex_
+            int active_workers;
+        };
+
+        static void ConvertStripes(Job& job);
+        void WorkerLoop();
+
+        std::vector<std::thread> workers_;
+
+        // Only one frame is converted by the pool at a time.
+        std::mutex convert_mutex_;
+
+        std::mutex job_mutex_;
+        std::condition_variable job_available_;
+        std::condition_variable job_done_;
+        Job* job_ = nullptr;
+        uint64_t job_generation_ = 0;
+        bool is_stopping_ = false;
+    };
+} // namespace webrtc
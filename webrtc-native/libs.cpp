@@ -1,8 +1,7 @@
 #include "pch.h"
 
-#pragma comment(lib, "webrtc.lib")
-
 #ifdef _WIN32
+#   pragma comment(lib, "webrtc.lib")
 #   pragma comment(lib, "secur32.lib")
 #   pragma comment(lib, "winmm.lib")
 #   pragma comment(lib, "dmoguids.lib")
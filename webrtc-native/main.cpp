@@ -1,7 +1,7 @@
 #include "pch.h"
 #include "main.h"
 
-#if _WIN32
+#ifdef _WIN32
 
 HMODULE currentModuleHandle;
 
@@ -14,6 +14,4 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD  ul_reason_for_call, LPVOID lpReser
 
     return true;
 }
-#else
-#   error "This library only works on Windows for now"
 #endif
\ No newline at end of file
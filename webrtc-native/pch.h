@@ -1,13 +1,24 @@
 #pragma once
 
-#pragma warning( push )
-#pragma warning( disable : 4244 )
+#ifdef _MSC_VER
+#   pragma warning( push )
+#   pragma warning( disable : 4244 )
+#endif
 
 #include <cstdio>
 #include <cstdint>
+#include <cstring>
+#include <stdexcept>
 
 #include <mutex>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include <functional>
+#include <type_traits>
+#include <algorithm>
 #include <map>
+#include <deque>
 #include <memory>
 #include <string>
 #include <vector>
@@ -64,9 +75,11 @@
 #include "rtc_base/keep_ref_until_done.h"
 #include "rtc_base/random.h"
 #include "rtc_base/critical_section.h"
+#include "rtc_base/event.h"
 #include "rtc_base/task_queue.h"
 #include "rtc_base/task_utils/repeating_task.h"
 #include "rtc_base/ssl_adapter.h"
+#include "rtc_base/byte_order.h"
 
 #include "system_wrappers/include/clock.h"
 #include "system_wrappers/include/metrics.h"
@@ -79,9 +92,15 @@
 #include "modules/video_coding/include/video_codec_interface.h"
 #include "media/base/h264_profile_level_id.h"
 
+// Direct3D 11 textures can only be sent on Windows, where they are encoded with NVENC.
+// Elsewhere only CPU frames are supported, and encoded in software.
 #ifdef _WIN32
 #   include <Windows.h>
 #   include <d3d11.h>
+#   define HAS_D3D11
+#   define HAS_NVENC
 #endif
 
-#pragma warning( pop )
+#ifdef _MSC_VER
+#   pragma warning( pop )
+#endif